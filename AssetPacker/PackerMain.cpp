@@ -0,0 +1,178 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <AssetPackWriter.h>
+#include <MeshOptimizer.h>
+
+static bool ReadFile(const char *path, std::vector<char> &data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool HasExtension(const std::string &path, const char *extension) {
+    size_t length = strlen(extension);
+    return path.size() >= length && _stricmp(path.c_str() + path.size() - length, extension) == 0;
+}
+
+static unsigned int ReadU32(const std::vector<char> &data, size_t offset) {
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(&data[offset]);
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
+static unsigned int ReadU16(const std::vector<char> &data, size_t offset) {
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(&data[offset]);
+    return p[0] | (p[1] << 8);
+}
+
+// Positions, optional vertex colors and polygons, fanned into
+// triangles. Everything else in the file is skipped.
+static bool PackObj(dx::AssetPackWriter &writer, const char *name, const std::vector<char> &data) {
+    std::vector<dx::Vertex> vertices;
+    std::vector<UINT> indices;
+
+    std::istringstream in(std::string(data.begin(), data.end()));
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        std::string type;
+        tokens >> type;
+
+        if (type == "v") {
+            dx::Vertex vertex;
+            Vector4f color(1.0f, 1.0f, 1.0f, 1.0f);
+            tokens >> vertex.position.x >> vertex.position.y >> vertex.position.z;
+            tokens >> color.x >> color.y >> color.z;
+            vertex.color = dx::PackColor(color);
+            vertices.push_back(vertex);
+        } else if (type == "f") {
+            // "i", "i/t" or "i/t/n", negative indices count from the end.
+            std::vector<UINT> polygon;
+            std::string corner;
+            while (tokens >> corner) {
+                int index = atoi(corner.c_str());
+                int resolved = index < 0 ? static_cast<int>(vertices.size()) + index : index - 1;
+                if (resolved < 0 || resolved >= static_cast<int>(vertices.size())) return false;
+                polygon.push_back(static_cast<UINT>(resolved));
+            }
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                indices.push_back(polygon[0]);
+                indices.push_back(polygon[i - 1]);
+                indices.push_back(polygon[i]);
+            }
+        }
+    }
+    if (vertices.empty()) return false;
+
+    dx::IndexedMesh mesh = { &vertices[0], static_cast<UINT>(vertices.size()),
+                             indices.empty() ? nullptr : &indices[0], static_cast<UINT>(indices.size()) };
+    if (!indices.empty()) {
+        dx::OptimizeMesh(mesh);
+        printf("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+               name, mesh.before.acmr, mesh.after.acmr, mesh.before.atvr, mesh.after.atvr);
+    }
+
+    writer.AddMesh(name, mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount);
+    return true;
+}
+
+// Uncompressed 24 and 32 bit bitmaps, converted to R8G8B8A8.
+static bool PackBmp(dx::AssetPackWriter &writer, const char *name, const std::vector<char> &data) {
+    if (data.size() < 54 || data[0] != 'B' || data[1] != 'M') return false;
+
+    unsigned int pixelOffset = ReadU32(data, 10);
+    int width = static_cast<int>(ReadU32(data, 18));
+    int height = static_cast<int>(ReadU32(data, 22));
+    unsigned int bits = ReadU16(data, 28);
+    unsigned int compression = ReadU32(data, 30);
+    if (width <= 0 || height == 0 || (bits != 24 && bits != 32) || compression != 0) return false;
+
+    // Positive heights are stored bottom row first.
+    bool bottomUp = height > 0;
+    if (!bottomUp) height = -height;
+    size_t bytesPerPixel = bits / 8;
+    size_t rowBytes = (width * bytesPerPixel + 3) & ~static_cast<size_t>(3);
+    if (pixelOffset + rowBytes * height > data.size()) return false;
+
+    std::vector<UINT> pixels(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char *row = reinterpret_cast<const unsigned char*>(
+            &data[pixelOffset + rowBytes * (bottomUp ? height - 1 - y : y)]);
+        for (int x = 0; x < width; ++x) {
+            const unsigned char *bgr = row + x * bytesPerPixel;
+            UINT alpha = bits == 32 ? bgr[3] : 255;
+            pixels[static_cast<size_t>(y) * width + x] = bgr[2] | (bgr[1] << 8) | (bgr[0] << 16) | (alpha << 24);
+        }
+    }
+
+    writer.AddTexture(name, static_cast<UINT>(width), static_cast<UINT>(height), &pixels[0]);
+    return true;
+}
+
+// Usage: AssetPacker [--compress] PACK FILE...
+// Builds PACK from loose files, each stored under its path as given.
+// .obj files become meshes, optimized for the vertex cache, overdraw and
+// vertex fetch, .bmp files textures, the rest raw data.
+int main(int argc, char **argv) {
+    int arg = 1;
+    bool compress = false;
+    if (arg < argc && strcmp(argv[arg], "--compress") == 0) {
+        compress = true;
+        ++arg;
+    }
+    if (argc - arg < 2) {
+        std::cout << "Usage: AssetPacker [--compress] PACK FILE..." << std::endl;
+        return 1;
+    }
+    const char *packPath = argv[arg++];
+
+    dx::AssetPackWriter writer;
+    writer.SetCompression(compress);
+
+    for (; arg < argc; ++arg) {
+        std::string name = argv[arg];
+        for (size_t i = 0; i < name.size(); ++i) {
+            if (name[i] == '\\') name[i] = '/';
+        }
+        if (name.size() >= dx::AssetPackEntry::kNameLength) {
+            std::cout << name << ": name longer than " << dx::AssetPackEntry::kNameLength - 1 << " characters" << std::endl;
+            return 1;
+        }
+
+        std::vector<char> data;
+        if (!ReadFile(argv[arg], data)) {
+            std::cout << "Failed to read " << argv[arg] << std::endl;
+            return 1;
+        }
+
+        bool ok = true;
+        if (HasExtension(name, ".obj")) {
+            ok = PackObj(writer, name.c_str(), data);
+        } else if (HasExtension(name, ".bmp")) {
+            ok = PackBmp(writer, name.c_str(), data);
+        } else {
+            writer.AddRaw(name.c_str(), dx::AssetType::RAW, data.empty() ? nullptr : &data[0], data.size());
+        }
+        if (!ok) {
+            std::cout << name << ": unsupported or malformed" << std::endl;
+            return 1;
+        }
+    }
+
+    if (writer.Write(packPath) != dx::Error::OK) {
+        std::cout << "Failed to write " << packPath << std::endl;
+        return 1;
+    }
+
+    const dx::AssetPackWriterStats &stats = writer.GetStats();
+    printf("%s: %u assets, %u compressed, %llu bytes raw, %llu bytes packed\n",
+           packPath, stats.assets, stats.compressed, stats.rawBytes, stats.fileBytes);
+    return 0;
+}
\ No newline at end of file
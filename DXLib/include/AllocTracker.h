@@ -0,0 +1,113 @@
+#ifndef DXLIB_ALLOCTRACKER_H
+#define DXLIB_ALLOCTRACKER_H
+
+#include "Defs.h"
+
+#include <cstddef>
+#include <vector>
+
+// Define DXLIB_TRACK_ALLOCATIONS as 1 when building DXLib to replace the
+// global operator new/delete with counting versions, the Debug builds of
+// DXLib and DXLibTests do. Code using the macros below must agree with
+// the library. Off by default, every call below is then a no-op and the
+// statistics stay zero.
+#ifndef DXLIB_TRACK_ALLOCATIONS
+#define DXLIB_TRACK_ALLOCATIONS 0
+#endif
+
+namespace dx {
+
+// Heap use of one tag over a frame.
+struct AllocTagStats {
+    const char *name;
+    size_t count;
+    size_t bytes;
+};
+
+struct AllocFrameStats {
+    size_t count;
+    size_t bytes;
+    size_t freeCount;
+    // Most bytes live at any point during the frame.
+    size_t peakBytes;
+    // Allocations by tag, most allocations first.
+    std::vector<AllocTagStats> tags;
+};
+
+// Called for every allocation made inside a NoAllocScope, with the
+// scope's name and the allocation's size.
+typedef void (*AllocViolationHandler)(const char *scope, size_t bytes);
+
+// Counts heap allocations made through operator new. Every thread keeps
+// its own counters, they're only summed up in EndFrame(). Allocations
+// are tagged with the innermost AllocTagScope, or the innermost profiler
+// zone where there is none.
+class AllocTracker {
+public:
+    static inline bool IsEnabled() { return DXLIB_TRACK_ALLOCATIONS != 0; }
+
+    // Marks the frame boundaries, call on the thread running the frame.
+    static void BeginFrame();
+    static void EndFrame();
+
+    // Allocations of all threads between the last BeginFrame() and
+    // EndFrame() pair.
+    static const AllocFrameStats& GetLastFrame();
+
+    // Allocations of all threads since startup.
+    static size_t GetTotalCount();
+    static size_t GetLiveBytes();
+
+    // Replaces the default handler, which asserts. Pass null to restore.
+    static void SetViolationHandler(AllocViolationHandler handler);
+    // Allocations made inside a NoAllocScope on any thread so far.
+    static size_t GetViolationCount();
+
+    // Used by the scopes below. Tags and scope names must outlive the
+    // tracker, string literals are expected.
+    static const char* PushTag(const char *tag);
+    static void PopTag(const char *previous);
+    static void BeginNoAlloc(const char *name);
+    static void EndNoAlloc();
+};
+
+// Tags the calling thread's allocations with *tag* for the lifetime of
+// the object, overriding profiler zones.
+class AllocTagScope {
+public:
+    explicit AllocTagScope(const char *tag) : _previous(AllocTracker::PushTag(tag)) { }
+    ~AllocTagScope() { AllocTracker::PopTag(_previous); }
+
+private:
+    NO_COPY_ASSIGN(AllocTagScope);
+
+    const char *_previous;
+};
+
+// Allocating on the calling thread during the lifetime of the object
+// reports a violation. Scopes nest.
+class NoAllocScope {
+public:
+    explicit NoAllocScope(const char *name) { AllocTracker::BeginNoAlloc(name); }
+    ~NoAllocScope() { AllocTracker::EndNoAlloc(); }
+
+private:
+    NO_COPY_ASSIGN(NoAllocScope);
+};
+
+} // namespace dx
+
+#define DX_ALLOC_CONCAT_IMPL(A, B) A##B
+#define DX_ALLOC_CONCAT(A, B) DX_ALLOC_CONCAT_IMPL(A, B)
+
+#if DXLIB_TRACK_ALLOCATIONS
+#define DX_ALLOC_TAG(NAME) \
+    dx::AllocTagScope DX_ALLOC_CONCAT(_dxAllocTag, __LINE__)(NAME)
+#define DX_NO_ALLOC_SCOPE(NAME) \
+    dx::NoAllocScope DX_ALLOC_CONCAT(_dxNoAlloc, __LINE__)(NAME)
+#else
+#define DX_ALLOC_TAG(NAME) ((void)0)
+#define DX_NO_ALLOC_SCOPE(NAME) ((void)0)
+#endif
+
+#endif // !DXLIB_ALLOCTRACKER_H
\ No newline at end of file
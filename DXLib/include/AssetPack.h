@@ -0,0 +1,186 @@
+#ifndef DXLIB_ASSETPACK_H
+#define DXLIB_ASSETPACK_H
+
+#include "Defs.h"
+#include "Err.h"
+#include "RenderTypes.h"
+#include "Transform.h"
+
+#include <cstddef>
+#include <string>
+
+namespace dx {
+
+class JobSystem;
+
+namespace AssetType {
+    enum E {
+        // Bytes the pack doesn't interpret.
+        RAW = 0,
+        MESH,
+        TEXTURE,
+        ANIMATION,
+    };
+} // namespace AssetType
+
+namespace AssetCompression {
+    enum E {
+        NONE = 0,
+        // Independent blocks of Lz data, see AssetPackEntry.
+        LZ_BLOCKS,
+    };
+} // namespace AssetCompression
+
+namespace TextureFormat {
+    enum E {
+        // Red in the lowest byte, like PackColor().
+        R8G8B8A8 = 0,
+    };
+} // namespace TextureFormat
+
+// On-disk layout, written by AssetPackWriter. The header is followed by
+// the TOC, sorted by name hash, and the blobs, each starting on a
+// kAlignment boundary so it can be used in place.
+struct AssetPackHeader {
+    static const unsigned int kMagic = 0x4B415044; // "DPAK"
+    static const unsigned int kVersion = 1;
+    static const unsigned int kAlignment = 64;
+
+    unsigned int magic;
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int pad0;
+    unsigned long long tocOffset;
+    unsigned long long fileSize;
+    char pad[32];
+};
+
+struct AssetPackEntry {
+    static const unsigned int kNameLength = 80;
+
+    // FNV-1a of the name, see AssetPack::HashName().
+    unsigned long long nameHash;
+    unsigned long long offset;
+    // Bytes stored in the pack and bytes once decompressed.
+    unsigned long long size;
+    unsigned long long rawSize;
+    unsigned int type;
+    unsigned int compression;
+    // LZ_BLOCKS blobs start with blockCount + 1 offsets into the blob,
+    // block i decompresses to blockSize bytes, the last one to what is
+    // left. A block as large as its raw size is stored uncompressed.
+    unsigned int blockSize;
+    unsigned int blockCount;
+    char name[kNameLength];
+};
+
+// Blob layouts. Headers take kAlignment bytes so the data after them
+// stays aligned.
+struct MeshBlobHeader {
+    unsigned int vertexCount;
+    unsigned int indexCount;
+    // From the start of the blob, vertices follow the header.
+    unsigned int indexOffset;
+    char pad[52];
+};
+
+struct TextureBlobHeader {
+    unsigned int width;
+    unsigned int height;
+    // Bytes per row.
+    unsigned int pitch;
+    unsigned int format;
+    char pad[48];
+};
+
+struct AnimationBlobHeader {
+    unsigned int boneCount;
+    unsigned int frameCount;
+    float framesPerSecond;
+    char pad[52];
+};
+
+// Views into blob data, valid as long as the data is.
+struct MeshView {
+    const Vertex *vertices;
+    UINT vertexCount;
+    const UINT *indices;
+    UINT indexCount;
+};
+
+struct TextureView {
+    UINT width;
+    UINT height;
+    UINT pitch;
+    TextureFormat::E format;
+    const void *pixels;
+};
+
+struct AnimationView {
+    UINT boneCount;
+    UINT frameCount;
+    float framesPerSecond;
+    // frameCount * boneCount local transforms, frame by frame.
+    const Transform *keys;
+};
+
+// A read-only pack mapped into memory. Nothing is read up front beyond
+// the TOC, blobs are paged in by the OS as they are touched. Assets
+// stored uncompressed are used in place, the views point straight into
+// the mapping.
+class AssetPack {
+public:
+    AssetPack();
+    ~AssetPack();
+
+    Error::E Open(const std::string &path);
+    void Close();
+    inline bool IsOpen() const { return _base != nullptr; }
+    inline const std::string& GetPath() const { return _path; }
+
+    inline UINT GetAssetCount() const { return _header ? _header->entryCount : 0; }
+    inline const AssetPackEntry& GetEntry(UINT index) const { return _entries[index]; }
+    // Null if there is no asset named *name*.
+    const AssetPackEntry* Find(const char *name) const;
+
+    // The stored bytes of *entry*, compressed or not.
+    inline const void* GetData(const AssetPackEntry &entry) const { return _base + entry.offset; }
+
+    // Decompresses *entry* into rawSize bytes at *out*, a block per job
+    // when *jobs* is given. Plain blobs are copied.
+    Error::E Decompress(const AssetPackEntry &entry, void *out, JobSystem *jobs) const;
+    // Same for a copy of *entry*'s stored bytes at *blob*.
+    static Error::E DecompressBlob(const AssetPackEntry &entry, const void *blob, void *out, JobSystem *jobs);
+
+    // Views of uncompressed assets in the mapping. False if the asset
+    // is missing, compressed or of another type.
+    bool GetMesh(const char *name, MeshView &view) const;
+    bool GetTexture(const char *name, TextureView &view) const;
+    bool GetAnimation(const char *name, AnimationView &view) const;
+
+    // Views of blob data wherever it is, e.g. decompressed. False if
+    // the blob is too small for what its header claims.
+    static bool ViewMesh(const void *data, size_t size, MeshView &view);
+    static bool ViewTexture(const void *data, size_t size, TextureView &view);
+    static bool ViewAnimation(const void *data, size_t size, AnimationView &view);
+
+    static unsigned long long HashName(const char *name);
+
+private:
+    NO_COPY_ASSIGN(AssetPack);
+
+    // Entry named *name* if it is stored plain and of *type*.
+    const AssetPackEntry* FindPlain(const char *name, AssetType::E type) const;
+    static bool DecompressBlock(const AssetPackEntry &entry, const char *blob, UINT block, char *out);
+
+    std::string _path;
+    // Windows handles, kept out of the header.
+    void *_file;
+    void *_mapping;
+    const char *_base;
+    const AssetPackHeader *_header;
+    const AssetPackEntry *_entries;
+};
+
+} // namespace dx
+#endif // !DXLIB_ASSETPACK_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef DXLIB_ASSETPACKWRITER_H
+#define DXLIB_ASSETPACKWRITER_H
+
+#include "AssetPack.h"
+
+#include <vector>
+
+namespace dx {
+
+struct AssetPackWriterStats {
+    UINT assets;
+    UINT compressed;
+    unsigned long long rawBytes;
+    unsigned long long fileBytes;
+
+    AssetPackWriterStats() { Reset(); }
+
+    void Reset() {
+        assets = compressed = 0;
+        rawBytes = fileBytes = 0;
+    }
+};
+
+// Collects assets in memory and writes them out as an AssetPack.
+// Offline tooling, not meant for use at runtime.
+class AssetPackWriter {
+public:
+    // Uncompressed bytes per Lz block, each one decompresses on its own.
+    static const UINT kBlockSize = 64 * 1024;
+
+    AssetPackWriter();
+    ~AssetPackWriter();
+
+    // Compresses assets added from now on where that saves space.
+    inline void SetCompression(bool value) { _compress = value; }
+
+    // Names must be unique and shorter than AssetPackEntry::kNameLength.
+    void AddRaw(const char *name, AssetType::E type, const void *data, size_t size);
+    void AddMesh(const char *name, const Vertex *vertices, UINT vertexCount, const UINT *indices, UINT indexCount);
+    // *pixels* are tightly packed R8G8B8A8 rows.
+    void AddTexture(const char *name, UINT width, UINT height, const void *pixels);
+    void AddAnimation(const char *name, UINT boneCount, UINT frameCount, float framesPerSecond, const Transform *keys);
+
+    Error::E Write(const std::string &path);
+
+    inline const AssetPackWriterStats& GetStats() const { return _stats; }
+
+private:
+    NO_COPY_ASSIGN(AssetPackWriter);
+
+    struct PendingAsset {
+        AssetPackEntry entry;
+        std::vector<char> data;
+    };
+
+    // Stores *blob* under *name*, compressed if enabled and smaller.
+    void Add(const char *name, AssetType::E type, std::vector<char> &blob);
+
+    bool _compress;
+    // Held by pointer, VS2013 doesn't move the data when growing.
+    std::vector<PendingAsset*> _assets;
+    AssetPackWriterStats _stats;
+};
+
+} // namespace dx
+#endif // !DXLIB_ASSETPACKWRITER_H
\ No newline at end of file
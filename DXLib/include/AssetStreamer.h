@@ -0,0 +1,174 @@
+#ifndef DXLIB_ASSETSTREAMER_H
+#define DXLIB_ASSETSTREAMER_H
+
+#include "Defs.h"
+#include "Err.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+typedef unsigned int UINT;
+
+namespace dx {
+
+class AssetPack;
+struct AssetLoad;
+
+namespace AssetState {
+    enum E {
+        UNLOADED = 0,
+        // Waiting for the I/O thread.
+        QUEUED,
+        // Being read or decoded, or waiting for Update() to deliver it.
+        LOADING,
+        RESIDENT,
+        // The read or decode failed, requesting again retries.
+        FAILED,
+    };
+} // namespace AssetState
+
+struct AssetStreamerStats {
+    unsigned long long requests;
+    unsigned long long cancels;
+    unsigned long long loads;
+    unsigned long long failures;
+    unsigned long long evictions;
+    unsigned long long bytesRead;
+    size_t residentBytes;
+    size_t peakResidentBytes;
+    // Spent on the I/O thread reading and on jobs decoding.
+    double readSeconds;
+    double decodeSeconds;
+
+    AssetStreamerStats() { Reset(); }
+
+    void Reset() {
+        requests = cancels = loads = failures = evictions = bytesRead = 0;
+        residentBytes = peakResidentBytes = 0;
+        readSeconds = decodeSeconds = 0.0;
+    }
+};
+
+// Loads assets of an AssetPack in the background. Requests go to an
+// I/O thread in priority order, which reads each blob with a single
+// large unbuffered read and hands it to a job to decompress. Finished
+// loads come back through a lock-free list that Update() drains on the
+// main thread, which is also the only thread touching residency: when
+// resident assets exceed the budget, the least recently used unpinned
+// ones are evicted.
+// Everything but the I/O thread and decoding jobs runs on the thread
+// calling Update().
+class AssetStreamer {
+public:
+    // Unbuffered reads start and end on sector boundaries, this covers
+    // every sector size in use.
+    static const UINT kReadAlignment = 4096;
+    static const UINT kInvalidAsset = 0xFFFFFFFF;
+
+    AssetStreamer();
+    ~AssetStreamer();
+
+    // Streams from *pack*, which must stay open until Shutdown().
+    // Decodes on *jobs* if given, which must stay initialized until
+    // Shutdown() as well, else on the I/O thread.
+    Error::E Initialize(const AssetPack &pack, JobSystem *jobs, size_t budgetBytes);
+    // Stops the I/O thread, waits for decoding and frees all assets.
+    void Shutdown();
+
+    inline void SetBudget(size_t bytes) { _budget = bytes; }
+    inline size_t GetBudget() const { return _budget; }
+
+    // Index of the asset named *name*, or kInvalidAsset if the pack has
+    // none.
+    UINT FindAsset(const char *name) const;
+
+    // Queues *asset*, higher *priority* first and in request order
+    // among equals. Requesting a queued asset again with a higher
+    // priority moves it up. Resident assets count as used.
+    void Request(UINT asset, int priority);
+    // Drops the request for *asset* unless already delivered, a load in
+    // progress is thrown away when done.
+    void Cancel(UINT asset);
+
+    // Once per frame: delivers finished loads, then evicts down to the
+    // budget.
+    void Update();
+
+    AssetState::E GetState(UINT asset) const;
+    // Decompressed data of a resident asset, null otherwise. Counts as
+    // a use. Stays valid until an Update() evicts it, never while the
+    // asset is pinned.
+    const void* GetData(UINT asset, size_t *size = nullptr);
+    void SetPinned(UINT asset, bool pinned);
+
+    inline const AssetStreamerStats& GetStats() const { return _stats; }
+
+private:
+    NO_COPY_ASSIGN(AssetStreamer);
+
+    struct Record {
+        std::atomic<int> state;
+        // Main thread only, like everything below.
+        int queuedPriority;
+        bool canceled;
+        bool pinned;
+        AssetLoad *load;
+        // Neighbours in the LRU list, most recently used first.
+        UINT prev;
+        UINT next;
+    };
+
+    struct PendingRead {
+        int priority;
+        UINT sequence;
+        UINT asset;
+
+        // Highest priority on top, the oldest request among equals.
+        inline bool operator<(const PendingRead &other) const {
+            if (priority != other.priority) return priority < other.priority;
+            return sequence > other.sequence;
+        }
+    };
+
+    void IoThreadMain();
+    AssetLoad* Read(UINT asset);
+    static void DecodeJob(void *data);
+    void Decode(AssetLoad *load);
+    void Complete(AssetLoad *load);
+
+    void Deliver(AssetLoad *load);
+    void Evict(UINT asset);
+    void Touch(UINT asset);
+    void Unlink(UINT asset);
+
+    const AssetPack *_pack;
+    JobSystem *_jobs;
+    void *_file;
+    size_t _budget;
+
+    Record *_records;
+    UINT _recordCount;
+    UINT _lruHead;
+    UINT _lruTail;
+
+    std::mutex _queueMutex;
+    std::condition_variable _queueSignal;
+    std::priority_queue<PendingRead> _queue;
+    UINT _sequence;
+    bool _quit;
+    std::thread _ioThread;
+
+    // Pushed by the I/O thread and jobs, taken whole by Update().
+    std::atomic<AssetLoad*> _completed;
+    JobCounter _decoding;
+
+    AssetStreamerStats _stats;
+};
+
+} // namespace dx
+#endif // !DXLIB_ASSETSTREAMER_H
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef DXLIB_COMMANDLIST_H
+#define DXLIB_COMMANDLIST_H
+
+#include "Defs.h"
+#include "LinearArena.h"
+#include "RenderTypes.h"
+
+namespace dx {
+
+class RenderSystem;
+
+namespace RenderCommandType {
+    enum E {
+        CLEAR = 0,
+        DRAW,
+    };
+} // namespace RenderCommandType
+
+// Rendering commands recorded now and executed later with
+// RenderSystem::Execute(). Lists come from RenderSystem::CreateCommandList(),
+// each one may be recorded on any thread but only by one at a time, so
+// frames can be recorded in parallel with one list per job.
+//
+// Backends without native command lists replay what was recorded here.
+// The commands live in the list's own arena, so recording doesn't lock
+// or touch the heap once the arena is large enough.
+class CommandList {
+public:
+    static const size_t kDefaultArenaSize = 256 * 1024;
+
+    CommandList(RenderSystem &owner, size_t arenaSize = kDefaultArenaSize);
+    virtual ~CommandList();
+
+    // Starts recording, dropping whatever was recorded before.
+    void Begin();
+    // Finishes recording, the list can be executed until the next Begin().
+    void End();
+
+    void Clear(const Vector4f &color);
+    // The vertices and indices have to stay valid until execution.
+    void Draw(const DrawCommand &command);
+    // Copies the vertices and indices into the list first, for data
+    // that doesn't outlive the recording job.
+    void DrawTransient(const DrawCommand &command);
+
+    inline RenderSystem& GetOwner() const { return *_owner; }
+    inline bool IsRecording() const { return _recording; }
+    inline UINT GetCommandCount() const { return _commandCount; }
+    inline UINT GetDrawCallCount() const { return _drawCount; }
+    inline const LinearArena& GetArena() const { return _arena; }
+
+    // Issues the recorded commands on *r*, in order.
+    void Replay(RenderSystem &r) const;
+
+protected:
+    // Backends with native command lists override these and record
+    // directly. The default keeps the commands for Replay().
+    virtual void OnBegin() { }
+    virtual void OnEnd() { }
+    virtual void OnClear(const Vector4f &color);
+    virtual void OnDraw(const DrawCommand &command, bool transient);
+
+private:
+    NO_COPY_ASSIGN(CommandList);
+
+    struct Command {
+        RenderCommandType::E type;
+        Command *next;
+        Vector4f color;
+        DrawCommand draw;
+    };
+
+    Command* Append(RenderCommandType::E type);
+
+    RenderSystem *_owner;
+    LinearArena _arena;
+    Command *_first;
+    Command *_last;
+    UINT _commandCount;
+    UINT _drawCount;
+    bool _recording;
+};
+
+} // namespace dx
+#endif // !DXLIB_COMMANDLIST_H
\ No newline at end of file
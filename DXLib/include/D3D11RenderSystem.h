@@ -0,0 +1,135 @@
+#ifndef DXLIB_D3D11RENDERSYSTEM_H
+#define DXLIB_D3D11RENDERSYSTEM_H
+
+#include "RenderSystem.h"
+#include "CommandList.h"
+#include "PipelineStateCache.h"
+#include "UploadRing.h"
+
+#include <d3d11_1.h>
+
+namespace dx {
+
+// Renders with Direct3D 11. With a window it presents through a
+// swapchain on the GPU, headless it draws into an offscreen target on
+// WARP instead.
+//
+// Draw() streams vertices, indices and constants through UploadRings
+// over large dynamic buffers, mapped with NO_OVERWRITE. Each frame ends
+// with an event query, its ranges are recycled once the GPU has passed
+// it. Constants need D3D11.1 constant buffer offsetting, without it
+// they are discarded and rewritten per draw instead.
+class D3D11RenderSystem : public RenderSystem {
+public:
+    // Frames the CPU may run ahead of the GPU before Present() waits.
+    static const UINT kFramesInFlight = 3;
+
+    D3D11RenderSystem();
+    virtual ~D3D11RenderSystem();
+
+    virtual RenderBackend::E GetBackend() const { return RenderBackend::D3D11; }
+
+    virtual Error::E Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs);
+
+    virtual bool IsHeadless() const { return _initOk && !_swapChain; }
+
+    virtual void Clear(const Vector4f &color);
+    virtual void Draw(const DrawCommand &command);
+    virtual void Present();
+
+    // Lists record on their own deferred context.
+    virtual CommandList* CreateCommandList();
+    virtual void Execute(CommandList *const *lists, UINT count);
+
+    virtual const UploadRingStats* GetUploadStats(UploadKind::E kind) const;
+
+    // Blend, rasterizer, depth-stencil and sampler states of the device
+    // should all come from here.
+    inline PipelineStateCache& GetStateCache() { return _stateCache; }
+
+private:
+    NO_COPY_ASSIGN(D3D11RenderSystem);
+    friend class D3D11CommandList;
+
+    Error::E InitializeWindowed(const Window &window);
+    Error::E InitializeHeadless(UINT width, UINT height);
+    void FreeResources();
+    Error::E CreateDeviceAndContext(D3D_DRIVER_TYPE driverType);
+    Error::E CreateSwapChain(const Window &window);
+    Error::E CreateOffscreenTarget(UINT width, UINT height);
+    Error::E CreateDepthStencilBuffer();
+    Error::E CreateDrawResources();
+    void BindPipeline(ID3D11DeviceContext *context);
+    void ClearOn(ID3D11DeviceContext *context, const Vector4f &color);
+    void DrawOn(ID3D11DeviceContext *context, const DrawCommand &command);
+    Error::E CreateUploadResources();
+    // Retires frames until all of *command*'s data fits the rings.
+    void MakeUploadRoom(const DrawCommand &command);
+    // Copies *size* bytes into ring *kind*, returns their offset.
+    UINT Upload(UploadKind::E kind, const void *data, UINT size);
+    // Ends the work issued so far with a query its memory is fenced by.
+    void FenceFrame();
+    // Retires the oldest fenced frame, waiting for the GPU if *wait*.
+    bool RetireFrame(bool wait);
+    bool _initOk;
+
+    DXGI_SWAP_CHAIN_DESC _swapDesc;
+    D3D_FEATURE_LEVEL _featureLevel;
+    UINT _msaaQualityLevel;
+
+    ID3D11Device *_device;
+    ID3D11DeviceContext *_context;
+    IDXGISwapChain *_swapChain;
+    PipelineStateCache _stateCache;
+
+    ID3D11RenderTargetView *_renderTargetView;
+    ID3D11DepthStencilView *_depthStencilView;
+
+    // Built-in pipeline for Draw().
+    ID3D11VertexShader *_vertexShader;
+    ID3D11PixelShader *_pixelShader;
+    ID3D11InputLayout *_inputLayout;
+    // Owned by _stateCache.
+    ID3D11RasterizerState *_rasterizerState;
+    ID3D11Buffer *_constantBuffer;
+    ID3D11Buffer *_vertexBuffer;
+    ID3D11Buffer *_indexBuffer;
+
+    // Per-frame data of Draw(), deferred contexts use the discarded
+    // buffers above instead.
+    UploadRing _uploadRings[UploadKind::COUNT];
+    ID3D11Buffer *_uploadBuffers[UploadKind::COUNT];
+    ID3D11Query *_frameQueries[kFramesInFlight];
+    UINT _firstFrameQuery;
+    UINT _framesInFlight;
+    // Only set when constants can be bound at an offset.
+    ID3D11DeviceContext1 *_context1;
+};
+
+// Records straight into a deferred context, Execute() runs the
+// finished ID3D11CommandList on the immediate one.
+class D3D11CommandList : public CommandList {
+public:
+    // Takes ownership of *deferred*.
+    D3D11CommandList(D3D11RenderSystem &owner, ID3D11DeviceContext *deferred);
+    virtual ~D3D11CommandList();
+
+    // Null until End().
+    inline ID3D11CommandList* GetNativeList() const { return _list; }
+
+protected:
+    virtual void OnBegin();
+    virtual void OnEnd();
+    virtual void OnClear(const Vector4f &color);
+    virtual void OnDraw(const DrawCommand &command, bool transient);
+
+private:
+    NO_COPY_ASSIGN(D3D11CommandList);
+
+    D3D11RenderSystem *_system;
+    ID3D11DeviceContext *_deferred;
+    ID3D11CommandList *_list;
+};
+
+} // namespace dx
+#endif // !DXLIB_D3D11RENDERSYSTEM_H
\ No newline at end of file
@@ -4,6 +4,19 @@
 #include "Window.h"
 #include "Timer.h"
 #include "RenderSystem.h"
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "JobSystem.h"
+#include "DoubleBuffer.h"
+#include "InputRecording.h"
+#include "LinearArena.h"
+#include "Telemetry.h"
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace dx {
 
@@ -17,27 +30,192 @@ public:
     // Blocks until application closes.
     void Run();
 
+    // Runs OnUpdate at a fixed rate of *ticksPerSecond*, independently of
+    // the render rate. At most *maxTicksPerFrame* updates run per frame,
+    // time beyond that is dropped so a slow frame can't snowball.
+    void SetFixedTimestep(double ticksPerSecond, UINT maxTicksPerFrame = 5);
+
+    // One OnUpdate per rendered frame with a variable delta (default).
+    void SetVariableTimestep();
+
+    inline bool IsFixedTimestep() const { return _fixedStep > 0.0; }
+
+    // Limits the frame rate, Run() waits out the remainder of each
+    // frame after presenting. 0 runs unpaced (default).
+    void SetTargetFPS(double fps);
+    void SetFrameBudget(double seconds);
+
+    // Exposes the pacing error of the limiter.
+    inline const FramePacer& GetFramePacer() const { return _pacer; }
+
+    // Per-zone frame timings (frame, update, render, present).
+    inline const FrameStats& GetFrameStats() const { return _frameStats; }
+
+    // Configures the job system, call before Initialize(). A worker
+    // count of 0 starts one per remaining hardware thread.
+    void SetJobWorkers(unsigned int workerCount, bool pinThreads = false);
+
+    inline JobSystem& GetJobSystem() { return _jobs; }
+
+    // Sizes the frame arenas, call before Initialize(). Defaults to 1MB.
+    void SetFrameArenaSize(size_t bytes);
+
+    // Scratch memory reset at the start of every frame. In pipelined
+    // mode the reset happens at the sync point, so data the update
+    // hands to the renderer has to go through the double-buffered one.
+    inline LinearArena& GetFrameArena() { return _frameArena; }
+
+    // Memory that stays valid until the end of the next frame.
+    inline DoubleBufferedArena& GetDoubleFrameArena() { return _doubleFrameArena; }
+
+    // Runs OnUpdate for frame N+1 on its own thread while frame N is
+    // rendered, call before Run(). Adds one frame of latency. Update and
+    // render must not share mutable state, hand it over in OnSyncFrame()
+    // (see DoubleBuffer).
+    void SetPipelined(bool value);
+
+    inline bool IsPipelined() const { return _pipelined; }
+
+    // Runs without a window, call before Initialize(). Run() then
+    // renders exactly *frameCount* frames with a simulated delta of
+    // *frameDelta* seconds and prints the frame statistics when done,
+    // so runs are reproducible.
+    void SetHeadless(UINT frameCount, double frameDelta = 1.0 / 60.0);
+
+    inline bool IsHeadless() const { return _headlessFrames > 0; }
+
+    // Picks the RenderSystem implementation, call before Initialize().
+    // Defaults to D3D11, which renders on WARP when headless. Software
+    // rendering uses the job system, headless runs print the hash of
+    // the last frame. The null backend renders nothing and measures
+    // only what submitting the frames costs.
+    void SetRenderBackend(RenderBackend::E backend);
+
+    inline RenderBackend::E GetRenderBackend() const { return _renderBackend; }
+
+    // Records all input of the next Run(), saved to *path* afterwards.
+    void RecordInput(const std::string &path);
+
+    // Feeds input recorded by RecordInput() into the next Run(), frame
+    // by frame. Meant for headless runs, Initialize() fails with
+    // INVALID_SETTINGS if there's a window with a threaded message pump.
+    Error::E ReplayInput(const std::string &path);
+
+    // Publishes the app's telemetry (see Telemetry) to *path* while
+    // Run() is executing, call before Run().
+    void SetTelemetryFile(const std::string &path, unsigned int intervalMs = 100);
+
 protected:
     virtual void OnInitialize(RenderSystem &r) = 0;
     virtual void OnUpdate(const Timer &timer) = 0;
+
+    // Called by Run() with the application's job system so updates can
+    // fan out across cores. Forwards to the version above by default.
+    virtual void OnUpdate(JobSystem &jobs, const Timer &timer) {
+        OnUpdate(timer);
+    }
     virtual void OnRender(RenderSystem &r, const Timer &timer) = 0;
 
-    inline int GetCurrentFPS() const { return (int)_fps; }
-    inline float GetCurrentTPF() const { return 1.0f / _fps; }
+    // Called by Run() with the interpolation factor between the previous
+    // and the current fixed update, in [0, 1). Always 1 when running with
+    // a variable timestep. Forwards to the version above by default.
+    virtual void OnRender(RenderSystem &r, const Timer &timer, float alpha) {
+        OnRender(r, timer);
+    }
+
+    // Called on the main thread between frames in pipelined mode, while
+    // neither OnUpdate nor OnRender is running.
+    virtual void OnSyncFrame() { }
+
+    // Safe to call from OnUpdate in pipelined mode.
+    inline int GetCurrentFPS() const { return (int)_fps.load(std::memory_order_relaxed); }
+    inline float GetCurrentTPF() const { return 1.0f / _fps.load(std::memory_order_relaxed); }
 
     void Quit();
 private:
     void CalculateFPS();
 
+    // Runs the OnUpdate calls for this frame, returns the
+    // interpolation factor to render with.
+    float StepSimulation(const Timer &frameTimer);
+
+    void StartUpdateThread();
+    void StopUpdateThread();
+    void KickUpdate();
+    void WaitForUpdate();
+    void UpdateThreadMain();
+    void ResetFrameArenas();
+    // Drains the event queue into the On* handlers.
+    void DispatchEvents(UINT frame);
+    void UpdateTelemetry(double frameSeconds);
+
     // Measures total runtime.
     Timer _appTimer;
-    bool _isRunning;
-    RenderSystem _renderer;
+    // Quit() may be called from the update thread.
+    std::atomic<bool> _isRunning;
+    RenderSystem *_renderer;
+    RenderBackend::E _renderBackend;
 
     int _frames;
     int _lastFrames;
     double _frameTime;
-    float _fps;
+    // Written by the main thread, read by the update thread.
+    std::atomic<float> _fps;
+
+    // Fixed timestep, 0 when updating once per frame.
+    double _fixedStep;
+    UINT _maxTicksPerFrame;
+    double _accumulator;
+    // Simulation time handed to OnUpdate in fixed timestep mode.
+    Timer _simTimer;
+
+    FramePacer _pacer;
+    FrameStats _frameStats;
+
+    JobSystem _jobs;
+    unsigned int _jobWorkers;
+    bool _pinJobWorkers;
+
+    // Pipelined update, guarded by _updateMutex.
+    bool _pipelined;
+    std::thread _updateThread;
+    std::mutex _updateMutex;
+    std::condition_variable _updateSignal;
+    bool _updateRequested;
+    bool _updateDone;
+    bool _updateQuit;
+    // Copy of _appTimer taken when the update was kicked off.
+    Timer _updateTimer;
+    float _updateAlpha;
+    double _updateSeconds;
+
+    size_t _frameArenaSize;
+    LinearArena _frameArena;
+    DoubleBufferedArena _doubleFrameArena;
+
+    // Headless runs, 0 frames when running with a window.
+    UINT _headlessFrames;
+    double _headlessDelta;
+
+    InputRecording _input;
+    std::string _recordPath;
+    bool _isReplaying;
+
+    std::string _telemetryPath;
+    unsigned int _telemetryInterval;
+    TelemetryCounter _frameCounter;
+    TelemetryGauge _frameTimeGauge;
+    TelemetryGauge _fpsGauge;
+    TelemetryGauge _jobQueueGauge;
+    TelemetryGauge _drawCallGauge;
+    TelemetryGauge _uploadBytesGauge;
+    TelemetryCounter _uploadStallCounter;
+    // Stalls since startup as of the last UpdateTelemetry().
+    unsigned long long _uploadStalls;
+    TelemetryGauge _arenaOverflowGauge;
+    TelemetryCounter _allocCounter;
+    TelemetryGauge _allocBytesGauge;
+    TelemetryGauge _allocPeakGauge;
 };
 
 } // namespace dx
@@ -2,7 +2,26 @@
 #define DXLIB_H
 
 #include "Window.h"
+#include "Event.h"
 #include "DXApp.h"
 #include "Timer.h"
+#include "Profiler.h"
+#include "RenderTypes.h"
+#include "RenderQueue.h"
+#include "CommandList.h"
+#include "SpriteBatch.h"
+#include "Telemetry.h"
+#include "AllocTracker.h"
+#include "JobSystem.h"
+#include "DoubleBuffer.h"
+#include "LinearArena.h"
+#include "FixedPool.h"
+#include "SlotMap.h"
+#include "ECS.h"
+#include "Transform.h"
+#include "AssetPack.h"
+#include "AssetStreamer.h"
+#include "MeshOptimizer.h"
+#include "VertexFormat.h"
 
 #endif // !DXLIB_H
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef DXLIB_DOUBLEBUFFER_H
+#define DXLIB_DOUBLEBUFFER_H
+
+namespace dx {
+
+// Two copies of T, one written by the update while the other is read by
+// the renderer. Swap() between frames, e.g. in DXApp::OnSyncFrame().
+template<typename T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() : _write(0) { }
+
+    inline T& GetWrite() { return _buffers[_write]; }
+    inline const T& GetRead() const { return _buffers[_write ^ 1]; }
+
+    // Publishes the written state and starts the next one from a copy
+    // of it, so updates can keep building on the previous frame.
+    inline void Swap() {
+        _write ^= 1;
+        _buffers[_write] = _buffers[_write ^ 1];
+    }
+
+private:
+    T _buffers[2];
+    int _write;
+};
+
+} // namespace dx
+#endif // !DXLIB_DOUBLEBUFFER_H
\ No newline at end of file
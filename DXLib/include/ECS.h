@@ -0,0 +1,435 @@
+#ifndef DXLIB_ECS_H
+#define DXLIB_ECS_H
+
+#include "Defs.h"
+#include "FixedPool.h"
+#include "JobSystem.h"
+#include "SlotMap.h"
+#include "Timer.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace dx {
+
+// Entities are slot map handles, stale ones simply stop resolving.
+typedef SlotHandle Entity;
+
+typedef unsigned int ComponentId;
+typedef unsigned long long ComponentMask;
+
+static const unsigned int kMaxComponentTypes = 64;
+
+// Entities with the same set of components share an archetype and are
+// stored together in chunks of this size, one array per component.
+static const unsigned int kChunkSize = 16 * 1024;
+
+struct ComponentInfo {
+    size_t size;
+    size_t alignment;
+    void (*construct)(void *memory);
+};
+
+// Assigns ids to component types the first time they are used.
+class ComponentRegistry {
+public:
+    // Fills in *id* unless another thread got there first.
+    static ComponentId Register(const ComponentInfo &info, std::atomic<int> &id);
+    static const ComponentInfo& GetInfo(ComponentId id);
+};
+
+// Components are plain data: they're moved around with memcpy and
+// never destroyed, so they must be trivially copyable.
+template<typename T>
+struct ComponentType {
+    static std::atomic<int> id;
+
+    static inline ComponentId GetId() {
+        int value = id.load(std::memory_order_acquire);
+        if (value >= 0) return static_cast<ComponentId>(value);
+
+        static_assert(std::is_trivially_copyable<T>::value, "Components must be trivially copyable");
+        ComponentInfo info = { sizeof(T), __alignof(T), &Construct };
+        return ComponentRegistry::Register(info, id);
+    }
+
+    static inline ComponentMask GetMask() { return 1ULL << GetId(); }
+
+    static void Construct(void *memory) { new (memory) T(); }
+};
+
+template<typename T>
+std::atomic<int> ComponentType<T>::id(-1);
+
+template<typename... T>
+inline ComponentMask MaskOf() {
+    ComponentMask masks[] = { 0, ComponentType<T>::GetMask()... };
+    ComponentMask mask = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(masks); ++i) {
+        mask |= masks[i];
+    }
+    return mask;
+}
+
+class Archetype;
+
+// Header at the start of every 16KB chunk, component arrays follow.
+struct Chunk {
+    Archetype *archetype;
+    unsigned int count;
+};
+
+class Archetype {
+public:
+    Archetype(ComponentMask mask);
+
+    inline ComponentMask GetMask() const { return _mask; }
+    inline unsigned int GetCapacity() const { return _capacity; }
+    inline const std::vector<Chunk*>& GetChunks() const { return _chunks; }
+    inline unsigned int GetEntityCount() const { return _entityCount; }
+
+    inline bool Has(ComponentId id) const { return _columns[id] >= 0; }
+
+    inline Entity* GetEntities(Chunk *chunk) const {
+        return reinterpret_cast<Entity*>(reinterpret_cast<char*>(chunk) + _entityOffset);
+    }
+
+    // Component array of *id* within *chunk*, null if not part of it.
+    inline void* GetColumn(Chunk *chunk, ComponentId id) const {
+        int column = _columns[id];
+        if (column < 0) return nullptr;
+        return reinterpret_cast<char*>(chunk) + _offsets[column];
+    }
+
+private:
+    NO_COPY_ASSIGN(Archetype);
+    friend class World;
+
+    ComponentMask _mask;
+    std::vector<ComponentId> _ids;
+    // Column index per component id, -1 when not present.
+    int _columns[kMaxComponentTypes];
+    std::vector<unsigned int> _offsets;
+    std::vector<unsigned int> _sizes;
+    unsigned int _entityOffset;
+    unsigned int _capacity;
+
+    // Every chunk but the last is full.
+    std::vector<Chunk*> _chunks;
+    unsigned int _entityCount;
+
+    // Archetypes reached by adding or removing one component.
+    Archetype *_addEdges[kMaxComponentTypes];
+    Archetype *_removeEdges[kMaxComponentTypes];
+};
+
+// The entities and component arrays of one chunk.
+class ChunkView {
+public:
+    ChunkView(const Archetype *archetype, Chunk *chunk)
+        : _archetype(archetype), _chunk(chunk) { }
+
+    inline unsigned int GetCount() const { return _chunk->count; }
+    inline const Entity* GetEntities() const { return _archetype->GetEntities(_chunk); }
+
+    // Null when the chunk's archetype doesn't have a T.
+    template<typename T>
+    inline T* Get() const {
+        return static_cast<T*>(_archetype->GetColumn(_chunk, ComponentType<T>::GetId()));
+    }
+
+private:
+    const Archetype *_archetype;
+    Chunk *_chunk;
+};
+
+// Matches archetypes that have all of one set of components and none
+// of another.
+struct Query {
+    ComponentMask all;
+    ComponentMask none;
+
+    template<typename... T>
+    static inline Query With() {
+        Query query = { MaskOf<T...>(), 0 };
+        return query;
+    }
+
+    template<typename... T>
+    inline Query Without() const {
+        Query query = { all, none | MaskOf<T...>() };
+        return query;
+    }
+
+    inline bool Matches(ComponentMask mask) const {
+        return (mask & all) == all && (mask & none) == 0;
+    }
+};
+
+class World;
+
+// Structural changes recorded while iterating or from jobs, applied in
+// order by Playback(). Thread-safe. Entities created here get pending
+// handles that AddComponent() accepts until the buffer is played back.
+class CommandBuffer {
+public:
+    CommandBuffer();
+
+    Entity CreateEntity();
+    void DestroyEntity(Entity entity);
+
+    template<typename T>
+    void AddComponent(Entity entity, const T &value) {
+        Record(ADD, entity, ComponentType<T>::GetId(), &value, sizeof(T));
+    }
+
+    template<typename T>
+    void RemoveComponent(Entity entity) {
+        Record(REMOVE, entity, ComponentType<T>::GetId(), nullptr, 0);
+    }
+
+    // Applies and clears all commands. Entities created by the buffer
+    // are appended to *created* if given, in creation order.
+    void Playback(World &world, std::vector<Entity> *created = nullptr);
+
+    inline bool IsEmpty() const { return _commands.empty(); }
+
+private:
+    NO_COPY_ASSIGN(CommandBuffer);
+
+    enum CommandType { CREATE, DESTROY, ADD, REMOVE };
+
+    struct Command {
+        CommandType type;
+        Entity entity;
+        ComponentId component;
+        // Offset of the component value in _data.
+        unsigned int dataOffset;
+    };
+
+    void Record(CommandType type, Entity entity, ComponentId component,
+                const void *data, size_t size);
+
+    std::mutex _mutex;
+    std::vector<Command> _commands;
+    std::vector<char> _data;
+    unsigned int _pendingCount;
+};
+
+// Owns all entities and their components.
+class World {
+public:
+    World();
+    ~World();
+
+    Entity CreateEntity();
+    // Creates an entity with default constructed components of *mask*.
+    Entity CreateEntity(ComponentMask mask);
+    void DestroyEntity(Entity entity);
+
+    inline bool IsAlive(Entity entity) const { return _entities.Contains(entity); }
+    inline unsigned int GetEntityCount() const { return _entities.GetSize(); }
+
+    template<typename T>
+    T* AddComponent(Entity entity) {
+        return static_cast<T*>(AddComponent(entity, ComponentType<T>::GetId()));
+    }
+
+    template<typename T>
+    T* AddComponent(Entity entity, const T &value) {
+        T *component = AddComponent<T>(entity);
+        if (component) *component = value;
+        return component;
+    }
+
+    template<typename T>
+    void RemoveComponent(Entity entity) {
+        RemoveComponent(entity, ComponentType<T>::GetId());
+    }
+
+    template<typename T>
+    T* GetComponent(Entity entity) const {
+        return static_cast<T*>(GetComponent(entity, ComponentType<T>::GetId()));
+    }
+
+    template<typename T>
+    bool HasComponent(Entity entity) const {
+        return GetComponent(entity, ComponentType<T>::GetId()) != nullptr;
+    }
+
+    // Untyped versions, AddComponent default constructs.
+    void* AddComponent(Entity entity, ComponentId id);
+    void RemoveComponent(Entity entity, ComponentId id);
+    void* GetComponent(Entity entity, ComponentId id) const;
+
+    // Calls func(ChunkView&) for every chunk matching *query*.
+    template<typename F>
+    void ForEachChunk(const Query &query, const F &func);
+
+    // Calls func(Entity, C&...) for every entity that has all of C.
+    template<typename... C, typename F>
+    void ForEach(const F &func);
+
+    // ForEach with chunks spread across the job system, *func* runs
+    // concurrently and must only touch the entity it is given.
+    template<typename... C, typename F>
+    void ParallelForEach(JobSystem &jobs, const F &func);
+
+    // Chunks matching *query*, in archetype order.
+    void GetChunks(const Query &query, std::vector<ChunkView> &out) const;
+
+private:
+    NO_COPY_ASSIGN(World);
+
+    struct EntityRecord {
+        Archetype *archetype;
+        Chunk *chunk;
+        unsigned int row;
+    };
+
+    template<typename F, typename... P>
+    static void ForEachInChunk(const F &func, const Entity *entities, unsigned int count, P*... columns) {
+        for (unsigned int i = 0; i < count; ++i) {
+            func(entities[i], columns[i]...);
+        }
+    }
+
+    Archetype* GetArchetype(ComponentMask mask);
+    // Appends a row for *entity* to *archetype*, components are left
+    // uninitialized.
+    void AllocateRow(Archetype *archetype, Entity entity, EntityRecord &record);
+    // Fills the hole at *record* with the archetype's last row.
+    void FreeRow(const EntityRecord &record);
+    void MoveEntity(Entity entity, EntityRecord &record, Archetype *target);
+
+    inline void AssertNotIterating() const {
+        assert(_iterating.load() == 0 && "Structural change while iterating, use a CommandBuffer");
+    }
+
+    SlotMap<EntityRecord> _entities;
+    std::unordered_map<ComponentMask, Archetype*> _archetypeMap;
+    std::vector<Archetype*> _archetypes;
+    FixedPool _chunkPool;
+    std::atomic<int> _iterating;
+};
+
+template<typename F>
+void World::ForEachChunk(const Query &query, const F &func) {
+    _iterating.fetch_add(1);
+    for (size_t a = 0; a < _archetypes.size(); ++a) {
+        Archetype *archetype = _archetypes[a];
+        if (!query.Matches(archetype->GetMask())) continue;
+
+        const std::vector<Chunk*> &chunks = archetype->GetChunks();
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            ChunkView view(archetype, chunks[c]);
+            func(view);
+        }
+    }
+    _iterating.fetch_sub(1);
+}
+
+template<typename... C, typename F>
+void World::ForEach(const F &func) {
+    ForEachChunk(Query::With<C...>(), [&func](ChunkView &view) {
+        ForEachInChunk(func, view.GetEntities(), view.GetCount(), view.Get<C>()...);
+    });
+}
+
+template<typename... C, typename F>
+void World::ParallelForEach(JobSystem &jobs, const F &func) {
+    std::vector<ChunkView> chunks;
+    GetChunks(Query::With<C...>(), chunks);
+
+    _iterating.fetch_add(1);
+    jobs.ParallelFor(0, static_cast<unsigned int>(chunks.size()), 1,
+        [&chunks, &func](unsigned int first, unsigned int last) {
+            for (unsigned int i = first; i < last; ++i) {
+                ChunkView &view = chunks[i];
+                ForEachInChunk(func, view.GetEntities(), view.GetCount(), view.Get<C>()...);
+            }
+        });
+    _iterating.fetch_sub(1);
+}
+
+// Game logic over the world. Systems declare which components they
+// read and write, the scheduler runs systems without conflicts in
+// parallel. Structural changes go through the command buffer.
+class System {
+public:
+    explicit System(const char *name) : _name(name), _reads(0), _writes(0) { }
+    virtual ~System() { }
+
+    virtual void Update(World &world, CommandBuffer &commands,
+                        JobSystem &jobs, const Timer &timer) = 0;
+
+    inline const char* GetName() const { return _name; }
+    inline ComponentMask GetReads() const { return _reads; }
+    inline ComponentMask GetWrites() const { return _writes; }
+
+    // Two systems conflict when one writes what the other accesses.
+    inline bool ConflictsWith(const System &other) const {
+        return (_writes & (other._reads | other._writes)) != 0 ||
+               (_reads & other._writes) != 0;
+    }
+
+protected:
+    template<typename... T>
+    void Reads() { _reads |= MaskOf<T...>(); }
+
+    template<typename... T>
+    void Writes() { _writes |= MaskOf<T...>(); }
+
+private:
+    NO_COPY_ASSIGN(System);
+
+    const char *_name;
+    ComponentMask _reads;
+    ComponentMask _writes;
+};
+
+// Runs systems in waves. A system goes into the wave after the last
+// earlier system it conflicts with, so conflicting systems keep their
+// order and everything else runs side by side. Command buffers are
+// played back in system order once all waves are done.
+class SystemScheduler {
+public:
+    SystemScheduler();
+    ~SystemScheduler();
+
+    // The scheduler doesn't take ownership.
+    void Add(System *system);
+
+    void Run(World &world, JobSystem &jobs, const Timer &timer);
+
+    inline unsigned int GetWaveCount() const { return static_cast<unsigned int>(_waves.size()); }
+
+private:
+    NO_COPY_ASSIGN(SystemScheduler);
+
+    struct SystemJob {
+        System *system;
+        CommandBuffer *commands;
+        World *world;
+        JobSystem *jobs;
+        const Timer *timer;
+    };
+
+    static void RunSystem(void *data);
+    void BuildWaves();
+
+    std::vector<System*> _systems;
+    std::vector<CommandBuffer*> _commands;
+    // System indices per wave.
+    std::vector<std::vector<unsigned int>> _waves;
+    bool _dirty;
+};
+
+} // namespace dx
+#endif // !DXLIB_ECS_H
\ No newline at end of file
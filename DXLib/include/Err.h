@@ -26,6 +26,16 @@ namespace dx {
 
             // Standard render format not supported
             RENDER_FORMAT_NOT_SUPPORTED,
+
+            // A file couldn't be opened for reading or writing.
+            FILE_OPEN_FAIL,
+
+            // A file was truncated or isn't in the expected format.
+            FILE_FORMAT_INVALID,
+
+            // Settings that can't be combined, like replaying input into a
+            // window with a threaded message pump.
+            INVALID_SETTINGS,
         };
     } // namespace error
 } // namespace dx
@@ -0,0 +1,85 @@
+#ifndef DXLIB_EVENT_H
+#define DXLIB_EVENT_H
+
+#include "Defs.h"
+#include "SpscRing.h"
+
+#include <atomic>
+
+namespace dx {
+
+namespace EventType {
+    enum E {
+        NONE = 0,
+        KEY_DOWN,
+        KEY_UP,
+        // Translated character input.
+        TEXT,
+        MOUSE_MOVE,
+        MOUSE_DOWN,
+        MOUSE_UP,
+        MOUSE_WHEEL,
+        FOCUS_GAINED,
+        FOCUS_LOST,
+        MINIMIZED,
+        MAXIMIZED,
+        RESIZED,
+        CLOSE,
+    };
+} // namespace EventType
+
+namespace MouseButton {
+    enum E {
+        LEFT = 0,
+        RIGHT,
+        MIDDLE,
+    };
+} // namespace MouseButton
+
+// Platform neutral input or window event. Key codes are the platform's
+// virtual key codes.
+struct Event {
+    EventType::E type;
+    // Raw Timer ticks of when the platform delivered the event.
+    unsigned long long timestamp;
+
+    union {
+        struct { unsigned int code; bool repeat; } key;
+        struct { unsigned int codepoint; } text;
+        // Client coordinates, wheel deltas are in notches.
+        struct { int x, y; MouseButton::E button; float wheel; } mouse;
+        struct { unsigned int width, height; } size;
+    };
+};
+
+// Producers push events as they arrive, the game thread drains them in
+// batches once per frame. Single producer, single consumer.
+class EventQueue {
+public:
+    static const unsigned int kCapacity = 1024;
+
+    EventQueue() : _dropped(0) { }
+
+    // Producer side. Events that don't fit are dropped and counted.
+    inline bool Push(const Event &event) {
+        if (_ring.TryPush(event)) return true;
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Consumer side, returns the number of events written to *out*.
+    inline unsigned int Drain(Event *out, unsigned int maxCount) {
+        return _ring.PopBatch(out, maxCount);
+    }
+
+    inline unsigned int GetDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    NO_COPY_ASSIGN(EventQueue);
+
+    SpscRing<Event, kCapacity> _ring;
+    std::atomic<unsigned int> _dropped;
+};
+
+} // namespace dx
+#endif // !DXLIB_EVENT_H
\ No newline at end of file
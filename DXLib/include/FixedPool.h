@@ -0,0 +1,91 @@
+#ifndef DXLIB_FIXEDPOOL_H
+#define DXLIB_FIXEDPOOL_H
+
+#include "Defs.h"
+
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dx {
+
+// Allocates blocks of one fixed size out of larger pages, freed blocks
+// are reused and pages are only released with the pool. Job system
+// workers allocate and free through a private cache of blocks without
+// locking, other threads go through the shared free list.
+class FixedPool {
+public:
+    // Blocks a thread cache moves to or from the shared list at a time.
+    static const unsigned int kCacheBatch = 32;
+
+    FixedPool();
+    ~FixedPool();
+
+    // Blocks are at least *blockSize* bytes and 16 byte aligned.
+    void Initialize(size_t blockSize, size_t blocksPerPage = 256);
+    void Shutdown();
+
+    void* Allocate();
+    void Free(void *block);
+
+    inline size_t GetBlockSize() const { return _blockSize; }
+    inline size_t GetPageCount() const { return _pages.size(); }
+
+private:
+    NO_COPY_ASSIGN(FixedPool);
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    // One per job system thread, padded to its own cache line.
+    struct ThreadCache {
+        FreeBlock *head;
+        unsigned int count;
+        char pad[64 - sizeof(FreeBlock*) - sizeof(unsigned int)];
+    };
+
+    FreeBlock* AllocateShared();
+    void FreeShared(FreeBlock *block);
+    void Refill(ThreadCache &cache);
+    void Drain(ThreadCache &cache);
+    // Called with _mutex held.
+    void AddPage();
+
+    size_t _blockSize;
+    size_t _blocksPerPage;
+    std::vector<void*> _pages;
+    ThreadCache *_caches;
+
+    std::mutex _mutex;
+    FreeBlock *_free;
+};
+
+// FixedPool for objects of type T.
+template<typename T>
+class ObjectPool {
+public:
+    explicit ObjectPool(size_t objectsPerPage = 256) {
+        _pool.Initialize(sizeof(T), objectsPerPage);
+    }
+
+    template<typename... Args>
+    inline T* New(Args&&... args) {
+        return new (_pool.Allocate()) T(std::forward<Args>(args)...);
+    }
+
+    inline void Delete(T *object) {
+        if (!object) return;
+        object->~T();
+        _pool.Free(object);
+    }
+
+private:
+    NO_COPY_ASSIGN(ObjectPool);
+
+    FixedPool _pool;
+};
+
+} // namespace dx
+#endif // !DXLIB_FIXEDPOOL_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef DXLIB_FRAMEPACER_H
+#define DXLIB_FRAMEPACER_H
+
+#include "Defs.h"
+
+namespace dx {
+
+// Keeps frames at a steady rate by waiting out the rest of each frame's
+// budget. Sleeps while there is plenty of time left and spins for the
+// remainder, the spin window adapts to how much Sleep() oversleeps.
+class FramePacer {
+public:
+    FramePacer();
+    ~FramePacer();
+
+    // Pacing is disabled with a target or budget of 0 (default).
+    void SetTargetFPS(double fps);
+    void SetFrameBudget(double seconds);
+
+    inline double GetFrameBudget() const { return _budget; }
+    inline bool IsEnabled() const { return _budget > 0.0; }
+
+    // Starts a new measurement, call right before the first frame.
+    void Reset();
+
+    // Blocks until the current frame's budget is used up.
+    void Wait();
+
+    // How far off the last frame's duration was from the budget,
+    // in seconds. Positive when the frame ran long.
+    inline double GetLastError() const { return _lastError; }
+
+    // Mean and worst absolute pacing error since Reset().
+    double GetMeanError() const;
+    inline double GetMaxError() const { return _maxError; }
+
+    // Remaining time below which Wait() spins instead of sleeping.
+    inline double GetSpinThreshold() const { return _spinThreshold; }
+
+private:
+    NO_COPY_ASSIGN(FramePacer);
+
+    double _budget;
+    double _spinThreshold;
+
+    // Raw Timer ticks.
+    unsigned long long _deadline;
+    unsigned long long _lastFrameEnd;
+
+    double _lastError;
+    double _maxError;
+    double _errorSum;
+    unsigned long long _frames;
+
+    // Whether we raised the system timer resolution.
+    bool _timerPeriodSet;
+};
+
+} // namespace dx
+#endif // !DXLIB_FRAMEPACER_H
\ No newline at end of file
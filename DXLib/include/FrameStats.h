@@ -0,0 +1,102 @@
+#ifndef DXLIB_FRAMESTATS_H
+#define DXLIB_FRAMESTATS_H
+
+#include "Defs.h"
+
+#include <ostream>
+
+namespace dx {
+
+// Fixed-size histogram of durations with logarithmic buckets, eight
+// per power of two of microseconds, so percentiles are accurate to
+// within ~6%. Recording never allocates.
+class TimeHistogram {
+public:
+    // Covers 1us to ~38 hours (2^37us).
+    static const int kBucketCount = 16 + 8 * 33;
+
+    TimeHistogram();
+
+    void Record(double seconds);
+    void Merge(const TimeHistogram &other);
+    void Reset();
+
+    // Duration below which *percentile* (0-100) percent of samples fall.
+    double GetPercentile(double percentile) const;
+
+    inline unsigned long long GetCount() const { return _count; }
+    inline double GetMin() const { return _count ? _min : 0.0; }
+    inline double GetMax() const { return _max; }
+    inline double GetMean() const { return _count ? _sum / _count : 0.0; }
+
+private:
+    unsigned int _buckets[kBucketCount];
+    unsigned long long _count;
+    double _sum;
+    double _min;
+    double _max;
+};
+
+namespace FrameZone {
+    enum E {
+        // Total time between the start of two frames.
+        FRAME = 0,
+        UPDATE,
+        RENDER,
+        PRESENT,
+        COUNT
+    };
+} // namespace FrameZone
+
+struct ZoneStats {
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    double mean;
+    unsigned long long count;
+};
+
+struct FrameStatsSnapshot {
+    ZoneStats zones[FrameZone::COUNT];
+    unsigned long long frames;
+};
+
+// Rolling per-zone frame timings. Statistics cover the most recent
+// windowFrames to 2 * windowFrames frames, lifetime histograms are
+// kept alongside for end-of-run reports and tail latency checks.
+class FrameStats {
+public:
+    explicit FrameStats(unsigned int windowFrames = 600);
+
+    void Record(FrameZone::E zone, double seconds);
+
+    // Call once all zones of a frame were recorded.
+    void EndFrame();
+
+    void Reset();
+
+    void GetSnapshot(FrameStatsSnapshot &out) const;
+
+    // Everything recorded since the last Reset().
+    inline const TimeHistogram& GetLifetime(FrameZone::E zone) const { return _lifetime[zone]; }
+
+    inline unsigned long long GetFrameCount() const { return _frames; }
+
+    // Writes a human readable table of the lifetime statistics.
+    void Print(std::ostream &out) const;
+
+    static const char* GetZoneName(FrameZone::E zone);
+
+private:
+    TimeHistogram _current[FrameZone::COUNT];
+    TimeHistogram _previous[FrameZone::COUNT];
+    TimeHistogram _lifetime[FrameZone::COUNT];
+
+    unsigned int _windowFrames;
+    unsigned int _framesInWindow;
+    unsigned long long _frames;
+};
+
+} // namespace dx
+#endif // !DXLIB_FRAMESTATS_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef DXLIB_INPUTRECORDING_H
+#define DXLIB_INPUTRECORDING_H
+
+#include "Defs.h"
+#include "Err.h"
+#include "Event.h"
+
+#include <string>
+#include <vector>
+
+namespace dx {
+
+struct InputRecord {
+    unsigned int frame;
+    Event event;
+};
+
+// Events stamped with the frame they were handled in. Recorded from a
+// live window, then replayed into a headless DXApp to get the exact
+// same input on every run.
+class InputRecording {
+public:
+    InputRecording();
+
+    void Clear();
+
+    // Frame that Add() stamps records with.
+    inline void SetFrame(unsigned int frame) { _frame = frame; }
+    void Add(const Event &event);
+
+    // Records of *frame*, frames must be requested in increasing order.
+    // Returns the number of records, *first* points at the first one.
+    size_t GetFrame(unsigned int frame, const InputRecord *&first);
+
+    inline const std::vector<InputRecord>& GetRecords() const { return _records; }
+
+    Error::E Save(const std::string &path) const;
+    Error::E Load(const std::string &path);
+
+private:
+    NO_COPY_ASSIGN(InputRecording);
+
+    std::vector<InputRecord> _records;
+    unsigned int _frame;
+    // Replay position in _records.
+    size_t _cursor;
+};
+
+} // namespace dx
+#endif // !DXLIB_INPUTRECORDING_H
\ No newline at end of file
@@ -0,0 +1,189 @@
+#ifndef DXLIB_JOBSYSTEM_H
+#define DXLIB_JOBSYSTEM_H
+
+#include "Defs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dx {
+
+template<typename T, unsigned int Capacity> class WorkStealingDeque;
+
+typedef void (*JobFunction)(void *data);
+
+// Counts outstanding jobs. Used to wait for a batch of jobs and to
+// make jobs depend on each other.
+class JobCounter {
+public:
+    JobCounter() : _value(0) { }
+
+    inline bool IsDone() const { return _value.load(std::memory_order_acquire) == 0; }
+
+private:
+    NO_COPY_ASSIGN(JobCounter);
+    friend class JobSystem;
+
+    std::atomic<int> _value;
+};
+
+struct Job {
+    JobFunction function;
+    void *data;
+    // Decremented once the job has finished, may be null.
+    JobCounter *counter;
+    // The job won't start before this reaches zero, may be null. The
+    // jobs it counts must have been Run() before this one is.
+    JobCounter *dependency;
+};
+
+inline Job MakeJob(JobFunction function, void *data,
+                   JobCounter *counter = nullptr, JobCounter *dependency = nullptr) {
+    Job job = { function, data, counter, dependency };
+    return job;
+}
+
+// Work-stealing job scheduler. Every worker owns a Chase-Lev deque it
+// pushes to and pops from, idle workers steal from the others. The
+// thread calling Initialize() participates as worker 0 whenever it
+// waits. Threads that aren't workers can still submit and wait, their
+// jobs go through a shared queue.
+// Only one JobSystem may be initialized at a time.
+class JobSystem {
+public:
+    // Upper bound for GetThreadCount().
+    static const unsigned int kMaxThreads = 64;
+    // Jobs each worker can hold before Run() executes them inline.
+    static const unsigned int kDequeSize = 4096;
+
+    JobSystem();
+    ~JobSystem();
+
+    // Starts *workerCount* threads besides the calling one, 0 picks one
+    // per remaining hardware thread. Pinning locks worker N to logical
+    // processor N, across processor groups where there are several.
+    void Initialize(unsigned int workerCount = 0, bool pinThreads = false);
+
+    // Waits for the workers to finish their current job and joins them.
+    // Queued jobs that haven't started are dropped.
+    void Shutdown();
+
+    inline bool IsInitialized() const { return !_deques.empty(); }
+
+    // Workers plus the thread that called Initialize().
+    inline unsigned int GetThreadCount() const { return static_cast<unsigned int>(_deques.size()); }
+
+    // Index of the calling worker, 0 for the initializing thread and
+    // -1 for threads that don't belong to the job system.
+    static int GetThreadIndex();
+
+    void Run(const Job &job);
+    void Run(const Job *jobs, unsigned int count);
+
+    // Executes other jobs until *counter* reaches zero.
+    void Wait(const JobCounter &counter);
+
+    // Calls body(first, last) over [begin, end) in chunks of at least
+    // *grainSize* items, spread across all workers. Blocks until done.
+    template<typename F>
+    void ParallelFor(unsigned int begin, unsigned int end, unsigned int grainSize, const F &body);
+
+    // Jobs queued but not started yet, for statistics.
+    inline unsigned int GetQueueDepth() const {
+        int pending = _pending.load(std::memory_order_relaxed);
+        return pending > 0 ? static_cast<unsigned int>(pending) : 0;
+    }
+
+private:
+    NO_COPY_ASSIGN(JobSystem);
+
+    typedef WorkStealingDeque<Job, kDequeSize> Deque;
+
+    template<typename F>
+    struct ParallelForData {
+        const F *body;
+        unsigned int end;
+        unsigned int grainSize;
+        std::atomic<unsigned int> next;
+    };
+
+    template<typename F>
+    static void ParallelForJob(void *data);
+
+    void WorkerMain(unsigned int index, bool pin);
+    bool TryGetJob(int index, Job &job);
+    void Execute(const Job &job);
+    void Submit(const Job &job);
+
+    std::vector<Deque*> _deques;
+    std::vector<std::thread> _threads;
+
+    // Jobs from threads without a deque.
+    std::mutex _sharedMutex;
+    std::deque<Job> _shared;
+    std::atomic<int> _sharedCount;
+
+    // Idle workers sleep on this once spinning turned up nothing.
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<int> _sleeping;
+    std::atomic<int> _pending;
+    std::atomic<bool> _quit;
+};
+
+template<typename F>
+void JobSystem::ParallelForJob(void *data) {
+    ParallelForData<F> *pf = static_cast<ParallelForData<F>*>(data);
+
+    // Chunks are claimed dynamically, so jobs that get stolen late
+    // simply find less work left.
+    for (;;) {
+        unsigned int first = pf->next.fetch_add(pf->grainSize, std::memory_order_relaxed);
+        if (first >= pf->end) break;
+
+        unsigned int last = first + pf->grainSize;
+        if (last > pf->end || last < first) last = pf->end;
+        (*pf->body)(first, last);
+    }
+}
+
+template<typename F>
+void JobSystem::ParallelFor(unsigned int begin, unsigned int end,
+                            unsigned int grainSize, const F &body) {
+    if (begin >= end) return;
+    if (grainSize == 0) grainSize = 1;
+
+    unsigned int chunks = (end - begin + grainSize - 1) / grainSize;
+    if (!IsInitialized() || chunks == 1) {
+        body(begin, end);
+        return;
+    }
+
+    ParallelForData<F> data;
+    data.body = &body;
+    data.end = end;
+    data.grainSize = grainSize;
+    data.next.store(begin, std::memory_order_relaxed);
+
+    // One job per thread is enough, each keeps claiming chunks.
+    unsigned int jobCount = GetThreadCount();
+    if (jobCount > chunks) jobCount = chunks;
+
+    JobCounter counter;
+    Job jobs[kMaxThreads];
+    for (unsigned int i = 0; i < jobCount - 1; ++i) {
+        jobs[i] = MakeJob(&ParallelForJob<F>, &data, &counter);
+    }
+    Run(jobs, jobCount - 1);
+
+    // The calling thread takes a share as well.
+    ParallelForJob<F>(&data);
+    Wait(counter);
+}
+
+} // namespace dx
+#endif // !DXLIB_JOBSYSTEM_H
\ No newline at end of file
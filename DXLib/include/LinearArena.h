@@ -0,0 +1,155 @@
+#ifndef DXLIB_LINEARARENA_H
+#define DXLIB_LINEARARENA_H
+
+#include "Defs.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dx {
+
+// Bump allocator, individual allocations are never freed, Reset()
+// releases everything at once. Allocate() is lock-free and may be
+// called from several threads, Reset() must not race with it.
+// Allocations that don't fit anymore fall back to the heap until the
+// next Reset(), the high-water mark tells how big the arena should be.
+class LinearArena {
+public:
+    LinearArena();
+    ~LinearArena();
+
+    void Initialize(size_t capacity);
+    void Shutdown();
+
+    // *alignment* must be a power of two.
+    void* Allocate(size_t size, size_t alignment = 16);
+
+    // Uninitialized storage for *count* objects of T.
+    template<typename T>
+    inline T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, __alignof(T)));
+    }
+
+    // Constructs a T in the arena. Destructors are never run, so this
+    // is meant for trivially destructible types.
+    template<typename T>
+    inline T* New() {
+        void *memory = Allocate(sizeof(T), __alignof(T));
+        return new (memory) T();
+    }
+
+    void Reset();
+
+    inline size_t GetCapacity() const { return _capacity; }
+    // Bytes handed out since the last Reset(), including overflow.
+    inline size_t GetUsed() const {
+        return _offset.load(std::memory_order_relaxed) + _overflowBytes.load(std::memory_order_relaxed);
+    }
+    // Highest GetUsed() seen at any Reset().
+    size_t GetHighWaterMark() const;
+    // Allocations that went to the heap since the last Reset().
+    inline size_t GetOverflowCount() const { return _overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    NO_COPY_ASSIGN(LinearArena);
+
+    void* AllocateOverflow(size_t size, size_t alignment);
+
+    char *_memory;
+    size_t _capacity;
+    std::atomic<size_t> _offset;
+    size_t _highWaterMark;
+
+    std::mutex _overflowMutex;
+    std::vector<void*> _overflow;
+    std::atomic<size_t> _overflowBytes;
+    std::atomic<size_t> _overflowCount;
+};
+
+// Two arenas used in turns. Memory allocated during one frame stays
+// valid until the end of the next, for data that is produced in one
+// frame and consumed in the following one.
+class DoubleBufferedArena {
+public:
+    DoubleBufferedArena() : _current(0) { }
+
+    void Initialize(size_t capacityPerFrame);
+    void Shutdown();
+
+    // Starts a new frame, releases what was allocated two frames ago.
+    void Flip();
+
+    inline void* Allocate(size_t size, size_t alignment = 16) {
+        return _arenas[_current].Allocate(size, alignment);
+    }
+
+    inline LinearArena& GetCurrent() { return _arenas[_current]; }
+    inline LinearArena& GetPrevious() { return _arenas[_current ^ 1]; }
+
+    size_t GetHighWaterMark() const;
+
+private:
+    NO_COPY_ASSIGN(DoubleBufferedArena);
+
+    LinearArena _arenas[2];
+    int _current;
+};
+
+// STL allocator on top of a LinearArena, deallocate() is a no-op.
+// Containers using it must not outlive the arena's next Reset().
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind { typedef ArenaAllocator<U> other; };
+
+    ArenaAllocator(LinearArena &arena) : _arena(&arena) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other.GetArena()) { }
+
+    inline T* allocate(size_t count, const void *hint = 0) {
+        return _arena->AllocateArray<T>(count);
+    }
+    inline void deallocate(T *ptr, size_t count) { }
+
+    inline size_t max_size() const { return static_cast<size_t>(-1) / sizeof(T); }
+
+    template<typename U, typename... Args>
+    inline void construct(U *ptr, Args&&... args) {
+        new (ptr) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    inline void destroy(U *ptr) { ptr->~U(); }
+
+    inline LinearArena* GetArena() const { return _arena; }
+
+private:
+    LinearArena *_arena;
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.GetArena() == b.GetArena();
+}
+
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.GetArena() != b.GetArena();
+}
+
+} // namespace dx
+#endif // !DXLIB_LINEARARENA_H
\ No newline at end of file
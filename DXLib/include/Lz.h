@@ -0,0 +1,24 @@
+#ifndef DXLIB_LZ_H
+#define DXLIB_LZ_H
+
+#include <cstddef>
+
+namespace dx {
+
+// Byte-oriented LZ77 in the spirit of LZ4: sequences of literals
+// followed by a match of at least 4 bytes up to 64KB back. Decoding is
+// a few branches and copies per sequence, fast enough to run on load.
+
+// Worst case compressed size of *size* bytes.
+size_t LzCompressBound(size_t size);
+
+// Compresses *size* bytes of *in* into *out*. Returns the compressed
+// size, or 0 if it wouldn't fit in *capacity* bytes.
+size_t LzCompress(const void *in, size_t size, void *out, size_t capacity);
+
+// Decompresses *size* bytes of *in* into exactly *outSize* bytes of
+// *out*. False if the data is corrupt or doesn't decode to that size.
+bool LzDecompress(const void *in, size_t size, void *out, size_t outSize);
+
+} // namespace dx
+#endif // !DXLIB_LZ_H
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef DXLIB_MESHOPTIMIZER_H
+#define DXLIB_MESHOPTIMIZER_H
+
+#include "Defs.h"
+#include "RenderTypes.h"
+
+namespace dx {
+
+class JobSystem;
+
+// Reorders triangle lists for the rasterizer, in this order: triangles
+// for the post-transform vertex cache, then clusters of them so faces
+// pointing outward draw first and hide what's behind them, then the
+// vertices in the order the indices first use them.
+
+// Size of the LRU cache OptimizeVertexCache() scores against. Works well
+// for caches of any size, so it needn't match the hardware.
+static const UINT kVertexCacheSize = 32;
+// Size of the FIFO cache AnalyzeVertexCache() simulates by default.
+static const UINT kVertexCacheAnalyzeSize = 16;
+
+struct VertexCacheStats {
+    UINT triangles;
+    // Vertices the indices refer to.
+    UINT vertices;
+    // Vertices shaded, once per cache miss.
+    UINT transforms;
+    // Average cache miss ratio, transforms per triangle. 0.5 at best on
+    // large regular meshes, 3 at worst.
+    float acmr;
+    // Average transform to vertex ratio, 1 at best.
+    float atvr;
+};
+
+// A triangle list to optimize in place.
+struct IndexedMesh {
+    Vertex *vertices;
+    // Lowered by OptimizeMesh() when vertices are unused.
+    UINT vertexCount;
+    UINT *indices;
+    UINT indexCount;
+
+    // Filled in by OptimizeMesh().
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Simulates a FIFO cache of *cacheSize* vertices over *indices*.
+VertexCacheStats AnalyzeVertexCache(const UINT *indices, UINT indexCount, UINT vertexCount,
+                                    UINT cacheSize = kVertexCacheAnalyzeSize);
+
+// Tom Forsyth's linear-speed vertex cache optimization: greedily emits
+// the triangle whose vertices score best, vertices scoring high while
+// recently used and while few triangles are left to use them.
+// *destination* may not be *indices*.
+void OptimizeVertexCache(UINT *destination, const UINT *indices, UINT indexCount, UINT vertexCount);
+
+// Splits cache-optimized *indices* into clusters, where cutting costs at
+// most *threshold* times the ACMR, and sorts them so clusters facing
+// away from the mesh center come first. *destination* may not be
+// *indices*.
+void OptimizeOverdraw(UINT *destination, const UINT *indices, UINT indexCount,
+                      const Vertex *vertices, UINT vertexCount, float threshold = 1.05f);
+
+// Copies *vertices* into *destination* in the order *indices* first use
+// them and rewrites *indices* to match. Unused vertices are dropped,
+// returns how many are left. *destination* may not be *vertices*.
+UINT OptimizeVertexFetch(Vertex *destination, UINT *indices, UINT indexCount,
+                         const Vertex *vertices, UINT vertexCount);
+
+// All of the above.
+void OptimizeMesh(IndexedMesh &mesh, float overdrawThreshold = 1.05f);
+
+// OptimizeMesh() on each of *meshes*, spread across *jobs* if given.
+void OptimizeMeshes(IndexedMesh *meshes, UINT count, JobSystem *jobs);
+
+} // namespace dx
+#endif // !DXLIB_MESHOPTIMIZER_H
\ No newline at end of file
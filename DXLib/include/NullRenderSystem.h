@@ -0,0 +1,95 @@
+#ifndef DXLIB_NULLRENDERSYSTEM_H
+#define DXLIB_NULLRENDERSYSTEM_H
+
+#include "RenderSystem.h"
+
+#include <vector>
+
+namespace dx {
+
+// What went through a NullRenderSystem in one frame, or in total.
+struct NullRenderStats {
+    UINT clears;
+    UINT draws;
+    UINT presents;
+    unsigned long long vertices;
+    unsigned long long indices;
+    // Time from the first call of a frame until Present(), what the
+    // caller spent producing the frame.
+    double submitSeconds;
+
+    NullRenderStats() { Reset(); }
+
+    void Reset() {
+        clears = draws = presents = 0;
+        vertices = indices = 0;
+        submitSeconds = 0.0;
+    }
+};
+
+namespace NullRenderCall {
+    enum E {
+        CLEAR = 0,
+        DRAW,
+        PRESENT,
+    };
+} // namespace NullRenderCall
+
+struct NullRenderRecord {
+    NullRenderCall::E call;
+    UINT vertexCount;
+    UINT indexCount;
+};
+
+// Accepts every call and does nothing with it, so frames can be timed
+// without any device cost and tests can check what a frame submitted.
+class NullRenderSystem : public RenderSystem {
+public:
+    NullRenderSystem();
+    virtual ~NullRenderSystem();
+
+    virtual RenderBackend::E GetBackend() const { return RenderBackend::NULL_DEVICE; }
+
+    virtual Error::E Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs);
+
+    virtual bool IsHeadless() const { return !_windowed; }
+
+    virtual void Clear(const Vector4f &color);
+    virtual void Draw(const DrawCommand &command);
+    virtual void Present();
+
+    inline UINT GetWidth() const { return _width; }
+    inline UINT GetHeight() const { return _height; }
+
+    // Stats of the frame last presented and of all frames so far.
+    inline const NullRenderStats& GetLastFrame() const { return _lastFrame; }
+    inline const NullRenderStats& GetTotals() const { return _totals; }
+    void ResetStats();
+
+    // Keeps a log of every call while on, off by default.
+    inline void SetRecording(bool value) { _recording = value; }
+    inline const std::vector<NullRenderRecord>& GetRecording() const { return _records; }
+    inline void ClearRecording() { _records.clear(); }
+
+private:
+    NO_COPY_ASSIGN(NullRenderSystem);
+
+    void BeginCall();
+    void Record(NullRenderCall::E call, UINT vertexCount, UINT indexCount);
+
+    UINT _width;
+    UINT _height;
+    bool _windowed;
+
+    NullRenderStats _frame;
+    NullRenderStats _lastFrame;
+    NullRenderStats _totals;
+    // Raw ticks of the first call this frame, 0 before it.
+    unsigned long long _frameStart;
+
+    bool _recording;
+    std::vector<NullRenderRecord> _records;
+};
+
+} // namespace dx
+#endif // !DXLIB_NULLRENDERSYSTEM_H
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef DXLIB_PIPELINESTATECACHE_H
+#define DXLIB_PIPELINESTATECACHE_H
+
+#include "Defs.h"
+#include "Err.h"
+
+#include <d3d11.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace dx {
+
+namespace PipelineStateKind {
+    enum E {
+        BLEND = 0,
+        RASTERIZER,
+        DEPTH_STENCIL,
+        SAMPLER,
+        COUNT
+    };
+} // namespace PipelineStateKind
+
+struct PipelineStateCacheStats {
+    unsigned long long lookups;
+    unsigned long long hits;
+    // States created on first use, each one a stall wherever it happened.
+    unsigned long long misses;
+    // States created ahead of time by Warm().
+    unsigned long long prebuilt;
+    unsigned long long failures;
+    // Spent creating states, misses and prebuilt ones alike.
+    double createSeconds;
+
+    PipelineStateCacheStats() { Reset(); }
+
+    void Reset() {
+        lookups = hits = misses = prebuilt = failures = 0;
+        createSeconds = 0.0;
+    }
+
+    inline double HitRate() const { return lookups ? static_cast<double>(hits) / lookups : 1.0; }
+};
+
+// States to create up front, typically everything a level or a pass
+// is known to use.
+struct PipelineStateSet {
+    std::vector<D3D11_BLEND_DESC> blend;
+    std::vector<D3D11_RASTERIZER_DESC> rasterizer;
+    std::vector<D3D11_DEPTH_STENCIL_DESC> depthStencil;
+    std::vector<D3D11_SAMPLER_DESC> sampler;
+};
+
+// Creates each distinct blend, rasterizer, depth-stencil and sampler
+// state once and hands out the same object for equal descriptions.
+// States are keyed by a hash of the whole description, fields the
+// driver ignores cleared first. Looking up a state that exists takes
+// no lock and is safe from any thread, only creating one locks. The
+// cache owns the states, they live until Release().
+class PipelineStateCache {
+public:
+    // D3D11 allows this many unique states of each kind per device.
+    static const UINT kMaxStatesPerKind = 4096;
+
+    PipelineStateCache();
+    ~PipelineStateCache();
+
+    // Creates states on *device*, which has to outlive the cache's states.
+    void Initialize(ID3D11Device *device);
+    // Releases all states, they may not be used afterwards.
+    void Release();
+
+    // The state for *desc*, created on first use. Null if the device
+    // refused it or kMaxStatesPerKind was reached.
+    ID3D11BlendState* GetBlendState(const D3D11_BLEND_DESC &desc);
+    ID3D11RasterizerState* GetRasterizerState(const D3D11_RASTERIZER_DESC &desc);
+    ID3D11DepthStencilState* GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC &desc);
+    ID3D11SamplerState* GetSamplerState(const D3D11_SAMPLER_DESC &desc);
+
+    // Creates every state in *set* that doesn't exist yet, meant for
+    // load time so frames only ever hit.
+    Error::E Warm(const PipelineStateSet &set);
+
+    UINT GetStateCount(PipelineStateKind::E kind) const;
+    PipelineStateCacheStats GetStats() const;
+    void ResetStats();
+
+private:
+    NO_COPY_ASSIGN(PipelineStateCache);
+
+    // Open addressing with linear probing, twice as many slots as the
+    // states it may hold. A slot is published by storing its hash last,
+    // readers that see the hash see the rest.
+    struct Slot {
+        std::atomic<unsigned long long> hash;
+        const void *desc;
+        ID3D11DeviceChild *state;
+    };
+
+    struct Table {
+        Slot *slots;
+        UINT descSize;
+        std::atomic<UINT> count;
+    };
+
+    ID3D11DeviceChild* Get(PipelineStateKind::E kind, const void *desc, bool prebuild);
+    ID3D11DeviceChild* Find(const Table &table, const void *desc, unsigned long long hash) const;
+    ID3D11DeviceChild* Create(PipelineStateKind::E kind, const void *desc);
+
+    ID3D11Device *_device;
+    Table _tables[PipelineStateKind::COUNT];
+    mutable std::mutex _createMutex;
+
+    std::atomic<unsigned long long> _lookups;
+    std::atomic<unsigned long long> _hits;
+    // Only changed with _createMutex held.
+    PipelineStateCacheStats _createStats;
+};
+
+} // namespace dx
+#endif // !DXLIB_PIPELINESTATECACHE_H
\ No newline at end of file
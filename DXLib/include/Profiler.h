@@ -0,0 +1,114 @@
+#ifndef DXLIB_PROFILER_H
+#define DXLIB_PROFILER_H
+
+#include "Defs.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Define DXLIB_PROFILER as 0 to compile every zone out of the build.
+// When compiled in, zones cost a single relaxed load while the
+// profiler is disabled at runtime.
+#ifndef DXLIB_PROFILER
+#define DXLIB_PROFILER 1
+#endif
+
+namespace dx {
+
+// A completed zone as stored in a thread's ring buffer.
+// Timestamps are raw Timer ticks.
+struct ProfileEvent {
+    const char *name;
+    unsigned long long begin;
+    unsigned long long end;
+    unsigned int depth;
+};
+
+// One node in the aggregated zone tree of a frame. Zones with the same
+// name under the same parent are merged into a single node.
+struct ProfileNode {
+    const char *name;
+    // Index of the parent node, -1 for root zones.
+    int parent;
+    unsigned int depth;
+    unsigned int calls;
+    double totalSeconds;
+};
+
+// Hierarchical CPU profiler. Every thread records its zones into its
+// own lock-free ring buffer, the buffers are only read when a frame is
+// aggregated or a trace is written.
+class Profiler {
+public:
+    // Number of events each thread keeps around for trace export.
+    static const unsigned int kRingSize = 16384;
+    // Zones nested deeper than this are ignored.
+    static const unsigned int kMaxDepth = 64;
+
+    static void SetEnabled(bool value);
+    static inline bool IsEnabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    // Name shown for the calling thread in exported traces.
+    static void SetThreadName(const char *name);
+
+    // Marks the frame boundaries on the calling thread, EndFrame()
+    // aggregates all zones recorded in between into a tree.
+    static void BeginFrame();
+    static void EndFrame();
+
+    // Zone tree of the last completed frame, in depth-first order.
+    static const std::vector<ProfileNode>& GetLastFrame();
+
+    // Writes the contents of every thread's ring buffer as a
+    // Chrome/Perfetto trace (chrome://tracing, ui.perfetto.dev).
+    static bool WriteChromeTrace(const std::string &path);
+
+    // Used by ProfileScope, zones must be strictly nested per thread.
+    // Names must outlive the profiler, string literals are expected.
+    static void BeginZone(const char *name);
+    static void EndZone();
+
+    // Innermost open zone on the calling thread, null if there is none.
+    // Never allocates, the allocation tracker tags with it.
+    static const char* GetCurrentZone();
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+// Records a zone for the lifetime of the object.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *name) : _active(Profiler::IsEnabled()) {
+        if (_active) Profiler::BeginZone(name);
+    }
+
+    ~ProfileScope() {
+        if (_active) Profiler::EndZone();
+    }
+
+private:
+    NO_COPY_ASSIGN(ProfileScope);
+
+    // Captured on entry so toggling the profiler mid-zone stays balanced.
+    bool _active;
+};
+
+} // namespace dx
+
+#define DX_PROFILE_CONCAT_IMPL(A, B) A##B
+#define DX_PROFILE_CONCAT(A, B) DX_PROFILE_CONCAT_IMPL(A, B)
+
+#if DXLIB_PROFILER
+#define DX_PROFILE_SCOPE(NAME) \
+    dx::ProfileScope DX_PROFILE_CONCAT(_dxProfileScope, __LINE__)(NAME)
+#define DX_PROFILE_FUNCTION() DX_PROFILE_SCOPE(__FUNCTION__)
+#else
+#define DX_PROFILE_SCOPE(NAME) ((void)0)
+#define DX_PROFILE_FUNCTION() ((void)0)
+#endif
+
+#endif // !DXLIB_PROFILER_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef DXLIB_RADIXSORT_H
+#define DXLIB_RADIXSORT_H
+
+#include "Defs.h"
+
+#include <vector>
+
+typedef unsigned int UINT;
+
+namespace dx {
+
+class JobSystem;
+
+// A key and the index of whatever it belongs to.
+struct SortEntry {
+    unsigned long long key;
+    UINT index;
+};
+
+// Least significant digit radix sort over 64-bit keys, 8 bits per pass.
+// Stable, equal keys keep their order. Passes over bytes all keys share
+// are skipped, so short keys in the high bits cost no more than their
+// width. Blocks of entries are counted and scattered in parallel on the
+// job system if given. Keeps its scratch memory between sorts.
+class RadixSorter {
+public:
+    // Below this many entries the job system isn't worth it.
+    static const UINT kParallelThreshold = 4096;
+
+    RadixSorter() { }
+
+    void Reserve(UINT count);
+
+    void Sort(std::vector<SortEntry> &entries, JobSystem *jobs = nullptr);
+
+private:
+    NO_COPY_ASSIGN(RadixSorter);
+
+    void SortPass(std::vector<SortEntry> &entries, JobSystem *jobs, unsigned int shift,
+                  UINT blockCount, UINT blockSize);
+
+    std::vector<SortEntry> _scratch;
+    // 256 counts per block, turned into scatter offsets in place.
+    std::vector<UINT> _histograms;
+};
+
+} // namespace dx
+#endif // !DXLIB_RADIXSORT_H
\ No newline at end of file
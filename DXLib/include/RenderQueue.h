@@ -0,0 +1,138 @@
+#ifndef DXLIB_RENDERQUEUE_H
+#define DXLIB_RENDERQUEUE_H
+
+#include "Defs.h"
+#include "RadixSort.h"
+#include "RenderTypes.h"
+
+#include <vector>
+
+namespace dx {
+
+class JobSystem;
+class RenderSystem;
+
+// Packs the state a draw needs into 64 bits so sorting the keys groups
+// draws by state. Fields from most to least significant:
+//   layer 4 | pass 4 | depth 16 | material 24 | mesh 16
+struct RenderKey {
+    static const unsigned int kLayerBits = 4;
+    static const unsigned int kPassBits = 4;
+    static const unsigned int kDepthBits = 16;
+    static const unsigned int kMaterialBits = 24;
+    static const unsigned int kMeshBits = 16;
+
+    static const unsigned int kMeshShift = 0;
+    static const unsigned int kMaterialShift = kMeshShift + kMeshBits;
+    static const unsigned int kDepthShift = kMaterialShift + kMaterialBits;
+    static const unsigned int kPassShift = kDepthShift + kDepthBits;
+    static const unsigned int kLayerShift = kPassShift + kPassBits;
+
+    // Fields wider than their bits are truncated.
+    static inline unsigned long long Make(UINT layer, UINT pass, UINT depth, UINT material, UINT mesh) {
+        return Field(layer, kLayerBits, kLayerShift) | Field(pass, kPassBits, kPassShift) |
+               Field(depth, kDepthBits, kDepthShift) | Field(material, kMaterialBits, kMaterialShift) |
+               Field(mesh, kMeshBits, kMeshShift);
+    }
+
+    static inline UINT GetLayer(unsigned long long key) { return Extract(key, kLayerBits, kLayerShift); }
+    static inline UINT GetPass(unsigned long long key) { return Extract(key, kPassBits, kPassShift); }
+    static inline UINT GetDepth(unsigned long long key) { return Extract(key, kDepthBits, kDepthShift); }
+    static inline UINT GetMaterial(unsigned long long key) { return Extract(key, kMaterialBits, kMaterialShift); }
+    static inline UINT GetMesh(unsigned long long key) { return Extract(key, kMeshBits, kMeshShift); }
+
+    // Maps a depth in [0, 1] to the depth field, near first unless
+    // *backToFront* is set, for blended passes.
+    static inline UINT QuantizeDepth(float depth, bool backToFront = false) {
+        const UINT max = (1u << kDepthBits) - 1;
+        UINT value = static_cast<UINT>(math::Clamp(depth, 0.0f, 1.0f) * max + 0.5f);
+        return backToFront ? max - value : value;
+    }
+
+private:
+    static inline unsigned long long Field(UINT value, unsigned int bits, unsigned int shift) {
+        return static_cast<unsigned long long>(value & ((1ull << bits) - 1)) << shift;
+    }
+
+    static inline UINT Extract(unsigned long long key, unsigned int bits, unsigned int shift) {
+        return static_cast<UINT>((key >> shift) & ((1ull << bits) - 1));
+    }
+};
+
+// Receives the state changes of RenderQueue::Submit(). Each function is
+// only called when its part of the key differs from the previous draw,
+// a new layer or pass rebinds material and mesh as well.
+class RenderQueueBinder {
+public:
+    virtual ~RenderQueueBinder() { }
+
+    virtual void BindPass(RenderSystem &r, UINT layer, UINT pass) { }
+    virtual void BindMaterial(RenderSystem &r, UINT material) { }
+    virtual void BindMesh(RenderSystem &r, UINT mesh) { }
+};
+
+struct RenderQueueStats {
+    UINT items;
+    UINT passChanges;
+    UINT materialChanges;
+    UINT meshChanges;
+    double sortSeconds;
+    double submitSeconds;
+
+    RenderQueueStats() { Reset(); }
+
+    void Reset() {
+        items = passChanges = materialChanges = meshChanges = 0;
+        sortSeconds = submitSeconds = 0.0;
+    }
+};
+
+// Collects a frame's draws with their keys, sorts them once and then
+// submits them in key order. Equal keys keep the order they were pushed
+// in. Draw commands are copied, the data they point to has to stay
+// valid until Submit().
+class RenderQueue {
+public:
+    RenderQueue();
+    ~RenderQueue();
+
+    void Reserve(UINT items);
+    void Clear();
+
+    void Push(unsigned long long key, const DrawCommand &command);
+
+    inline UINT GetCount() const { return static_cast<UINT>(_items.size()); }
+
+    // Radix sorts the keys, see RadixSorter. Large queues are sorted in
+    // parallel on *jobs* if given.
+    void Sort(JobSystem *jobs = nullptr);
+
+    // Draws every item in sorted order, Sort() first. State changes go
+    // to *binder* if given.
+    void Submit(RenderSystem &r, RenderQueueBinder *binder = nullptr);
+
+    // Key of the *i*th item in sorted order, after Sort().
+    inline unsigned long long GetSortedKey(UINT i) const { return _sorted[i].key; }
+
+    // Covers the last Sort() and Submit().
+    inline const RenderQueueStats& GetStats() const { return _stats; }
+
+private:
+    NO_COPY_ASSIGN(RenderQueue);
+
+    struct RenderItem {
+        unsigned long long key;
+        DrawCommand command;
+    };
+
+    std::vector<RenderItem> _items;
+    // What gets sorted, items themselves stay where they are.
+    std::vector<SortEntry> _sorted;
+    RadixSorter _sorter;
+    bool _isSorted;
+
+    RenderQueueStats _stats;
+};
+
+} // namespace dx
+#endif // !DXLIB_RENDERQUEUE_H
\ No newline at end of file
@@ -2,43 +2,98 @@
 #define DXLIB_RENDERER_H
 
 #include "Defs.h"
-#include "Window.h"
+#include "Err.h"
 #include "SimpleMath.h"
+#include "RenderTypes.h"
+#include "UploadRing.h"
 
-#include <d3d11.h>
+namespace dx {
 
+class CommandList;
+class JobSystem;
+class Window;
 
-namespace dx {
+namespace RenderBackend {
+    enum E {
+        // Direct3D 11 on the GPU, or on WARP when headless.
+        D3D11 = 0,
+        // The tiled CPU rasterizer, see SoftwareRenderer.
+        SOFTWARE,
+        // Does no work, counts calls and measures submission cost.
+        NULL_DEVICE,
+    };
+} // namespace RenderBackend
 
+namespace UploadKind {
+    enum E {
+        CONSTANT = 0,
+        VERTEX,
+        INDEX,
+        COUNT
+    };
+} // namespace UploadKind
+
+// Device interface the application renders through. Backends are
+// created with Create() and set up by Initialize().
 class RenderSystem {
 public:
-    RenderSystem();
-    ~RenderSystem();
+    // Returns a new, uninitialized backend, owned by the caller.
+    static RenderSystem* Create(RenderBackend::E backend);
 
-    Error::E Initialize(const Window &window);
+    virtual ~RenderSystem() { }
 
-    void Clear(const Vector4f &color);
-    void Present();
+    virtual RenderBackend::E GetBackend() const = 0;
 
-private:
-    NO_COPY_ASSIGN(RenderSystem);
+    // Renders into *window*, sized to its client area. Without a window
+    // the backend renders offscreen at *width* x *height*. Backends that
+    // can spread work across threads use *jobs*, which may be null.
+    virtual Error::E Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs) = 0;
+
+    // True when initialized without a window.
+    virtual bool IsHeadless() const = 0;
+
+    virtual void Clear(const Vector4f &color) = 0;
+    virtual void Draw(const DrawCommand &command) = 0;
+    virtual void Present() = 0;
+
+    // Returns a new command list for this backend, owned by the caller,
+    // or null if the device couldn't create one. The default records
+    // commands for Execute() to replay.
+    virtual CommandList* CreateCommandList();
 
-    void FreeResources();
-    Error::E CreateDeviceAndContext();
-    Error::E CreateSwapChain(const Window &window);
-    Error::E CreateDepthStencilBuffer();
-    bool _initOk;
+    // Executes finished command lists on the calling thread, one after
+    // the other in the order given.
+    virtual void Execute(CommandList *const *lists, UINT count);
 
-    DXGI_SWAP_CHAIN_DESC _swapDesc;
-    D3D_FEATURE_LEVEL _featureLevel;
-    UINT _msaaQualityLevel;
+    // Waits for vertical blank when presenting, off by default. Only
+    // the D3D11 backend has one to wait for.
+    inline void SetVSync(bool value) { _syncInterval = value ? 1 : 0; }
+    inline bool IsVSync() const { return _syncInterval != 0; }
 
-    ID3D11Device *_device;
-    ID3D11DeviceContext *_context;
-    IDXGISwapChain *_swapChain;
+    // Usage of the ring *kind* of per-draw data is streamed through, null
+    // where the backend reads draw data in place.
+    virtual const UploadRingStats* GetUploadStats(UploadKind::E kind) const { return nullptr; }
+
+    // Draw calls issued in the frame last presented.
+    inline UINT GetDrawCallCount() const { return _lastDrawCalls; }
+
+protected:
+    RenderSystem() : _syncInterval(0), _drawCalls(0), _lastDrawCalls(0) { }
+
+    // Backends call these from Draw() and Present().
+    inline void CountDrawCall(UINT count = 1) { _drawCalls += count; }
+    inline void EndFrameCounters() {
+        _lastDrawCalls = _drawCalls;
+        _drawCalls = 0;
+    }
+
+    UINT _syncInterval;
+
+private:
+    NO_COPY_ASSIGN(RenderSystem);
 
-    ID3D11RenderTargetView *_renderTargetView;
-    ID3D11DepthStencilView *_depthStencilView;
+    UINT _drawCalls;
+    UINT _lastDrawCalls;
 };
 
 } // namespace dx
@@ -0,0 +1,40 @@
+#ifndef DXLIB_RENDERTYPES_H
+#define DXLIB_RENDERTYPES_H
+
+#include "SimpleMath.h"
+
+typedef unsigned int UINT;
+
+namespace dx {
+
+// Packs a color with components in [0, 1] as R8G8B8A8, red in the
+// lowest byte.
+inline UINT PackColor(const Vector4f &color) {
+    UINT r = static_cast<UINT>(math::Clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    UINT g = static_cast<UINT>(math::Clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+    UINT b = static_cast<UINT>(math::Clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+    UINT a = static_cast<UINT>(math::Clamp(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+struct Vertex {
+    Vector3f position;
+    // See PackColor().
+    UINT color;
+};
+
+// A triangle list. Positions are transformed by *transform* into clip
+// space, z in [0, 1] like Direct3D. Both windings are drawn.
+struct DrawCommand {
+    const Vertex *vertices;
+    UINT vertexCount;
+    // Optional, three per triangle.
+    const UINT *indices;
+    UINT indexCount;
+    Mat4x4 transform;
+
+    DrawCommand() : vertices(nullptr), vertexCount(0), indices(nullptr), indexCount(0) { }
+};
+
+} // namespace dx
+#endif // !DXLIB_RENDERTYPES_H
\ No newline at end of file
@@ -0,0 +1,181 @@
+#ifndef DXLIB_SLOTMAP_H
+#define DXLIB_SLOTMAP_H
+
+#include "Defs.h"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace dx {
+
+// 32-bit reference into a SlotMap. The low bits index a slot, the high
+// bits hold the slot's generation at insertion, so handles to erased
+// objects stop resolving even after the slot has been reused.
+struct SlotHandle {
+    static const unsigned int kIndexBits = 20;
+    static const unsigned int kIndexMask = (1u << kIndexBits) - 1;
+    static const unsigned int kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+
+    unsigned int value;
+
+    inline unsigned int GetIndex() const { return value & kIndexMask; }
+    inline unsigned int GetGeneration() const { return value >> kIndexBits; }
+
+    // Generations start at 1, the zero handle never resolves.
+    inline bool IsNull() const { return value == 0; }
+
+    inline bool operator==(const SlotHandle &other) const { return value == other.value; }
+    inline bool operator!=(const SlotHandle &other) const { return value != other.value; }
+
+    static inline SlotHandle Make(unsigned int index, unsigned int generation) {
+        SlotHandle handle = { (generation << kIndexBits) | index };
+        return handle;
+    }
+
+    static inline SlotHandle Null() {
+        SlotHandle handle = { 0 };
+        return handle;
+    }
+};
+
+// Objects addressed by SlotHandle. Insert, Erase and Get are O(1).
+// Live objects are kept packed in one array, erasing moves the last
+// one into the gap, so iterating over begin() to end() touches only
+// live objects in contiguous memory. Pointers into the map are
+// invalidated by Insert and Erase, handles are not.
+template<typename T>
+class SlotMap {
+public:
+    static const unsigned int kMaxSize = SlotHandle::kIndexMask;
+
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    SlotMap() : _freeHead(kNoSlot) { }
+
+    void Reserve(unsigned int count) {
+        _dense.reserve(count);
+        _denseToSlot.reserve(count);
+        _slots.reserve(count);
+    }
+
+    SlotHandle Insert(const T &value) {
+        SlotHandle handle = AllocateSlot();
+        _dense.push_back(value);
+        return handle;
+    }
+
+    SlotHandle Insert(T &&value) {
+        SlotHandle handle = AllocateSlot();
+        _dense.push_back(std::move(value));
+        return handle;
+    }
+
+    // Returns false if the handle was already stale.
+    bool Erase(SlotHandle handle) {
+        if (!Contains(handle)) return false;
+
+        Slot &slot = _slots[handle.GetIndex()];
+        unsigned int dense = slot.dense;
+        unsigned int last = static_cast<unsigned int>(_dense.size()) - 1;
+
+        // Move the last object into the hole to keep the array packed.
+        if (dense != last) {
+            _dense[dense] = std::move(_dense[last]);
+            _denseToSlot[dense] = _denseToSlot[last];
+            _slots[_denseToSlot[dense]].dense = dense;
+        }
+        _dense.pop_back();
+        _denseToSlot.pop_back();
+
+        slot.generation = NextGeneration(slot.generation);
+        slot.dense = _freeHead;
+        _freeHead = handle.GetIndex();
+        return true;
+    }
+
+    inline bool Contains(SlotHandle handle) const {
+        unsigned int index = handle.GetIndex();
+        return index < _slots.size() && !handle.IsNull() &&
+               _slots[index].generation == handle.GetGeneration();
+    }
+
+    // Null if the handle is stale.
+    inline T* Get(SlotHandle handle) {
+        return Contains(handle) ? &_dense[_slots[handle.GetIndex()].dense] : nullptr;
+    }
+
+    inline const T* Get(SlotHandle handle) const {
+        return Contains(handle) ? &_dense[_slots[handle.GetIndex()].dense] : nullptr;
+    }
+
+    // Handle of the object at position *denseIndex* during iteration.
+    inline SlotHandle GetHandle(unsigned int denseIndex) const {
+        unsigned int index = _denseToSlot[denseIndex];
+        return SlotHandle::Make(index, _slots[index].generation);
+    }
+
+    void Clear() {
+        for (unsigned int i = 0; i < _denseToSlot.size(); ++i) {
+            Slot &slot = _slots[_denseToSlot[i]];
+            slot.generation = NextGeneration(slot.generation);
+            slot.dense = _freeHead;
+            _freeHead = _denseToSlot[i];
+        }
+        _dense.clear();
+        _denseToSlot.clear();
+    }
+
+    inline unsigned int GetSize() const { return static_cast<unsigned int>(_dense.size()); }
+    inline bool IsEmpty() const { return _dense.empty(); }
+
+    inline T* GetData() { return _dense.empty() ? nullptr : &_dense[0]; }
+    inline const T* GetData() const { return _dense.empty() ? nullptr : &_dense[0]; }
+
+    inline iterator begin() { return _dense.begin(); }
+    inline iterator end() { return _dense.end(); }
+    inline const_iterator begin() const { return _dense.begin(); }
+    inline const_iterator end() const { return _dense.end(); }
+
+private:
+    static const unsigned int kNoSlot = 0xFFFFFFFF;
+
+    struct Slot {
+        // Position in _dense while alive, next free slot otherwise.
+        unsigned int dense;
+        unsigned int generation;
+    };
+
+    // Skips 0 on wrap-around so the null handle stays invalid.
+    static inline unsigned int NextGeneration(unsigned int generation) {
+        generation = (generation + 1) & SlotHandle::kGenerationMask;
+        return generation == 0 ? 1 : generation;
+    }
+
+    SlotHandle AllocateSlot() {
+        unsigned int index;
+        if (_freeHead != kNoSlot) {
+            index = _freeHead;
+            _freeHead = _slots[index].dense;
+        } else {
+            assert(_slots.size() < kMaxSize && "SlotMap is full");
+            index = static_cast<unsigned int>(_slots.size());
+            Slot slot = { 0, 1 };
+            _slots.push_back(slot);
+        }
+
+        Slot &slot = _slots[index];
+        slot.dense = static_cast<unsigned int>(_dense.size());
+        _denseToSlot.push_back(index);
+        return SlotHandle::Make(index, slot.generation);
+    }
+
+    std::vector<T> _dense;
+    std::vector<unsigned int> _denseToSlot;
+    std::vector<Slot> _slots;
+    unsigned int _freeHead;
+};
+
+} // namespace dx
+#endif // !DXLIB_SLOTMAP_H
\ No newline at end of file
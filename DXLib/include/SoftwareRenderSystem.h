@@ -0,0 +1,43 @@
+#ifndef DXLIB_SOFTWARERENDERSYSTEM_H
+#define DXLIB_SOFTWARERENDERSYSTEM_H
+
+#include "RenderSystem.h"
+#include "SoftwareRenderer.h"
+
+#include <Windows.h>
+
+namespace dx {
+
+// Rasterizes on the CPU with SoftwareRenderer, tiles spread over the
+// job system if one is given. With a window Present() copies each frame
+// into it, headless it doesn't touch D3D or the GPU at all.
+class SoftwareRenderSystem : public RenderSystem {
+public:
+    SoftwareRenderSystem();
+    virtual ~SoftwareRenderSystem();
+
+    virtual RenderBackend::E GetBackend() const { return RenderBackend::SOFTWARE; }
+
+    virtual Error::E Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs);
+
+    virtual bool IsHeadless() const { return _renderer.IsInitialized() && !_presentWindow; }
+
+    virtual void Clear(const Vector4f &color);
+    virtual void Draw(const DrawCommand &command);
+    virtual void Present();
+
+    // The framebuffer, to hash or dump frames.
+    inline const SoftwareRenderer& GetSoftwareRenderer() const { return _renderer; }
+
+private:
+    NO_COPY_ASSIGN(SoftwareRenderSystem);
+
+    void CopyToWindow();
+
+    SoftwareRenderer _renderer;
+    // Frames are copied into this window, may be null.
+    HWND _presentWindow;
+};
+
+} // namespace dx
+#endif // !DXLIB_SOFTWARERENDERSYSTEM_H
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef DXLIB_SOFTWARERENDERER_H
+#define DXLIB_SOFTWARERENDERER_H
+
+#include "Defs.h"
+#include "Err.h"
+#include "RenderTypes.h"
+
+#include <string>
+#include <vector>
+
+namespace dx {
+
+class JobSystem;
+
+// Rasterizes triangles on the CPU into an in-memory framebuffer. Draw()
+// transforms and bins triangles into screen tiles, Flush() rasterizes
+// the tiles in parallel on the job system, four pixels at a time with
+// SSE half-space tests and a depth test. Colors are interpolated
+// without perspective correction.
+class SoftwareRenderer {
+public:
+    // Tiles are square, a multiple of 4 pixels.
+    static const UINT kTileSize = 64;
+
+    SoftwareRenderer();
+    ~SoftwareRenderer();
+
+    // Tiles are spread over *jobs* if given, otherwise Flush() runs on
+    // the calling thread.
+    Error::E Initialize(UINT width, UINT height, JobSystem *jobs = nullptr);
+    void Shutdown();
+
+    inline bool IsInitialized() const { return _color != nullptr; }
+
+    // Clears color and depth, flushing what was drawn before.
+    void Clear(const Vector4f &color);
+    void Draw(const DrawCommand &command);
+
+    // Rasterizes everything drawn since the last Flush().
+    void Flush();
+
+    inline UINT GetWidth() const { return _width; }
+    inline UINT GetHeight() const { return _height; }
+    // Pixels per row, at least the width.
+    inline UINT GetPitch() const { return _pitch; }
+
+    // B8G8R8A8 pixels, blue in the lowest byte, the layout of a 32 bit
+    // DIB. Only valid after Flush().
+    inline const UINT* GetColorBuffer() const { return _color; }
+
+    // FNV-1a over the visible pixels, to compare frames between runs.
+    unsigned long long HashColorBuffer() const;
+
+    // Writes the color buffer as a binary PPM image.
+    bool WriteImage(const std::string &path) const;
+
+    // Triangles binned since the last Flush(), after culling.
+    inline UINT GetPendingTriangleCount() const { return static_cast<UINT>(_triangles.size()); }
+
+private:
+    NO_COPY_ASSIGN(SoftwareRenderer);
+
+    // A triangle ready for rasterization. All functions are of the form
+    // f(x, y) = a * x + b * y + c over pixel centers.
+    struct Triangle {
+        // Edge functions, positive inside.
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        // Pixels exactly on an edge belong to top and left edges only.
+        bool topLeft[3];
+        // Depth, then blue, green, red and alpha in [0, 255].
+        float planeA[5];
+        float planeB[5];
+        float planeC[5];
+        // Inclusive pixel bounds, clipped to the target.
+        int minX, minY, maxX, maxY;
+    };
+
+    void SetupTriangle(const Vector4f *clip, const UINT *colors);
+    void BinTriangle(UINT index);
+    void RasterizeTile(UINT tile);
+
+    UINT _width;
+    UINT _height;
+    UINT _pitch;
+    UINT _tilesX;
+    UINT _tilesY;
+    UINT *_color;
+    float *_depth;
+    JobSystem *_jobs;
+
+    // Applied to every tile at the start of the next Flush().
+    bool _clearPending;
+    UINT _clearColor;
+
+    std::vector<Triangle> _triangles;
+    // Triangle indices per tile, in submission order.
+    std::vector<std::vector<UINT> > _bins;
+    // Clip space positions of the command being drawn.
+    std::vector<Vector4f> _clip;
+};
+
+} // namespace dx
+#endif // !DXLIB_SOFTWARERENDERER_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef DXLIB_SPRITEBATCH_H
+#define DXLIB_SPRITEBATCH_H
+
+#include "Defs.h"
+#include "RadixSort.h"
+#include "RenderTypes.h"
+
+#include <vector>
+
+namespace dx {
+
+class JobSystem;
+class RenderQueueBinder;
+class RenderSystem;
+
+struct Sprite {
+    // Destination in pixels, origin at the top left of the target.
+    RectangleF dest;
+    // See PackColor().
+    UINT color;
+    // Radians, clockwise on screen about the center of *dest*.
+    float rotation;
+    // In [0, 1], smaller is nearer. Overlapping sprites are resolved
+    // by the depth test like any other draw, not by layer.
+    float depth;
+    // Sprites sharing a texture within a layer are drawn together.
+    UINT texture;
+    // Drawn in increasing order, below kMaxLayers.
+    UINT layer;
+
+    Sprite() : color(0xFFFFFFFF), rotation(0.0f), depth(0.5f), texture(0), layer(0) { }
+};
+
+struct SpriteBatchStats {
+    UINT sprites;
+    UINT draws;
+    UINT textureChanges;
+    double sortSeconds;
+    double expandSeconds;
+    double submitSeconds;
+
+    SpriteBatchStats() { Reset(); }
+
+    void Reset() {
+        sprites = draws = textureChanges = 0;
+        sortSeconds = expandSeconds = submitSeconds = 0.0;
+    }
+};
+
+// Collects sprites between Begin() and End(), then sorts them by layer
+// and texture and draws each run as a single indexed quad list. Quads
+// are expanded four corners at a time with SSE, spread across the job
+// system when one is given. Sprites with equal layer and texture keep
+// the order they were drawn in.
+class SpriteBatch {
+public:
+    // Bounded by the vertices a DrawCommand may have.
+    static const UINT kMaxSpritesPerDraw = 16384;
+    static const UINT kMaxLayers = 256;
+    static const UINT kMaxTextures = 1 << 24;
+
+    SpriteBatch();
+    ~SpriteBatch();
+
+    void Reserve(UINT sprites);
+
+    // Starts a batch for a target of *width* x *height* pixels.
+    void Begin(UINT width, UINT height);
+
+    void Draw(const Sprite &sprite);
+    void Draw(const RectangleF &dest, UINT color, UINT texture = 0, UINT layer = 0);
+
+    // Draws the batch on *r*. Texture and layer changes go to *binder*
+    // as materials and passes, if given.
+    void End(RenderSystem &r, JobSystem *jobs = nullptr, RenderQueueBinder *binder = nullptr);
+
+    inline bool IsDrawing() const { return _drawing; }
+    inline UINT GetCount() const { return static_cast<UINT>(_sprites.size()); }
+
+    // Covers the last End().
+    inline const SpriteBatchStats& GetStats() const { return _stats; }
+
+private:
+    NO_COPY_ASSIGN(SpriteBatch);
+
+    void Expand(UINT first, UINT last);
+    void Submit(RenderSystem &r, RenderQueueBinder *binder);
+
+    std::vector<Sprite> _sprites;
+    std::vector<SortEntry> _order;
+    RadixSorter _sorter;
+    // Four per sprite in sorted order.
+    std::vector<Vertex> _vertices;
+    // Two triangles per quad, the same for every draw.
+    std::vector<UINT> _indices;
+
+    // Pixels to clip space.
+    float _scaleX;
+    float _scaleY;
+    bool _drawing;
+
+    SpriteBatchStats _stats;
+};
+
+} // namespace dx
+#endif // !DXLIB_SPRITEBATCH_H
\ No newline at end of file
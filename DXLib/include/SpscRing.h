@@ -0,0 +1,67 @@
+#ifndef DXLIB_SPSCRING_H
+#define DXLIB_SPSCRING_H
+
+#include <atomic>
+
+namespace dx {
+
+// Bounded lock-free queue for exactly one producer and one consumer
+// thread. T must be trivially copyable, Capacity a power of two.
+template<typename T, unsigned int Capacity>
+class SpscRing {
+public:
+    SpscRing() : _head(0), _tail(0) { }
+
+    // Producer only. Returns false when the ring is full.
+    bool TryPush(const T &item) {
+        unsigned int tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) >= Capacity) return false;
+
+        _items[tail & kMask] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool TryPop(T &item) {
+        unsigned int head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+
+        item = _items[head & kMask];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only, pops up to *maxCount* items with a single
+    // synchronization. Returns the number popped.
+    unsigned int PopBatch(T *out, unsigned int maxCount) {
+        unsigned int head = _head.load(std::memory_order_relaxed);
+        unsigned int available = _tail.load(std::memory_order_acquire) - head;
+        unsigned int count = available < maxCount ? available : maxCount;
+
+        for (unsigned int i = 0; i < count; ++i) {
+            out[i] = _items[(head + i) & kMask];
+        }
+        _head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Only a hint while the other side is active.
+    inline unsigned int GetSize() const {
+        return _tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const unsigned int kMask = Capacity - 1;
+
+    // Producer and consumer each own one index, keep them on separate
+    // cache lines.
+    std::atomic<unsigned int> _head;
+    char _pad0[64];
+    std::atomic<unsigned int> _tail;
+    char _pad1[64];
+    T _items[Capacity];
+};
+
+} // namespace dx
+#endif // !DXLIB_SPSCRING_H
\ No newline at end of file
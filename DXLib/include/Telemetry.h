@@ -0,0 +1,126 @@
+#ifndef DXLIB_TELEMETRY_H
+#define DXLIB_TELEMETRY_H
+
+#include "Defs.h"
+#include "Err.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+
+namespace dx {
+
+namespace TelemetryKind {
+    enum E {
+        // Running total, readers derive rates from it.
+        COUNTER = 0,
+        // Last value set.
+        GAUGE,
+    };
+} // namespace TelemetryKind
+
+// Layout of the published file, shared with readers such as the
+// TelemetryViewer tool. Append fields only, bump kVersion otherwise.
+struct TelemetryFileHeader {
+    static const unsigned int kMagic = 0x544C4D44; // "DMLT"
+    static const unsigned int kVersion = 1;
+
+    unsigned int magic;
+    unsigned int version;
+    // Entries following the header.
+    unsigned int capacity;
+    unsigned int count;
+    // Odd while a snapshot is being written. Readers copy the entries
+    // and retry if it was odd or changed meanwhile.
+    volatile long sequence;
+    unsigned int intervalMs;
+    unsigned long long publishCount;
+    // Seconds since publishing started, taken with the snapshot.
+    double uptime;
+    char pad[24];
+};
+
+struct TelemetryFileEntry {
+    static const unsigned int kNameLength = 48;
+
+    char name[kNameLength];
+    unsigned int kind;
+    unsigned int pad;
+    double value;
+};
+
+class Telemetry;
+
+// Handle to a registered counter, cheap to copy. Updates are a single
+// relaxed atomic add.
+class TelemetryCounter {
+public:
+    TelemetryCounter();
+
+    inline void Add(long long value) { _value->fetch_add(value, std::memory_order_relaxed); }
+    inline void Increment() { Add(1); }
+
+private:
+    friend class Telemetry;
+    explicit TelemetryCounter(std::atomic<long long> *value) : _value(value) { }
+
+    std::atomic<long long> *_value;
+};
+
+// Handle to a registered gauge, cheap to copy. Updates are a single
+// relaxed atomic store.
+class TelemetryGauge {
+public:
+    TelemetryGauge();
+
+    inline void Set(double value) {
+        long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+        _value->store(bits, std::memory_order_relaxed);
+    }
+
+private:
+    friend class Telemetry;
+    explicit TelemetryGauge(std::atomic<long long> *value) : _value(value) { }
+
+    std::atomic<long long> *_value;
+};
+
+// Process wide registry of named counters and gauges. A background
+// thread copies them into a memory-mapped file at a fixed interval, so
+// running instances can be watched without attaching a profiler.
+// Updating a metric never takes a lock and never waits for the
+// publisher, registering one does.
+class Telemetry {
+public:
+    static const unsigned int kMaxMetrics = 256;
+
+    // Registering an existing name returns the same metric. Names are
+    // truncated to TelemetryFileEntry::kNameLength - 1 characters. Once
+    // kMaxMetrics are registered, new names go to a shared dummy.
+    static TelemetryCounter Counter(const char *name);
+    static TelemetryGauge Gauge(const char *name);
+
+    // Starts publishing to *path* every *intervalMs* milliseconds. The
+    // file is overwritten and holds kMaxMetrics entries.
+    static Error::E StartPublishing(const std::string &path, unsigned int intervalMs = 100);
+    static void StopPublishing();
+    static bool IsPublishing();
+
+    static unsigned int GetMetricCount();
+
+private:
+    friend class TelemetryCounter;
+    friend class TelemetryGauge;
+
+    static std::atomic<long long>* Register(const char *name, TelemetryKind::E kind);
+
+    // Where handles point before registration and after overflow.
+    static std::atomic<long long> _discard;
+};
+
+inline TelemetryCounter::TelemetryCounter() : _value(&Telemetry::_discard) { }
+inline TelemetryGauge::TelemetryGauge() : _value(&Telemetry::_discard) { }
+
+} // namespace dx
+#endif // !DXLIB_TELEMETRY_H
\ No newline at end of file
@@ -27,6 +27,10 @@ public:
     // only call this once per game logic iteration.
     void Tick();
 
+    // Advances the timer by exactly *seconds* instead of measuring,
+    // used to drive simulations with a fixed timestep.
+    void Advance(double seconds);
+
     // Variations of get delta time.
     // Can be used for hourly intervals etc.
     inline double GetDeltaMillis() const { return TO_MILLIS(_deltaSeconds); }
@@ -40,6 +44,13 @@ public:
     inline double GetTotalMinutes() const { return TO_MINUTES(_totalSeconds); }
     inline double GetTotalHours() const { return TO_HOURS(_totalSeconds); }
 
+    // Raw performance counter value, cheap enough to stamp
+    // individual events with (see Profiler).
+    static unsigned long long GetRawTicks();
+
+    // Multiply raw ticks by this to convert into seconds.
+    static double GetSecondsPerTick();
+
 private:
     double _startTick;
     double _lastTick;
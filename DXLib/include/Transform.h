@@ -0,0 +1,50 @@
+#ifndef DXLIB_TRANSFORM_H
+#define DXLIB_TRANSFORM_H
+
+#include "ECS.h"
+#include "SimpleMath.h"
+
+namespace dx {
+
+// Transform components and the systems that maintain them.
+
+// Rotation holds Euler angles in radians, applied X, Y then Z.
+struct Transform {
+    Vector3f position;
+    Vector3f rotation;
+    Vector3f scale;
+
+    Transform() : scale(1.0f, 1.0f, 1.0f) { }
+};
+
+// Units and radians per second.
+struct Velocity {
+    Vector3f linear;
+    Vector3f angular;
+};
+
+// Row-vector world matrix built from Transform, ready for rendering.
+struct LocalToWorld {
+    Mat4x4 matrix;
+};
+
+// Integrates Velocity into Transform.
+class MovementSystem : public System {
+public:
+    MovementSystem();
+
+    void Update(World &world, CommandBuffer &commands,
+                JobSystem &jobs, const Timer &timer) override;
+};
+
+// Rebuilds LocalToWorld for every entity that has a Transform.
+class TransformSystem : public System {
+public:
+    TransformSystem();
+
+    void Update(World &world, CommandBuffer &commands,
+                JobSystem &jobs, const Timer &timer) override;
+};
+
+} // namespace dx
+#endif // !DXLIB_TRANSFORM_H
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef DXLIB_UPLOADRING_H
+#define DXLIB_UPLOADRING_H
+
+#include "Defs.h"
+
+typedef unsigned int UINT;
+
+namespace dx {
+
+struct UploadRingStats {
+    UINT capacity;
+    // Bytes and allocations of the frame last ended, alignment padding
+    // and the space skipped when wrapping included.
+    UINT frameBytes;
+    UINT frameAllocations;
+    // Most bytes in use at once, the ring should be a bit larger.
+    UINT peakBytes;
+    // Totals since Initialize().
+    unsigned long long wraps;
+    unsigned long long stalls;
+    double stallSeconds;
+
+    UploadRingStats() { Reset(); }
+
+    void Reset() {
+        capacity = frameBytes = frameAllocations = peakBytes = 0;
+        wraps = stalls = 0;
+        stallSeconds = 0.0;
+    }
+};
+
+// Sub-allocates a buffer of per-frame data front to back, wrapping
+// around at the end. Memory a frame allocated stays in use until the
+// frame is retired, once the device is done reading it, so nothing
+// is ever overwritten while in flight and the buffer never needs to be
+// discarded. Only tracks offsets, the buffer itself belongs to the
+// caller. Not thread-safe.
+class UploadRing {
+public:
+    static const UINT kMaxFramesInFlight = 8;
+    // Returned by Allocate() when in-flight frames hold the space.
+    static const UINT kNoSpace = 0xFFFFFFFF;
+
+    UploadRing();
+
+    void Initialize(UINT capacity);
+    // Forgets all allocations and frames, keeps the statistics.
+    void Reset();
+
+    // Offset of *size* bytes aligned to *alignment*, a power of two, or
+    // kNoSpace until enough frames have been retired.
+    UINT Allocate(UINT size, UINT alignment);
+    // True when Allocate() would succeed.
+    bool Fits(UINT size, UINT alignment) const;
+
+    // Closes the current frame, its memory stays in use until retired.
+    void EndFrame();
+    // Frees the memory of the oldest frame in flight.
+    void RetireFrame();
+
+    inline UINT GetCapacity() const { return _capacity; }
+    inline UINT GetFramesInFlight() const { return _frameCount; }
+    // Bytes held by frames in flight and the current one.
+    inline UINT GetUsedBytes() const { return _used; }
+
+    // Called by the owner after waiting on a frame for space.
+    void RecordStall(double seconds);
+
+    inline const UploadRingStats& GetStats() const { return _stats; }
+
+private:
+    NO_COPY_ASSIGN(UploadRing);
+
+    // Where Allocate() would place *size* bytes and how many bytes that
+    // takes, padding and skipped space included.
+    void Place(UINT size, UINT alignment, UINT &offset, UINT &consumed, bool &wrap) const;
+
+    UINT _capacity;
+    // Next free byte, the bytes in use end right before it.
+    UINT _head;
+    UINT _used;
+
+    // Bytes each frame in flight took, oldest first.
+    UINT _frameBytes[kMaxFramesInFlight];
+    UINT _firstFrame;
+    UINT _frameCount;
+    UINT _currentBytes;
+    UINT _currentAllocations;
+
+    UploadRingStats _stats;
+};
+
+} // namespace dx
+#endif // !DXLIB_UPLOADRING_H
\ No newline at end of file
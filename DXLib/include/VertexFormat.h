@@ -0,0 +1,208 @@
+#ifndef DXLIB_VERTEXFORMAT_H
+#define DXLIB_VERTEXFORMAT_H
+
+#include "Defs.h"
+#include "SimpleMath.h"
+
+#include <d3d11.h>
+
+#include <cstring>
+
+namespace dx {
+
+// Full precision vertex, what vertex layouts encode from and decode to.
+struct MeshVertex {
+    Vector3f position;
+    // Unit length.
+    Vector3f normal;
+    Vector2f texcoord;
+    // See PackColor().
+    UINT color;
+};
+
+// Scalar conversions between floats and IEEE half floats, rounding to
+// nearest even. Too large values become infinity.
+unsigned short FloatToHalf(float value);
+float HalfToFloat(unsigned short value);
+
+// Batch codecs behind the packed elements below, SSE2 four vertices at
+// a time. Packed vertices are *stride* bytes apart at *out* or *in*.
+
+// Half x, y, z and a w of 1.
+void EncodePositionsHalf4(const MeshVertex *in, UINT count, void *out, UINT stride);
+void DecodePositionsHalf4(const void *in, UINT stride, UINT count, MeshVertex *out);
+// Octahedral mapping onto two snorm16, within 0.05 degrees.
+// Shaders decode with z = 1 - |x| - |y|, then fold x and y back by
+// max(-z, 0) and normalize.
+void EncodeNormalsOct16(const MeshVertex *in, UINT count, void *out, UINT stride);
+void DecodeNormalsOct16(const void *in, UINT stride, UINT count, MeshVertex *out);
+// Two unorm16, coordinates outside [0, 1] are clamped.
+void EncodeTexcoordsUnorm16(const MeshVertex *in, UINT count, void *out, UINT stride);
+void DecodeTexcoordsUnorm16(const void *in, UINT stride, UINT count, MeshVertex *out);
+
+// Vertex elements for VertexLayout. Each names its input layout
+// semantic and format, its size, and how to convert arrays of
+// MeshVertex to and from it.
+
+struct PositionFloat3 {
+    static const UINT kSize = 12;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+    static const char* GetSemantic() { return "POSITION"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        for (UINT i = 0; i < count; ++i) memcpy(out + i * stride, &in[i].position, kSize);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        for (UINT i = 0; i < count; ++i) memcpy(&out[i].position, in + i * stride, kSize);
+    }
+};
+
+struct PositionHalf4 {
+    static const UINT kSize = 8;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+    static const char* GetSemantic() { return "POSITION"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        EncodePositionsHalf4(in, count, out, stride);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        DecodePositionsHalf4(in, stride, count, out);
+    }
+};
+
+struct NormalFloat3 {
+    static const UINT kSize = 12;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+    static const char* GetSemantic() { return "NORMAL"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        for (UINT i = 0; i < count; ++i) memcpy(out + i * stride, &in[i].normal, kSize);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        for (UINT i = 0; i < count; ++i) memcpy(&out[i].normal, in + i * stride, kSize);
+    }
+};
+
+struct NormalOct16 {
+    static const UINT kSize = 4;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R16G16_SNORM;
+    static const char* GetSemantic() { return "NORMAL"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        EncodeNormalsOct16(in, count, out, stride);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        DecodeNormalsOct16(in, stride, count, out);
+    }
+};
+
+struct TexcoordFloat2 {
+    static const UINT kSize = 8;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R32G32_FLOAT;
+    static const char* GetSemantic() { return "TEXCOORD"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        for (UINT i = 0; i < count; ++i) memcpy(out + i * stride, &in[i].texcoord, kSize);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        for (UINT i = 0; i < count; ++i) memcpy(&out[i].texcoord, in + i * stride, kSize);
+    }
+};
+
+struct TexcoordUnorm16 {
+    static const UINT kSize = 4;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R16G16_UNORM;
+    static const char* GetSemantic() { return "TEXCOORD"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        EncodeTexcoordsUnorm16(in, count, out, stride);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        DecodeTexcoordsUnorm16(in, stride, count, out);
+    }
+};
+
+struct ColorUnorm8 {
+    static const UINT kSize = 4;
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+    static const char* GetSemantic() { return "COLOR"; }
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        for (UINT i = 0; i < count; ++i) memcpy(out + i * stride, &in[i].color, kSize);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        for (UINT i = 0; i < count; ++i) memcpy(&out[i].color, in + i * stride, kSize);
+    }
+};
+
+// Elements at compile-time offsets from *Offset* on, see VertexLayout.
+template<UINT Offset, typename... Elements>
+struct VertexLayoutElements {
+    static const UINT kSize = 0;
+    static void Encode(const MeshVertex*, UINT, char*, UINT) { }
+    static void Decode(const char*, UINT, UINT, MeshVertex*) { }
+    static void Describe(D3D11_INPUT_ELEMENT_DESC*) { }
+};
+
+template<UINT Offset, typename First, typename... Rest>
+struct VertexLayoutElements<Offset, First, Rest...> {
+    typedef VertexLayoutElements<Offset + First::kSize, Rest...> Next;
+    static const UINT kSize = First::kSize + Next::kSize;
+
+    static void Encode(const MeshVertex *in, UINT count, char *out, UINT stride) {
+        First::Encode(in, count, out + Offset, stride);
+        Next::Encode(in, count, out, stride);
+    }
+    static void Decode(const char *in, UINT stride, UINT count, MeshVertex *out) {
+        First::Decode(in + Offset, stride, count, out);
+        Next::Decode(in, stride, count, out);
+    }
+    static void Describe(D3D11_INPUT_ELEMENT_DESC *out) {
+        out->SemanticName = First::GetSemantic();
+        out->SemanticIndex = 0;
+        out->Format = First::kFormat;
+        out->InputSlot = 0;
+        out->AlignedByteOffset = Offset;
+        out->InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+        out->InstanceDataStepRate = 0;
+        Next::Describe(out + 1);
+    }
+};
+
+// An interleaved vertex of *Elements* in the order given, its stride and
+// input layout worked out at compile time. Encoding and decoding go
+// element by element over whole arrays, so the packed ones run through
+// the batch codecs.
+template<typename... Elements>
+class VertexLayout {
+public:
+    typedef VertexLayoutElements<0, Elements...> Layout;
+
+    static const UINT kStride = Layout::kSize;
+    static const UINT kElementCount = sizeof...(Elements);
+
+    // Packs *count* vertices into kStride * count bytes at *out*.
+    static void Encode(const MeshVertex *in, UINT count, void *out) {
+        Layout::Encode(in, count, static_cast<char*>(out), kStride);
+    }
+
+    // Unpacks *count* vertices. Fields the layout has no element for
+    // are left as they were.
+    static void Decode(const void *in, UINT count, MeshVertex *out) {
+        Layout::Decode(static_cast<const char*>(in), kStride, count, out);
+    }
+
+    // Fills kElementCount descriptions for CreateInputLayout(), all from
+    // input slot 0.
+    static void GetInputLayout(D3D11_INPUT_ELEMENT_DESC *out) {
+        Layout::Describe(out);
+    }
+};
+
+// 36 bytes, everything as is.
+typedef VertexLayout<PositionFloat3, NormalFloat3, TexcoordFloat2, ColorUnorm8> FullVertexLayout;
+// 20 bytes: half positions, octahedral normals and unorm16 coordinates.
+typedef VertexLayout<PositionHalf4, NormalOct16, TexcoordUnorm16, ColorUnorm8> PackedVertexLayout;
+
+} // namespace dx
+#endif // !DXLIB_VERTEXFORMAT_H
\ No newline at end of file
@@ -3,10 +3,15 @@
 
 #include "Defs.h"
 #include "Err.h"
+#include "Event.h"
 
 #include <Windows.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace dx {
 
@@ -20,10 +25,18 @@ public:
     // handle any errors upon creation.
     Error::E Initialize();
 
+    // Creates the window and pumps its messages on a dedicated thread,
+    // so modal move/resize loops and slow handlers can't stall the
+    // frame. Call before Initialize(). HandleMessages() does nothing
+    // then, events arrive through the queue on their own.
+    void SetThreadedMessagePump(bool value);
+    inline bool IsThreadedMessagePump() const { return _threadedPump; }
+
     bool IsVisible() const;
     void SetVisible(bool value);
 
-    // Returns dimensions of CLIENT area.
+    // Returns dimensions of CLIENT area. Kept up to date by the message
+    // pump, safe to call from any thread.
     UINT GetWidth() const;
     UINT GetHeight() const;
 
@@ -35,19 +48,42 @@ public:
     void SetSize(UINT nWidth, UINT nHeight);
 
     std::string GetTitle() const;
+    // Can be called before Initialize(), without a window at all, or
+    // from any thread, it never waits for the window to update.
     void SetTitle(const std::string &str);
+    void SetTitle(const char *str);
 
-    // Polls all windows messages and handles them.
+    // Polls all windows messages, input and window events they produce
+    // are queued for PollEvents().
     void HandleMessages();
 
+    bool IsMinimized() const;
+
     // Set to true when the user attempts to close the window.
     bool IsCloseRequested() const;
 
     // Returns the handle to the native window.
     HWND GetHandle() const;
 
+    // Queues an event as if the platform had sent it, for headless runs,
+    // replays and tests. The queue has a single producer, so don't mix
+    // this with a message pump running on another thread.
+    bool PushEvent(const Event &event);
+
+    // Takes up to *maxCount* queued events, returns how many.
+    inline unsigned int PollEvents(Event *out, unsigned int maxCount) {
+        return _events.Drain(out, maxCount);
+    }
+
+    // Hands *event* to OnEvent() and the matching handler below.
+    void DispatchEvent(const Event &event);
+
+    // Events lost because the queue was full.
+    inline unsigned int GetDroppedEventCount() const { return _events.GetDroppedCount(); }
+
 protected:
-    // Events that get sent down to derived classes.
+    // Events that get sent down to derived classes by DispatchEvent().
+    virtual void OnEvent(const Event &event) { }
     virtual void OnClose() { };
     virtual void OnGainFocus() { }
     virtual void OnLostFocus() { }
@@ -67,14 +103,26 @@ private:
 
     LRESULT WindowProc(HWND, UINT, WPARAM, LPARAM);
     Error::E InitWindow();
+    void MessageThreadMain();
 
     // Window members
     HWND _hwnd;
     HINSTANCE _hInst;
     std::string _title;
-    UINT _width;
-    UINT _height;
-    bool _shouldClose; // TODO : Some way to reset this flag.
+    mutable std::mutex _titleMutex;
+    // Written by the message pump, read by the game thread.
+    std::atomic<UINT> _width;
+    std::atomic<UINT> _height;
+    std::atomic<bool> _minimized;
+    std::atomic<bool> _shouldClose; // TODO : Some way to reset this flag.
+    EventQueue _events;
+
+    bool _threadedPump;
+    std::thread _messageThread;
+    std::mutex _initMutex;
+    std::condition_variable _initSignal;
+    bool _initDone;
+    Error::E _initResult;
 };
 
 } // namespace dx
@@ -0,0 +1,357 @@
+#include <AllocTracker.h>
+#include <Profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace dx {
+
+// Built on first use, its vector must not allocate during static
+// initialization, before the counters below are set up.
+static AllocFrameStats& LastFrame() {
+    static AllocFrameStats frame;
+    return frame;
+}
+
+#if DXLIB_TRACK_ALLOCATIONS
+
+static const unsigned int kMaxTags = 64;
+// Blocks are prefixed with their size and whether they were counted.
+// Kept at 16 bytes so malloc's alignment carries over.
+static const size_t kHeaderSize = 16;
+// Slot 0, also takes whatever doesn't fit into the tag table.
+static const char *kUntagged = "(untagged)";
+
+struct AllocTagCounter {
+    const char *tag;
+    // Written by the owning thread only, read by EndFrame().
+    std::atomic<size_t> count;
+    std::atomic<size_t> bytes;
+    // Totals at BeginFrame(), only touched by the frame thread.
+    size_t startCount;
+    size_t startBytes;
+};
+
+// Counters of one thread. Never freed, so allocations of threads that
+// have exited still show up.
+struct AllocThreadStats {
+    std::atomic<size_t> count;
+    std::atomic<size_t> bytes;
+    std::atomic<size_t> freeCount;
+    size_t startCount;
+    size_t startBytes;
+    size_t startFreeCount;
+
+    AllocTagCounter tags[kMaxTags];
+    // Tags below this are fully written.
+    std::atomic<unsigned int> tagCount;
+
+    AllocThreadStats *next;
+};
+
+// Left to zero-initialization: without constexpr, initializing them
+// would run at static initialization time and could reset whatever
+// allocations of other globals had already counted.
+static std::atomic<AllocThreadStats*> threadList;
+static std::atomic<ptrdiff_t> liveBytes;
+static std::atomic<ptrdiff_t> framePeak;
+static std::atomic<size_t> violations;
+static std::atomic<AllocViolationHandler> violationHandler;
+
+static __declspec(thread) AllocThreadStats *threadStats = nullptr;
+static __declspec(thread) const char *threadTag = nullptr;
+static __declspec(thread) unsigned int lastTagIndex = 0;
+static __declspec(thread) const char *noAllocName = nullptr;
+static __declspec(thread) unsigned int noAllocDepth = 0;
+// Set while the tracker allocates for itself or a handler runs.
+static __declspec(thread) bool suspended = false;
+
+// Only writer of these is the owning thread, so a plain load and store
+// is enough and avoids a locked instruction.
+static inline void Bump(std::atomic<size_t> &counter, size_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static AllocThreadStats* GetThreadStats() {
+    if (threadStats) return threadStats;
+
+    // Can't go through operator new from in here.
+    void *memory = malloc(sizeof(AllocThreadStats));
+    if (!memory) return nullptr;
+    AllocThreadStats *stats = new (memory) AllocThreadStats;
+
+    stats->count.store(0, std::memory_order_relaxed);
+    stats->bytes.store(0, std::memory_order_relaxed);
+    stats->freeCount.store(0, std::memory_order_relaxed);
+    stats->startCount = stats->startBytes = stats->startFreeCount = 0;
+    for (unsigned int i = 0; i < kMaxTags; ++i) {
+        stats->tags[i].tag = nullptr;
+        stats->tags[i].count.store(0, std::memory_order_relaxed);
+        stats->tags[i].bytes.store(0, std::memory_order_relaxed);
+        stats->tags[i].startCount = stats->tags[i].startBytes = 0;
+    }
+    stats->tags[0].tag = kUntagged;
+    stats->tagCount.store(1, std::memory_order_relaxed);
+
+    AllocThreadStats *head = threadList.load(std::memory_order_relaxed);
+    do {
+        stats->next = head;
+    } while (!threadList.compare_exchange_weak(head, stats, std::memory_order_release,
+                                               std::memory_order_relaxed));
+    threadStats = stats;
+    return stats;
+}
+
+// Tags are compared by address here, EndFrame() merges equal names.
+static AllocTagCounter& FindTag(AllocThreadStats &stats, const char *tag) {
+    if (stats.tags[lastTagIndex].tag == tag) return stats.tags[lastTagIndex];
+
+    unsigned int count = stats.tagCount.load(std::memory_order_relaxed);
+    for (unsigned int i = 0; i < count; ++i) {
+        if (stats.tags[i].tag == tag) {
+            lastTagIndex = i;
+            return stats.tags[i];
+        }
+    }
+
+    if (count == kMaxTags) return stats.tags[0];
+
+    stats.tags[count].tag = tag;
+    stats.tagCount.store(count + 1, std::memory_order_release);
+    lastTagIndex = count;
+    return stats.tags[count];
+}
+
+static void DefaultViolationHandler(const char *scope, size_t bytes) {
+    fprintf(stderr, "Allocation of %u bytes inside no-allocation scope %s\n",
+            static_cast<unsigned int>(bytes), scope);
+    assert(false && "Allocation inside a NoAllocScope");
+}
+
+// Returns whether the block was counted.
+static bool RecordAllocation(size_t size) {
+    if (suspended) return false;
+
+    AllocThreadStats *stats = GetThreadStats();
+    if (!stats) return false;
+
+    Bump(stats->count, 1);
+    Bump(stats->bytes, size);
+
+    const char *tag = threadTag ? threadTag : Profiler::GetCurrentZone();
+    AllocTagCounter &counter = FindTag(*stats, tag ? tag : kUntagged);
+    Bump(counter.count, 1);
+    Bump(counter.bytes, size);
+
+    ptrdiff_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    ptrdiff_t peak = framePeak.load(std::memory_order_relaxed);
+    while (live > peak && !framePeak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+
+    if (noAllocDepth > 0) {
+        violations.fetch_add(1, std::memory_order_relaxed);
+        AllocViolationHandler handler = violationHandler.load(std::memory_order_relaxed);
+
+        suspended = true;
+        (handler ? handler : &DefaultViolationHandler)(noAllocName, size);
+        suspended = false;
+    }
+    return true;
+}
+
+static void RecordFree(size_t size) {
+    liveBytes.fetch_sub(size, std::memory_order_relaxed);
+
+    AllocThreadStats *stats = GetThreadStats();
+    if (stats) Bump(stats->freeCount, 1);
+}
+
+static void* TrackedAllocate(size_t size) {
+    unsigned char *block = static_cast<unsigned char*>(malloc(size + kHeaderSize));
+    if (!block) return nullptr;
+
+    size_t *header = reinterpret_cast<size_t*>(block);
+    header[0] = size;
+    header[1] = RecordAllocation(size) ? 1 : 0;
+    return block + kHeaderSize;
+}
+
+static void TrackedFree(void *memory) {
+    if (!memory) return;
+
+    unsigned char *block = static_cast<unsigned char*>(memory) - kHeaderSize;
+    size_t *header = reinterpret_cast<size_t*>(block);
+    if (header[1]) {
+        RecordFree(header[0]);
+    }
+    free(block);
+}
+
+void AllocTracker::BeginFrame() {
+    for (AllocThreadStats *stats = threadList.load(std::memory_order_acquire); stats; stats = stats->next) {
+        stats->startCount = stats->count.load(std::memory_order_relaxed);
+        stats->startBytes = stats->bytes.load(std::memory_order_relaxed);
+        stats->startFreeCount = stats->freeCount.load(std::memory_order_relaxed);
+
+        unsigned int tagCount = stats->tagCount.load(std::memory_order_acquire);
+        for (unsigned int i = 0; i < tagCount; ++i) {
+            stats->tags[i].startCount = stats->tags[i].count.load(std::memory_order_relaxed);
+            stats->tags[i].startBytes = stats->tags[i].bytes.load(std::memory_order_relaxed);
+        }
+    }
+    framePeak.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+static bool MoreAllocations(const AllocTagStats &a, const AllocTagStats &b) {
+    return a.count > b.count;
+}
+
+void AllocTracker::EndFrame() {
+    // Growing the tag list shouldn't show up in the next frame.
+    suspended = true;
+
+    AllocFrameStats &lastFrame = LastFrame();
+    lastFrame.count = 0;
+    lastFrame.bytes = 0;
+    lastFrame.freeCount = 0;
+    lastFrame.tags.clear();
+
+    for (AllocThreadStats *stats = threadList.load(std::memory_order_acquire); stats; stats = stats->next) {
+        // Threads that showed up mid-frame started at zero.
+        lastFrame.count += stats->count.load(std::memory_order_relaxed) - stats->startCount;
+        lastFrame.bytes += stats->bytes.load(std::memory_order_relaxed) - stats->startBytes;
+        lastFrame.freeCount += stats->freeCount.load(std::memory_order_relaxed) - stats->startFreeCount;
+
+        unsigned int tagCount = stats->tagCount.load(std::memory_order_acquire);
+        for (unsigned int i = 0; i < tagCount; ++i) {
+            const AllocTagCounter &counter = stats->tags[i];
+            size_t count = counter.count.load(std::memory_order_relaxed) - counter.startCount;
+            size_t bytes = counter.bytes.load(std::memory_order_relaxed) - counter.startBytes;
+            if (count == 0) continue;
+
+            size_t t = 0;
+            while (t < lastFrame.tags.size() && strcmp(lastFrame.tags[t].name, counter.tag) != 0) ++t;
+            if (t == lastFrame.tags.size()) {
+                AllocTagStats added = { counter.tag, 0, 0 };
+                lastFrame.tags.push_back(added);
+            }
+            lastFrame.tags[t].count += count;
+            lastFrame.tags[t].bytes += bytes;
+        }
+    }
+
+    ptrdiff_t peak = framePeak.load(std::memory_order_relaxed);
+    lastFrame.peakBytes = peak > 0 ? static_cast<size_t>(peak) : 0;
+    std::sort(lastFrame.tags.begin(), lastFrame.tags.end(), &MoreAllocations);
+
+    suspended = false;
+}
+
+size_t AllocTracker::GetTotalCount() {
+    size_t total = 0;
+    for (AllocThreadStats *stats = threadList.load(std::memory_order_acquire); stats; stats = stats->next) {
+        total += stats->count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t AllocTracker::GetLiveBytes() {
+    ptrdiff_t live = liveBytes.load(std::memory_order_relaxed);
+    return live > 0 ? static_cast<size_t>(live) : 0;
+}
+
+void AllocTracker::SetViolationHandler(AllocViolationHandler handler) {
+    violationHandler.store(handler, std::memory_order_relaxed);
+}
+
+size_t AllocTracker::GetViolationCount() {
+    return violations.load(std::memory_order_relaxed);
+}
+
+const char* AllocTracker::PushTag(const char *tag) {
+    const char *previous = threadTag;
+    threadTag = tag;
+    return previous;
+}
+
+void AllocTracker::PopTag(const char *previous) {
+    threadTag = previous;
+}
+
+void AllocTracker::BeginNoAlloc(const char *name) {
+    // The outermost scope names the violation.
+    if (noAllocDepth++ == 0) {
+        noAllocName = name;
+    }
+}
+
+void AllocTracker::EndNoAlloc() {
+    assert(noAllocDepth > 0 && "EndNoAlloc() without BeginNoAlloc()");
+    --noAllocDepth;
+}
+
+#else
+
+void AllocTracker::BeginFrame() { }
+void AllocTracker::EndFrame() { }
+size_t AllocTracker::GetTotalCount() { return 0; }
+size_t AllocTracker::GetLiveBytes() { return 0; }
+void AllocTracker::SetViolationHandler(AllocViolationHandler handler) { }
+size_t AllocTracker::GetViolationCount() { return 0; }
+const char* AllocTracker::PushTag(const char *tag) { return nullptr; }
+void AllocTracker::PopTag(const char *previous) { }
+void AllocTracker::BeginNoAlloc(const char *name) { }
+void AllocTracker::EndNoAlloc() { }
+
+#endif // DXLIB_TRACK_ALLOCATIONS
+
+const AllocFrameStats& AllocTracker::GetLastFrame() {
+    return LastFrame();
+}
+
+} // namespace dx
+
+#if DXLIB_TRACK_ALLOCATIONS
+
+// Replacements for the global allocation functions. They live in this
+// file so linking anything from the tracker pulls them in.
+void* operator new(size_t size) {
+    void *memory = dx::TrackedAllocate(size);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+    return dx::TrackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw() {
+    return dx::TrackedAllocate(size);
+}
+
+void operator delete(void *memory) throw() {
+    dx::TrackedFree(memory);
+}
+
+void operator delete[](void *memory) throw() {
+    dx::TrackedFree(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t&) throw() {
+    dx::TrackedFree(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t&) throw() {
+    dx::TrackedFree(memory);
+}
+
+#endif // DXLIB_TRACK_ALLOCATIONS
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include <AssetPack.h>
+#include <JobSystem.h>
+#include <Lz.h>
+
+#include <Windows.h>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+static bool IsAligned(unsigned long long value) {
+    return (value & (dx::AssetPackHeader::kAlignment - 1)) == 0;
+}
+
+namespace dx {
+
+AssetPack::AssetPack() {
+    _file = INVALID_HANDLE_VALUE;
+    _mapping = nullptr;
+    _base = nullptr;
+    _header = nullptr;
+    _entries = nullptr;
+}
+
+AssetPack::~AssetPack() {
+    Close();
+}
+
+Error::E AssetPack::Open(const std::string &path) {
+    assert(!IsOpen() && "AssetPack already open");
+
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_file == INVALID_HANDLE_VALUE) return Error::FILE_OPEN_FAIL;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(AssetPackHeader)) ||
+        static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<SIZE_T>(-1)) {
+        Close();
+        return Error::FILE_FORMAT_INVALID;
+    }
+
+    _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (_mapping) {
+        _base = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!_base) {
+        Close();
+        return Error::FILE_OPEN_FAIL;
+    }
+
+    // Everything the views rely on is checked once here.
+    unsigned long long size = static_cast<unsigned long long>(fileSize.QuadPart);
+    const AssetPackHeader *header = reinterpret_cast<const AssetPackHeader*>(_base);
+    bool valid = header->magic == AssetPackHeader::kMagic &&
+                 header->version == AssetPackHeader::kVersion &&
+                 header->fileSize == size &&
+                 IsAligned(header->tocOffset) &&
+                 header->tocOffset <= size &&
+                 header->entryCount <= (size - header->tocOffset) / sizeof(AssetPackEntry);
+
+    const AssetPackEntry *entries = reinterpret_cast<const AssetPackEntry*>(_base + header->tocOffset);
+    for (UINT i = 0; valid && i < header->entryCount; ++i) {
+        const AssetPackEntry &entry = entries[i];
+        valid = IsAligned(entry.offset) && entry.offset <= size && entry.size <= size - entry.offset &&
+                entry.name[AssetPackEntry::kNameLength - 1] == '\0' &&
+                (i == 0 || entries[i - 1].nameHash <= entry.nameHash);
+        if (valid && entry.compression == AssetCompression::LZ_BLOCKS) {
+            valid = entry.blockSize > 0 &&
+                    entry.blockCount == (entry.rawSize + entry.blockSize - 1) / entry.blockSize &&
+                    (entry.blockCount + 1ull) * sizeof(UINT) <= entry.size;
+        } else if (valid) {
+            valid = entry.compression == AssetCompression::NONE && entry.rawSize == entry.size;
+        }
+    }
+
+    if (!valid) {
+        Close();
+        return Error::FILE_FORMAT_INVALID;
+    }
+
+    _path = path;
+    _header = header;
+    _entries = entries;
+    return Error::OK;
+}
+
+void AssetPack::Close() {
+    if (_base) UnmapViewOfFile(_base);
+    if (_mapping) CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+
+    _file = INVALID_HANDLE_VALUE;
+    _mapping = nullptr;
+    _base = nullptr;
+    _header = nullptr;
+    _entries = nullptr;
+    _path.clear();
+}
+
+const AssetPackEntry* AssetPack::Find(const char *name) const {
+    if (!_header) return nullptr;
+
+    unsigned long long hash = HashName(name);
+    UINT first = 0, last = _header->entryCount;
+    while (first < last) {
+        UINT middle = first + (last - first) / 2;
+        if (_entries[middle].nameHash < hash) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    // Names sharing a hash sit next to each other.
+    for (UINT i = first; i < _header->entryCount && _entries[i].nameHash == hash; ++i) {
+        if (strcmp(_entries[i].name, name) == 0) return &_entries[i];
+    }
+    return nullptr;
+}
+
+Error::E AssetPack::Decompress(const AssetPackEntry &entry, void *out, JobSystem *jobs) const {
+    assert(IsOpen());
+    return DecompressBlob(entry, GetData(entry), out, jobs);
+}
+
+Error::E AssetPack::DecompressBlob(const AssetPackEntry &entry, const void *blob, void *out, JobSystem *jobs) {
+    if (entry.compression == AssetCompression::NONE) {
+        memcpy(out, blob, static_cast<size_t>(entry.size));
+        return Error::OK;
+    }
+
+    std::atomic<bool> ok(true);
+    const char *src = static_cast<const char*>(blob);
+    char *dst = static_cast<char*>(out);
+    auto body = [&entry, src, dst, &ok](UINT first, UINT last) {
+        for (UINT block = first; block < last; ++block) {
+            if (!DecompressBlock(entry, src, block, dst)) ok.store(false, std::memory_order_relaxed);
+        }
+    };
+
+    if (jobs && jobs->IsInitialized()) {
+        jobs->ParallelFor(0, entry.blockCount, 1, body);
+    } else {
+        body(0, entry.blockCount);
+    }
+    return ok.load() ? Error::OK : Error::FILE_FORMAT_INVALID;
+}
+
+bool AssetPack::DecompressBlock(const AssetPackEntry &entry, const char *blob, UINT block, char *out) {
+    const UINT *offsets = reinterpret_cast<const UINT*>(blob);
+    UINT begin = offsets[block];
+    UINT end = offsets[block + 1];
+    if (begin > end || end > entry.size) return false;
+
+    unsigned long long rawBegin = static_cast<unsigned long long>(block) * entry.blockSize;
+    size_t rawSize = static_cast<size_t>(entry.rawSize - rawBegin < entry.blockSize ? entry.rawSize - rawBegin : entry.blockSize);
+    if (end - begin == rawSize) {
+        memcpy(out + rawBegin, blob + begin, rawSize);
+        return true;
+    }
+    return LzDecompress(blob + begin, end - begin, out + rawBegin, rawSize);
+}
+
+const AssetPackEntry* AssetPack::FindPlain(const char *name, AssetType::E type) const {
+    const AssetPackEntry *entry = Find(name);
+    if (!entry || entry->type != static_cast<UINT>(type) || entry->compression != AssetCompression::NONE) {
+        return nullptr;
+    }
+    return entry;
+}
+
+bool AssetPack::GetMesh(const char *name, MeshView &view) const {
+    const AssetPackEntry *entry = FindPlain(name, AssetType::MESH);
+    return entry && ViewMesh(GetData(*entry), static_cast<size_t>(entry->size), view);
+}
+
+bool AssetPack::GetTexture(const char *name, TextureView &view) const {
+    const AssetPackEntry *entry = FindPlain(name, AssetType::TEXTURE);
+    return entry && ViewTexture(GetData(*entry), static_cast<size_t>(entry->size), view);
+}
+
+bool AssetPack::GetAnimation(const char *name, AnimationView &view) const {
+    const AssetPackEntry *entry = FindPlain(name, AssetType::ANIMATION);
+    return entry && ViewAnimation(GetData(*entry), static_cast<size_t>(entry->size), view);
+}
+
+bool AssetPack::ViewMesh(const void *data, size_t size, MeshView &view) {
+    if (size < sizeof(MeshBlobHeader)) return false;
+    const MeshBlobHeader *header = static_cast<const MeshBlobHeader*>(data);
+    unsigned long long verticesEnd = sizeof(MeshBlobHeader) + static_cast<unsigned long long>(header->vertexCount) * sizeof(Vertex);
+    unsigned long long indicesEnd = header->indexOffset + static_cast<unsigned long long>(header->indexCount) * sizeof(UINT);
+    if (verticesEnd > size || header->indexOffset < verticesEnd || indicesEnd > size) return false;
+
+    const char *bytes = static_cast<const char*>(data);
+    view.vertices = reinterpret_cast<const Vertex*>(bytes + sizeof(MeshBlobHeader));
+    view.vertexCount = header->vertexCount;
+    view.indices = header->indexCount ? reinterpret_cast<const UINT*>(bytes + header->indexOffset) : nullptr;
+    view.indexCount = header->indexCount;
+    return true;
+}
+
+bool AssetPack::ViewTexture(const void *data, size_t size, TextureView &view) {
+    if (size < sizeof(TextureBlobHeader)) return false;
+    const TextureBlobHeader *header = static_cast<const TextureBlobHeader*>(data);
+    if (header->format != TextureFormat::R8G8B8A8 || header->pitch < header->width * 4ull) return false;
+    if (static_cast<unsigned long long>(header->pitch) * header->height > size - sizeof(TextureBlobHeader)) return false;
+
+    view.width = header->width;
+    view.height = header->height;
+    view.pitch = header->pitch;
+    view.format = static_cast<TextureFormat::E>(header->format);
+    view.pixels = static_cast<const char*>(data) + sizeof(TextureBlobHeader);
+    return true;
+}
+
+bool AssetPack::ViewAnimation(const void *data, size_t size, AnimationView &view) {
+    if (size < sizeof(AnimationBlobHeader)) return false;
+    const AnimationBlobHeader *header = static_cast<const AnimationBlobHeader*>(data);
+    unsigned long long keys = static_cast<unsigned long long>(header->boneCount) * header->frameCount;
+    if (keys * sizeof(Transform) > size - sizeof(AnimationBlobHeader)) return false;
+
+    view.boneCount = header->boneCount;
+    view.frameCount = header->frameCount;
+    view.framesPerSecond = header->framesPerSecond;
+    view.keys = reinterpret_cast<const Transform*>(static_cast<const char*>(data) + sizeof(AnimationBlobHeader));
+    return true;
+}
+
+unsigned long long AssetPack::HashName(const char *name) {
+    unsigned long long hash = 14695981039346656037ull;
+    for (; *name; ++name) {
+        hash ^= static_cast<unsigned char>(*name);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace dx
\ No newline at end of file
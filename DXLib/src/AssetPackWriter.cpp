@@ -0,0 +1,171 @@
+#include <AssetPackWriter.h>
+#include <Lz.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+static size_t AlignUp(size_t value) {
+    return (value + dx::AssetPackHeader::kAlignment - 1) & ~static_cast<size_t>(dx::AssetPackHeader::kAlignment - 1);
+}
+
+namespace dx {
+
+AssetPackWriter::AssetPackWriter() {
+    _compress = false;
+}
+
+AssetPackWriter::~AssetPackWriter() {
+    for (size_t i = 0; i < _assets.size(); ++i) {
+        delete _assets[i];
+    }
+}
+
+void AssetPackWriter::AddRaw(const char *name, AssetType::E type, const void *data, size_t size) {
+    std::vector<char> blob(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+    Add(name, type, blob);
+}
+
+void AssetPackWriter::AddMesh(const char *name, const Vertex *vertices, UINT vertexCount,
+                              const UINT *indices, UINT indexCount) {
+    MeshBlobHeader header;
+    memset(&header, 0, sizeof(header));
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.indexOffset = static_cast<UINT>(AlignUp(sizeof(header) + vertexCount * sizeof(Vertex)));
+
+    std::vector<char> blob(header.indexOffset + indexCount * sizeof(UINT));
+    memcpy(&blob[0], &header, sizeof(header));
+    if (vertexCount) memcpy(&blob[sizeof(header)], vertices, vertexCount * sizeof(Vertex));
+    if (indexCount) memcpy(&blob[header.indexOffset], indices, indexCount * sizeof(UINT));
+    Add(name, AssetType::MESH, blob);
+}
+
+void AssetPackWriter::AddTexture(const char *name, UINT width, UINT height, const void *pixels) {
+    TextureBlobHeader header;
+    memset(&header, 0, sizeof(header));
+    header.width = width;
+    header.height = height;
+    header.pitch = width * 4;
+    header.format = TextureFormat::R8G8B8A8;
+
+    size_t bytes = static_cast<size_t>(header.pitch) * height;
+    std::vector<char> blob(sizeof(header) + bytes);
+    memcpy(&blob[0], &header, sizeof(header));
+    if (bytes) memcpy(&blob[sizeof(header)], pixels, bytes);
+    Add(name, AssetType::TEXTURE, blob);
+}
+
+void AssetPackWriter::AddAnimation(const char *name, UINT boneCount, UINT frameCount,
+                                   float framesPerSecond, const Transform *keys) {
+    AnimationBlobHeader header;
+    memset(&header, 0, sizeof(header));
+    header.boneCount = boneCount;
+    header.frameCount = frameCount;
+    header.framesPerSecond = framesPerSecond;
+
+    size_t bytes = static_cast<size_t>(boneCount) * frameCount * sizeof(Transform);
+    std::vector<char> blob(sizeof(header) + bytes);
+    memcpy(&blob[0], &header, sizeof(header));
+    if (bytes) memcpy(&blob[sizeof(header)], keys, bytes);
+    Add(name, AssetType::ANIMATION, blob);
+}
+
+void AssetPackWriter::Add(const char *name, AssetType::E type, std::vector<char> &blob) {
+    assert(strlen(name) < AssetPackEntry::kNameLength && "Asset name too long");
+
+    PendingAsset *asset = new PendingAsset();
+    AssetPackEntry &entry = asset->entry;
+    memset(&entry, 0, sizeof(entry));
+    strncpy_s(entry.name, name, _TRUNCATE);
+    entry.nameHash = AssetPack::HashName(entry.name);
+    entry.type = type;
+    entry.rawSize = blob.size();
+    entry.compression = AssetCompression::NONE;
+
+    if (_compress && !blob.empty()) {
+        // Offsets of the blocks, then the blocks. Blocks that don't
+        // shrink are stored as they are.
+        UINT blockCount = static_cast<UINT>((blob.size() + kBlockSize - 1) / kBlockSize);
+        std::vector<char> packed((blockCount + 1) * sizeof(UINT));
+        std::vector<char> scratch(LzCompressBound(kBlockSize));
+        for (UINT block = 0; block < blockCount; ++block) {
+            size_t begin = static_cast<size_t>(block) * kBlockSize;
+            size_t rawSize = std::min<size_t>(kBlockSize, blob.size() - begin);
+            UINT offset = static_cast<UINT>(packed.size());
+            memcpy(&packed[block * sizeof(UINT)], &offset, sizeof(offset));
+
+            size_t size = LzCompress(&blob[begin], rawSize, &scratch[0], rawSize - 1);
+            if (size) {
+                packed.insert(packed.end(), scratch.begin(), scratch.begin() + size);
+            } else {
+                packed.insert(packed.end(), blob.begin() + begin, blob.begin() + begin + rawSize);
+            }
+        }
+        UINT end = static_cast<UINT>(packed.size());
+        memcpy(&packed[blockCount * sizeof(UINT)], &end, sizeof(end));
+
+        if (packed.size() < blob.size()) {
+            entry.compression = AssetCompression::LZ_BLOCKS;
+            entry.blockSize = kBlockSize;
+            entry.blockCount = blockCount;
+            blob.swap(packed);
+            ++_stats.compressed;
+        }
+    }
+
+    entry.size = blob.size();
+    asset->data.swap(blob);
+    _assets.push_back(asset);
+
+    ++_stats.assets;
+    _stats.rawBytes += entry.rawSize;
+}
+
+Error::E AssetPackWriter::Write(const std::string &path) {
+    std::vector<PendingAsset*> sorted(_assets);
+    // AssetPack::Find() binary searches by hash.
+    std::stable_sort(sorted.begin(), sorted.end(), [](const PendingAsset *a, const PendingAsset *b) {
+        return a->entry.nameHash < b->entry.nameHash;
+    });
+
+    AssetPackHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = AssetPackHeader::kMagic;
+    header.version = AssetPackHeader::kVersion;
+    header.entryCount = static_cast<UINT>(sorted.size());
+    header.tocOffset = AlignUp(sizeof(header));
+
+    size_t offset = AlignUp(static_cast<size_t>(header.tocOffset) + sorted.size() * sizeof(AssetPackEntry));
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        sorted[i]->entry.offset = offset;
+        offset = AlignUp(offset + sorted[i]->data.size());
+    }
+    header.fileSize = offset;
+
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) return Error::FILE_OPEN_FAIL;
+
+    static const char kZeros[AssetPackHeader::kAlignment] = { 0 };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(kZeros, header.tocOffset - sizeof(header));
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        out.write(reinterpret_cast<const char*>(&sorted[i]->entry), sizeof(AssetPackEntry));
+    }
+
+    size_t written = static_cast<size_t>(header.tocOffset) + sorted.size() * sizeof(AssetPackEntry);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const AssetPackEntry &entry = sorted[i]->entry;
+        out.write(kZeros, entry.offset - written);
+        if (!sorted[i]->data.empty()) out.write(&sorted[i]->data[0], sorted[i]->data.size());
+        written = static_cast<size_t>(entry.offset + entry.size);
+    }
+    out.write(kZeros, header.fileSize - written);
+
+    if (!out) return Error::FILE_OPEN_FAIL;
+    _stats.fileBytes = header.fileSize;
+    return Error::OK;
+}
+
+} // namespace dx
\ No newline at end of file
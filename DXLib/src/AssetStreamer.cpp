@@ -0,0 +1,399 @@
+#include <AssetStreamer.h>
+#include <AssetPack.h>
+#include <Timer.h>
+
+#include <Windows.h>
+#include <malloc.h>
+#include <cassert>
+#include <cstring>
+
+// Longest single ReadFile, larger blobs take several.
+static const size_t kMaxReadSize = 16 * 1024 * 1024;
+
+static double SecondsSince(unsigned long long startTicks) {
+    return (dx::Timer::GetRawTicks() - startTicks) * dx::Timer::GetSecondsPerTick();
+}
+
+namespace dx {
+
+// One asset's trip from the I/O thread through decoding to Update(),
+// then its memory while resident.
+struct AssetLoad {
+    UINT asset;
+    const AssetPackEntry *entry;
+    AssetStreamer *streamer;
+    bool ok;
+
+    // The sector-aligned read around the blob, freed once decompressed.
+    char *readBuffer;
+    size_t readSize;
+    size_t blobOffset;
+    // Only for compressed blobs, plain ones are used in the read buffer.
+    char *decoded;
+
+    const void *data;
+    size_t size;
+    // Memory held while resident.
+    size_t residentBytes;
+
+    double readSeconds;
+    double decodeSeconds;
+    AssetLoad *next;
+};
+
+static void FreeLoad(AssetLoad *load) {
+    if (load->readBuffer) _aligned_free(load->readBuffer);
+    delete[] load->decoded;
+    delete load;
+}
+
+AssetStreamer::AssetStreamer() {
+    _pack = nullptr;
+    _jobs = nullptr;
+    _file = INVALID_HANDLE_VALUE;
+    _budget = 0;
+    _records = nullptr;
+    _recordCount = 0;
+    _lruHead = kInvalidAsset;
+    _lruTail = kInvalidAsset;
+    _sequence = 0;
+    _quit = false;
+    _completed = nullptr;
+}
+
+AssetStreamer::~AssetStreamer() {
+    Shutdown();
+}
+
+Error::E AssetStreamer::Initialize(const AssetPack &pack, JobSystem *jobs, size_t budgetBytes) {
+    assert(!_records && "AssetStreamer already initialized");
+    assert(pack.IsOpen());
+    assert((!jobs || jobs->IsInitialized()) && "Initialize the JobSystem before the AssetStreamer");
+
+    // Bypasses the file cache, reads go straight into our buffers.
+    _file = CreateFileA(pack.GetPath().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+    if (_file == INVALID_HANDLE_VALUE) return Error::FILE_OPEN_FAIL;
+
+    _pack = &pack;
+    _jobs = jobs;
+    _budget = budgetBytes;
+
+    _recordCount = pack.GetAssetCount();
+    _records = new Record[_recordCount];
+    for (UINT i = 0; i < _recordCount; ++i) {
+        Record &record = _records[i];
+        record.state = AssetState::UNLOADED;
+        record.queuedPriority = 0;
+        record.canceled = false;
+        record.pinned = false;
+        record.load = nullptr;
+        record.prev = kInvalidAsset;
+        record.next = kInvalidAsset;
+    }
+
+    _quit = false;
+    _ioThread = std::thread(&AssetStreamer::IoThreadMain, this);
+    return Error::OK;
+}
+
+void AssetStreamer::Shutdown() {
+    if (!_records) return;
+
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _quit = true;
+        while (!_queue.empty()) _queue.pop();
+    }
+    _queueSignal.notify_all();
+    _ioThread.join();
+    if (_jobs) {
+        // A stopped JobSystem never runs the decodes we'd wait for.
+        assert(_jobs->IsInitialized() && "Shut the AssetStreamer down before its JobSystem");
+        _jobs->Wait(_decoding);
+    }
+
+    AssetLoad *load = _completed.exchange(nullptr, std::memory_order_acquire);
+    while (load) {
+        AssetLoad *next = load->next;
+        FreeLoad(load);
+        load = next;
+    }
+    for (UINT i = 0; i < _recordCount; ++i) {
+        if (_records[i].load) FreeLoad(_records[i].load);
+    }
+
+    delete[] _records;
+    _records = nullptr;
+    _recordCount = 0;
+    _lruHead = _lruTail = kInvalidAsset;
+    _stats.residentBytes = 0;
+
+    CloseHandle(_file);
+    _file = INVALID_HANDLE_VALUE;
+    _pack = nullptr;
+}
+
+UINT AssetStreamer::FindAsset(const char *name) const {
+    const AssetPackEntry *entry = _pack->Find(name);
+    if (!entry) return kInvalidAsset;
+    return static_cast<UINT>(entry - &_pack->GetEntry(0));
+}
+
+void AssetStreamer::Request(UINT asset, int priority) {
+    assert(asset < _recordCount);
+    Record &record = _records[asset];
+    ++_stats.requests;
+
+    int state = record.state.load(std::memory_order_acquire);
+    if (state == AssetState::RESIDENT) {
+        Touch(asset);
+        return;
+    }
+    if (state == AssetState::LOADING) {
+        // Still wanted after all.
+        record.canceled = false;
+        return;
+    }
+
+    if (state == AssetState::QUEUED) {
+        // The old entry is skipped once this one has been read.
+        if (priority <= record.queuedPriority) return;
+    } else {
+        record.state.store(AssetState::QUEUED, std::memory_order_release);
+    }
+    record.queuedPriority = priority;
+
+    PendingRead read;
+    read.priority = priority;
+    read.asset = asset;
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        read.sequence = _sequence++;
+        _queue.push(read);
+    }
+    _queueSignal.notify_one();
+}
+
+void AssetStreamer::Cancel(UINT asset) {
+    assert(asset < _recordCount);
+    Record &record = _records[asset];
+
+    int expected = AssetState::QUEUED;
+    if (record.state.compare_exchange_strong(expected, AssetState::UNLOADED)) {
+        ++_stats.cancels;
+    } else if (expected == AssetState::LOADING && !record.canceled) {
+        record.canceled = true;
+        ++_stats.cancels;
+    }
+}
+
+void AssetStreamer::Update() {
+    AssetLoad *list = _completed.exchange(nullptr, std::memory_order_acquire);
+
+    // Pushed newest first, deliver in the order they finished.
+    AssetLoad *ordered = nullptr;
+    while (list) {
+        AssetLoad *next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    while (ordered) {
+        AssetLoad *next = ordered->next;
+        Deliver(ordered);
+        ordered = next;
+    }
+
+    UINT asset = _lruTail;
+    while (_stats.residentBytes > _budget && asset != kInvalidAsset) {
+        UINT prev = _records[asset].prev;
+        if (!_records[asset].pinned) Evict(asset);
+        asset = prev;
+    }
+}
+
+AssetState::E AssetStreamer::GetState(UINT asset) const {
+    assert(asset < _recordCount);
+    return static_cast<AssetState::E>(_records[asset].state.load(std::memory_order_acquire));
+}
+
+const void* AssetStreamer::GetData(UINT asset, size_t *size) {
+    assert(asset < _recordCount);
+    Record &record = _records[asset];
+    if (record.state.load(std::memory_order_relaxed) != AssetState::RESIDENT) return nullptr;
+
+    Touch(asset);
+    if (size) *size = record.load->size;
+    return record.load->data;
+}
+
+void AssetStreamer::SetPinned(UINT asset, bool pinned) {
+    assert(asset < _recordCount);
+    _records[asset].pinned = pinned;
+}
+
+void AssetStreamer::IoThreadMain() {
+    for (;;) {
+        PendingRead read;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _queueSignal.wait(lock, [this]() { return _quit || !_queue.empty(); });
+            if (_quit) return;
+            read = _queue.top();
+            _queue.pop();
+        }
+
+        // Canceled, or left behind when the priority was raised.
+        int expected = AssetState::QUEUED;
+        if (!_records[read.asset].state.compare_exchange_strong(expected, AssetState::LOADING)) continue;
+
+        AssetLoad *load = Read(read.asset);
+        if (load->ok && _jobs && _jobs->IsInitialized()) {
+            _jobs->Run(MakeJob(&DecodeJob, load, &_decoding));
+        } else {
+            if (load->ok) Decode(load);
+            Complete(load);
+        }
+    }
+}
+
+AssetLoad* AssetStreamer::Read(UINT asset) {
+    const AssetPackEntry &entry = _pack->GetEntry(asset);
+    AssetLoad *load = new AssetLoad();
+    memset(load, 0, sizeof(*load));
+    load->asset = asset;
+    load->entry = &entry;
+    load->streamer = this;
+
+    unsigned long long begin = entry.offset & ~static_cast<unsigned long long>(kReadAlignment - 1);
+    unsigned long long end = (entry.offset + entry.size + kReadAlignment - 1) & ~static_cast<unsigned long long>(kReadAlignment - 1);
+    load->readSize = static_cast<size_t>(end - begin);
+    load->blobOffset = static_cast<size_t>(entry.offset - begin);
+    load->readBuffer = static_cast<char*>(_aligned_malloc(load->readSize ? load->readSize : kReadAlignment, kReadAlignment));
+
+    unsigned long long start = Timer::GetRawTicks();
+    size_t needed = load->blobOffset + static_cast<size_t>(entry.size);
+    size_t done = 0;
+    load->ok = load->readBuffer != nullptr;
+    while (load->ok && done < needed) {
+        size_t chunk = load->readSize - done < kMaxReadSize ? load->readSize - done : kMaxReadSize;
+        unsigned long long offset = begin + done;
+
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        // The file's last sector comes back short.
+        DWORD read = 0;
+        load->ok = ReadFile(static_cast<HANDLE>(_file), load->readBuffer + done, static_cast<DWORD>(chunk), &read, &overlapped) && read > 0;
+        done += read;
+    }
+    load->ok = load->ok && done >= needed;
+    load->readSeconds = SecondsSince(start);
+    return load;
+}
+
+void AssetStreamer::DecodeJob(void *data) {
+    AssetLoad *load = static_cast<AssetLoad*>(data);
+    load->streamer->Decode(load);
+    load->streamer->Complete(load);
+}
+
+void AssetStreamer::Decode(AssetLoad *load) {
+    unsigned long long start = Timer::GetRawTicks();
+    const AssetPackEntry &entry = *load->entry;
+
+    if (entry.compression == AssetCompression::NONE) {
+        load->data = load->readBuffer + load->blobOffset;
+        load->size = static_cast<size_t>(entry.size);
+        load->residentBytes = load->readSize;
+    } else {
+        load->decoded = new char[static_cast<size_t>(entry.rawSize) + 1];
+        load->ok = AssetPack::DecompressBlob(entry, load->readBuffer + load->blobOffset, load->decoded, _jobs) == Error::OK;
+        _aligned_free(load->readBuffer);
+        load->readBuffer = nullptr;
+
+        load->data = load->decoded;
+        load->size = static_cast<size_t>(entry.rawSize);
+        load->residentBytes = load->size;
+    }
+
+    load->decodeSeconds = SecondsSince(start);
+}
+
+// Any thread. Lock-free push onto the list Update() takes.
+void AssetStreamer::Complete(AssetLoad *load) {
+    AssetLoad *head = _completed.load(std::memory_order_relaxed);
+    do {
+        load->next = head;
+    } while (!_completed.compare_exchange_weak(head, load, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void AssetStreamer::Deliver(AssetLoad *load) {
+    Record &record = _records[load->asset];
+    _stats.bytesRead += load->readSize;
+    _stats.readSeconds += load->readSeconds;
+    _stats.decodeSeconds += load->decodeSeconds;
+
+    if (!load->ok || record.canceled) {
+        if (!load->ok) ++_stats.failures;
+        record.canceled = false;
+        record.state.store(load->ok ? AssetState::UNLOADED : AssetState::FAILED, std::memory_order_release);
+        FreeLoad(load);
+        return;
+    }
+
+    record.load = load;
+    record.state.store(AssetState::RESIDENT, std::memory_order_release);
+    ++_stats.loads;
+    _stats.residentBytes += load->residentBytes;
+    if (_stats.residentBytes > _stats.peakResidentBytes) _stats.peakResidentBytes = _stats.residentBytes;
+
+    // Most recently used.
+    record.prev = kInvalidAsset;
+    record.next = _lruHead;
+    if (_lruHead != kInvalidAsset) _records[_lruHead].prev = load->asset;
+    _lruHead = load->asset;
+    if (_lruTail == kInvalidAsset) _lruTail = load->asset;
+}
+
+void AssetStreamer::Evict(UINT asset) {
+    Record &record = _records[asset];
+    Unlink(asset);
+
+    _stats.residentBytes -= record.load->residentBytes;
+    ++_stats.evictions;
+    FreeLoad(record.load);
+    record.load = nullptr;
+    record.state.store(AssetState::UNLOADED, std::memory_order_release);
+}
+
+void AssetStreamer::Touch(UINT asset) {
+    if (_lruHead == asset) return;
+
+    Unlink(asset);
+    Record &record = _records[asset];
+    record.next = _lruHead;
+    _records[_lruHead].prev = asset;
+    _lruHead = asset;
+    if (_lruTail == kInvalidAsset) _lruTail = asset;
+}
+
+void AssetStreamer::Unlink(UINT asset) {
+    Record &record = _records[asset];
+    if (record.prev != kInvalidAsset) {
+        _records[record.prev].next = record.next;
+    } else {
+        _lruHead = record.next;
+    }
+    if (record.next != kInvalidAsset) {
+        _records[record.next].prev = record.prev;
+    } else {
+        _lruTail = record.prev;
+    }
+    record.prev = record.next = kInvalidAsset;
+}
+
+} // namespace dx
\ No newline at end of file
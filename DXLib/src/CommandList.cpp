@@ -0,0 +1,107 @@
+#include <CommandList.h>
+#include <RenderSystem.h>
+
+#include <cassert>
+#include <cstring>
+
+namespace dx {
+
+CommandList::CommandList(RenderSystem &owner, size_t arenaSize) {
+    _owner = &owner;
+    _first = nullptr;
+    _last = nullptr;
+    _commandCount = 0;
+    _drawCount = 0;
+    _recording = false;
+    _arena.Initialize(arenaSize);
+}
+
+CommandList::~CommandList() {
+
+}
+
+void CommandList::Begin() {
+    assert(!_recording && "CommandList already recording");
+    _arena.Reset();
+    _first = nullptr;
+    _last = nullptr;
+    _commandCount = 0;
+    _drawCount = 0;
+    _recording = true;
+    OnBegin();
+}
+
+void CommandList::End() {
+    assert(_recording && "CommandList::End() without Begin()");
+    OnEnd();
+    _recording = false;
+}
+
+void CommandList::Clear(const Vector4f &color) {
+    assert(_recording);
+    ++_commandCount;
+    OnClear(color);
+}
+
+void CommandList::Draw(const DrawCommand &command) {
+    assert(_recording);
+    ++_commandCount;
+    ++_drawCount;
+    OnDraw(command, false);
+}
+
+void CommandList::DrawTransient(const DrawCommand &command) {
+    assert(_recording);
+    ++_commandCount;
+    ++_drawCount;
+    OnDraw(command, true);
+}
+
+void CommandList::Replay(RenderSystem &r) const {
+    assert(!_recording && "Replaying a CommandList that is still recording");
+    for (const Command *c = _first; c; c = c->next) {
+        if (c->type == RenderCommandType::CLEAR) {
+            r.Clear(c->color);
+        } else {
+            r.Draw(c->draw);
+        }
+    }
+}
+
+void CommandList::OnClear(const Vector4f &color) {
+    Command *c = Append(RenderCommandType::CLEAR);
+    c->color = color;
+}
+
+void CommandList::OnDraw(const DrawCommand &command, bool transient) {
+    Command *c = Append(RenderCommandType::DRAW);
+    c->draw = command;
+
+    if (transient) {
+        Vertex *vertices = _arena.AllocateArray<Vertex>(command.vertexCount);
+        memcpy(vertices, command.vertices, command.vertexCount * sizeof(Vertex));
+        c->draw.vertices = vertices;
+
+        if (command.indices) {
+            UINT *indices = _arena.AllocateArray<UINT>(command.indexCount);
+            memcpy(indices, command.indices, command.indexCount * sizeof(UINT));
+            c->draw.indices = indices;
+        }
+    }
+}
+
+CommandList::Command* CommandList::Append(RenderCommandType::E type) {
+    Command *c = _arena.New<Command>();
+    c->type = type;
+    c->next = nullptr;
+
+    if (_last) {
+        _last->next = c;
+    } else {
+        _first = c;
+    }
+    _last = c;
+    return c;
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,665 @@
+#include <D3D11RenderSystem.h>
+#include <CommandList.h>
+#include <Timer.h>
+#include <VertexFormat.h>
+#include <Window.h>
+#include "Util.h"
+
+#include <d3dcompiler.h>
+#include <cassert>
+#include <cstring>
+
+static const UINT kDefaultWidth = 640;
+static const UINT kDefaultHeight = 480;
+static const DXGI_FORMAT kDefaultFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+IDXGIFactory* FactoryFromDevice(ID3D11Device *device);
+
+// Default swapchain desc that has sane values for all parameters.
+// New modes are created by copying this and changing specific settings.
+static const DXGI_SWAP_CHAIN_DESC kDefaultSwapDesc = {
+    /* DXGI_MODE_DESC */ {
+        kDefaultWidth,
+        kDefaultHeight,
+        /* Refresh */ {
+            60, // Numerator
+            1   // Denominator
+        },
+        kDefaultFormat,
+        DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED,
+        DXGI_MODE_SCALING_UNSPECIFIED
+    },
+    /* DXGI_SAMPLE_DESC */ {
+        1, // SampleCount
+        0, // QualityLevel
+    },
+    DXGI_USAGE_RENDER_TARGET_OUTPUT,
+    1, // Number of Buffers
+    NULL, // Window Handle
+    TRUE, // Window-mode
+    DXGI_SWAP_EFFECT_DISCARD,
+    0 // Flags
+};
+
+// Largest DrawCommand the D3D11 path takes.
+static const UINT kMaxDrawVertices = 65536;
+static const UINT kMaxDrawIndices = kMaxDrawVertices * 3;
+
+// Upload ring sizes and the alignment of what goes into them, constant
+// buffer offsets count in 256 byte steps.
+static const UINT kUploadCapacity[dx::UploadKind::COUNT] = {
+    4 * 1024 * 1024,
+    8 * 1024 * 1024,
+    4 * 1024 * 1024,
+};
+static const UINT kUploadAlignment[dx::UploadKind::COUNT] = {
+    256,
+    sizeof(dx::Vertex),
+    sizeof(UINT),
+};
+static const UINT kUploadBindFlags[dx::UploadKind::COUNT] = {
+    D3D11_BIND_CONSTANT_BUFFER,
+    D3D11_BIND_VERTEX_BUFFER,
+    D3D11_BIND_INDEX_BUFFER,
+};
+
+static double SecondsSince(unsigned long long startTicks) {
+    return (dx::Timer::GetRawTicks() - startTicks) * dx::Timer::GetSecondsPerTick();
+}
+
+// Pipeline behind Draw(), matches what SoftwareRenderer does.
+static const char kDrawShader[] =
+    "cbuffer PerDraw : register(b0) { row_major float4x4 transform; };\n"
+    "struct VSIn { float3 position : POSITION; float4 color : COLOR; };\n"
+    "struct VSOut { float4 position : SV_POSITION; float4 color : COLOR; };\n"
+    "VSOut VSMain(VSIn v) {\n"
+    "    VSOut o;\n"
+    "    o.position = mul(float4(v.position, 1.0f), transform);\n"
+    "    o.color = v.color;\n"
+    "    return o;\n"
+    "}\n"
+    "float4 PSMain(VSOut i) : SV_TARGET { return i.color; }\n";
+
+// dx::Vertex as the draw shader reads it.
+typedef dx::VertexLayout<dx::PositionFloat3, dx::ColorUnorm8> DrawVertexLayout;
+static_assert(DrawVertexLayout::kStride == sizeof(dx::Vertex), "Draw vertex layout out of date");
+
+// Featurelevels we're interested in.
+static const D3D_FEATURE_LEVEL kFeatureLevels[] = {
+    D3D_FEATURE_LEVEL_11_0,
+    D3D_FEATURE_LEVEL_10_1,
+    D3D_FEATURE_LEVEL_10_0,
+    D3D_FEATURE_LEVEL_9_3,
+};
+
+namespace dx {
+
+D3D11RenderSystem::D3D11RenderSystem() {
+    _initOk = false;
+    _device = nullptr;
+    _context = nullptr;
+    _swapChain = nullptr;
+    _renderTargetView = nullptr;
+    _depthStencilView = nullptr;
+    _vertexShader = nullptr;
+    _pixelShader = nullptr;
+    _inputLayout = nullptr;
+    _rasterizerState = nullptr;
+    _constantBuffer = nullptr;
+    _vertexBuffer = nullptr;
+    _indexBuffer = nullptr;
+    for (UINT i = 0; i < UploadKind::COUNT; ++i) {
+        _uploadBuffers[i] = nullptr;
+    }
+    for (UINT i = 0; i < kFramesInFlight; ++i) {
+        _frameQueries[i] = nullptr;
+    }
+    _firstFrameQuery = 0;
+    _framesInFlight = 0;
+    _context1 = nullptr;
+}
+
+D3D11RenderSystem::~D3D11RenderSystem() {
+    if (_initOk) {
+        if (_context) {
+            _context->ClearState();
+        }
+        FreeResources();
+    }
+}
+
+Error::E D3D11RenderSystem::Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs) {
+    assert(!_initOk);
+    Error::E err = window ? InitializeWindowed(*window) : InitializeHeadless(width, height);
+    if (err != Error::OK) {
+        FreeResources();
+        return err;
+    }
+
+    BindPipeline(_context);
+
+    _initOk = true;
+    return Error::OK;
+}
+
+Error::E D3D11RenderSystem::InitializeWindowed(const Window &window) {
+    Error::E err = CreateDeviceAndContext(D3D_DRIVER_TYPE_HARDWARE);
+
+    if (err == Error::OK) {
+        err = CreateSwapChain(window);
+    }
+
+    if (err != Error::OK) return err;
+
+    ID3D11Texture2D *backBuffer;
+    DEBUG_HR(_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&backBuffer)));
+    DEBUG_HR(_device->CreateRenderTargetView(backBuffer, NULL, &_renderTargetView));
+    ReleaseCom(backBuffer);
+
+    err = CreateDepthStencilBuffer();
+
+    if (err == Error::OK) {
+        err = CreateDrawResources();
+    }
+
+    return err;
+}
+
+// Renders into an offscreen target on the WARP software rasterizer, no
+// window or GPU needed. Present() only flushes.
+Error::E D3D11RenderSystem::InitializeHeadless(UINT width, UINT height) {
+    Error::E err = CreateDeviceAndContext(D3D_DRIVER_TYPE_WARP);
+
+    if (err == Error::OK) {
+        err = CreateOffscreenTarget(width, height);
+    }
+
+    if (err == Error::OK) {
+        err = CreateDepthStencilBuffer();
+    }
+
+    if (err == Error::OK) {
+        err = CreateDrawResources();
+    }
+
+    return err;
+}
+
+void D3D11RenderSystem::Clear(const Vector4f &color) {
+    ClearOn(_context, color);
+}
+
+// Streams through the upload rings, nothing is discarded or renamed
+// and the buffers stay bound, draws only move their offsets.
+void D3D11RenderSystem::Draw(const DrawCommand &command) {
+    assert(command.vertexCount <= kMaxDrawVertices && "DrawCommand too large");
+    assert(command.indexCount <= kMaxDrawIndices && "DrawCommand too large");
+    CountDrawCall();
+    MakeUploadRoom(command);
+
+    if (_context1) {
+        // Offsets and sizes count 16 byte constants.
+        UINT first = Upload(UploadKind::CONSTANT, &command.transform, sizeof(command.transform)) / 16;
+        UINT count = kUploadAlignment[UploadKind::CONSTANT] / 16;
+        _context1->VSSetConstantBuffers1(0, 1, &_uploadBuffers[UploadKind::CONSTANT], &first, &count);
+    } else {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        DEBUG_HR(_context->Map(_constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+        memcpy(mapped.pData, &command.transform, sizeof(command.transform));
+        _context->Unmap(_constantBuffer, 0);
+    }
+
+    UINT baseVertex = Upload(UploadKind::VERTEX, command.vertices, command.vertexCount * sizeof(Vertex)) / sizeof(Vertex);
+    if (command.indices) {
+        UINT startIndex = Upload(UploadKind::INDEX, command.indices, command.indexCount * sizeof(UINT)) / sizeof(UINT);
+        _context->DrawIndexed(command.indexCount, startIndex, baseVertex);
+    } else {
+        _context->Draw(command.vertexCount, baseVertex);
+    }
+}
+
+// A fence must not fall between the allocations of one draw, or the
+// frame it ends could be retired before the draw is issued. All the
+// space is made before any of it is taken.
+void D3D11RenderSystem::MakeUploadRoom(const DrawCommand &command) {
+    UINT sizes[UploadKind::COUNT];
+    sizes[UploadKind::CONSTANT] = _context1 ? kUploadAlignment[UploadKind::CONSTANT] : 0;
+    sizes[UploadKind::VERTEX] = command.vertexCount * sizeof(Vertex);
+    sizes[UploadKind::INDEX] = command.indices ? command.indexCount * sizeof(UINT) : 0;
+
+    // Retiring only ever frees space, rings already checked still fit.
+    for (UINT kind = 0; kind < UploadKind::COUNT; ++kind) {
+        UploadRing &ring = _uploadRings[kind];
+        if (sizes[kind] == 0 || ring.Fits(sizes[kind], kUploadAlignment[kind])) continue;
+
+        unsigned long long start = Timer::GetRawTicks();
+        while (!ring.Fits(sizes[kind], kUploadAlignment[kind])) {
+            // The current frame alone filled the ring, fence what it
+            // has drawn so far to have something to wait on.
+            if (_framesInFlight == 0) FenceFrame();
+            RetireFrame(true);
+        }
+        ring.RecordStall(SecondsSince(start));
+    }
+}
+
+UINT D3D11RenderSystem::Upload(UploadKind::E kind, const void *data, UINT size) {
+    UINT offset = _uploadRings[kind].Allocate(size, kUploadAlignment[kind]);
+    assert(offset != UploadRing::kNoSpace && "MakeUploadRoom() not called");
+
+    // Nothing the GPU may still read is written, so the rest of the
+    // buffer is left alone.
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    DEBUG_HR(_context->Map(_uploadBuffers[kind], 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped));
+    memcpy(static_cast<char*>(mapped.pData) + offset, data, size);
+    _context->Unmap(_uploadBuffers[kind], 0);
+    return offset;
+}
+
+void D3D11RenderSystem::FenceFrame() {
+    if (_framesInFlight == kFramesInFlight) RetireFrame(true);
+
+    _context->End(_frameQueries[(_firstFrameQuery + _framesInFlight) % kFramesInFlight]);
+    ++_framesInFlight;
+    for (UINT i = 0; i < UploadKind::COUNT; ++i) {
+        _uploadRings[i].EndFrame();
+    }
+}
+
+bool D3D11RenderSystem::RetireFrame(bool wait) {
+    if (_framesInFlight == 0) return false;
+
+    ID3D11Query *query = _frameQueries[_firstFrameQuery];
+    if (wait) {
+        // Without DONOTFLUSH the first call submits the pending work.
+        while (_context->GetData(query, NULL, 0, 0) == S_FALSE) { }
+    } else if (_context->GetData(query, NULL, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+        return false;
+    }
+
+    _firstFrameQuery = (_firstFrameQuery + 1) % kFramesInFlight;
+    --_framesInFlight;
+    for (UINT i = 0; i < UploadKind::COUNT; ++i) {
+        _uploadRings[i].RetireFrame();
+    }
+    return true;
+}
+
+const UploadRingStats* D3D11RenderSystem::GetUploadStats(UploadKind::E kind) const {
+    // Constants are discarded instead without D3D11.1.
+    if (kind == UploadKind::CONSTANT && !_context1) return nullptr;
+    return &_uploadRings[kind].GetStats();
+}
+
+CommandList* D3D11RenderSystem::CreateCommandList() {
+    ID3D11DeviceContext *deferred = nullptr;
+    HRESULT hr = _device->CreateDeferredContext(0, &deferred);
+    if (FAILED(hr)) return nullptr;
+    return new D3D11CommandList(*this, deferred);
+}
+
+void D3D11RenderSystem::Execute(CommandList *const *lists, UINT count) {
+    for (UINT i = 0; i < count; ++i) {
+        assert(&lists[i]->GetOwner() == this && "CommandList belongs to another RenderSystem");
+        D3D11CommandList *list = static_cast<D3D11CommandList*>(lists[i]);
+        assert(list->GetNativeList() && "CommandList not finished");
+
+        _context->ExecuteCommandList(list->GetNativeList(), FALSE);
+        CountDrawCall(list->GetDrawCallCount());
+    }
+
+    // Executing resets the immediate context's state.
+    if (count > 0) BindPipeline(_context);
+}
+
+void D3D11RenderSystem::ClearOn(ID3D11DeviceContext *context, const Vector4f &color) {
+    context->ClearRenderTargetView(_renderTargetView, reinterpret_cast<const float*>(&color));
+    context->ClearDepthStencilView(_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+}
+
+// Command lists draw through here. Deferred contexts can't know when
+// the GPU is done with a frame, they map the shared dynamic buffers
+// instead and every WRITE_DISCARD gets its own copy of the data.
+void D3D11RenderSystem::DrawOn(ID3D11DeviceContext *context, const DrawCommand &command) {
+    assert(command.vertexCount <= kMaxDrawVertices && "DrawCommand too large");
+    assert(command.indexCount <= kMaxDrawIndices && "DrawCommand too large");
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    DEBUG_HR(context->Map(_constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+    memcpy(mapped.pData, &command.transform, sizeof(command.transform));
+    context->Unmap(_constantBuffer, 0);
+
+    DEBUG_HR(context->Map(_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+    memcpy(mapped.pData, command.vertices, command.vertexCount * sizeof(Vertex));
+    context->Unmap(_vertexBuffer, 0);
+
+    if (command.indices) {
+        DEBUG_HR(context->Map(_indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+        memcpy(mapped.pData, command.indices, command.indexCount * sizeof(UINT));
+        context->Unmap(_indexBuffer, 0);
+        context->DrawIndexed(command.indexCount, 0, 0);
+    } else {
+        context->Draw(command.vertexCount, 0);
+    }
+}
+
+void D3D11RenderSystem::Present() {
+    FenceFrame();
+
+    if (_swapChain) {
+        DEBUG_HR(_swapChain->Present(_syncInterval, 0));
+    } else {
+        // Nothing to show, but make sure the frame's work gets done.
+        _context->Flush();
+    }
+
+    // Frees the space of frames the GPU has finished without waiting.
+    while (RetireFrame(false)) { }
+
+    EndFrameCounters();
+}
+
+void D3D11RenderSystem::FreeResources() {
+    ReleaseCom(_context1);
+    for (UINT i = 0; i < kFramesInFlight; ++i) {
+        ReleaseCom(_frameQueries[i]);
+    }
+    for (UINT i = 0; i < UploadKind::COUNT; ++i) {
+        ReleaseCom(_uploadBuffers[i]);
+    }
+    ReleaseCom(_indexBuffer);
+    ReleaseCom(_vertexBuffer);
+    ReleaseCom(_constantBuffer);
+    _rasterizerState = nullptr;
+    _stateCache.Release();
+    ReleaseCom(_inputLayout);
+    ReleaseCom(_pixelShader);
+    ReleaseCom(_vertexShader);
+    ReleaseCom(_depthStencilView);
+    ReleaseCom(_swapChain);
+    ReleaseCom(_renderTargetView);
+    ReleaseCom(_device);
+    ReleaseCom(_context);    
+}
+
+Error::E D3D11RenderSystem::CreateDeviceAndContext(D3D_DRIVER_TYPE driverType) {
+    assert(!_device);
+    // Command lists are recorded on deferred contexts from job threads.
+    UINT flags = 0;
+    
+#if defined(DEBUG) | defined(_DEBUG)
+    flags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif 
+
+    DEBUG_HR(D3D11CreateDevice(
+        NULL,
+        driverType,
+        NULL,
+        flags,
+        kFeatureLevels,
+        ARRAY_SIZE(kFeatureLevels),
+        D3D11_SDK_VERSION,
+        &_device,
+        &_featureLevel,
+        &_context
+    ));
+
+    if (_featureLevel != D3D_FEATURE_LEVEL_11_0) {
+        return Error::RENDER_FEATURE_LEVEL_TOO_LOW;
+    }
+
+    UINT formatSupport;
+    DEBUG_HR(_device->CheckFormatSupport(kDefaultFormat, &formatSupport));
+
+    if (!(formatSupport & D3D11_FORMAT_SUPPORT_BUFFER)) {
+        return Error::RENDER_FORMAT_NOT_SUPPORTED;
+    }
+
+    DEBUG_HR(_device->CheckMultisampleQualityLevels(kDefaultFormat, 4, &_msaaQualityLevel));
+    assert(_msaaQualityLevel > 0);
+
+    _stateCache.Initialize(_device);
+
+    return Error::OK;
+}
+
+Error::E D3D11RenderSystem::CreateSwapChain(const Window &window) {
+    assert(_device);
+     _swapDesc = kDefaultSwapDesc;
+
+    _swapDesc.SampleDesc.Count = 4;
+    _swapDesc.SampleDesc.Quality = _msaaQualityLevel - 1;
+    _swapDesc.OutputWindow = window.GetHandle();
+    _swapDesc.BufferDesc.Width = window.GetWidth();
+    _swapDesc.BufferDesc.Height = window.GetHeight();
+
+    IDXGIFactory *factory = FactoryFromDevice(_device);
+
+    DEBUG_HR(factory->CreateSwapChain(_device, &_swapDesc, &_swapChain));
+    ReleaseCom(factory);
+    return Error::OK;
+}
+
+// Headless replacement for the swapchain's backbuffer.
+Error::E D3D11RenderSystem::CreateOffscreenTarget(UINT width, UINT height) {
+    assert(_device);
+    _swapDesc = kDefaultSwapDesc;
+    _swapDesc.BufferDesc.Width = width;
+    _swapDesc.BufferDesc.Height = height;
+
+    D3D11_TEXTURE2D_DESC td;
+    td.Width = width;
+    td.Height = height;
+    td.MipLevels = 1;
+    td.ArraySize = 1;
+    td.Format = kDefaultFormat;
+    td.SampleDesc = _swapDesc.SampleDesc;
+    td.Usage = D3D11_USAGE_DEFAULT;
+    td.BindFlags = D3D11_BIND_RENDER_TARGET;
+    td.CPUAccessFlags = 0;
+    td.MiscFlags = 0;
+
+    ID3D11Texture2D *target;
+    if (FAILED(_device->CreateTexture2D(&td, NULL, &target))) {
+        return Error::RENDER_INIT_FAIL;
+    }
+    DEBUG_HR(_device->CreateRenderTargetView(target, NULL, &_renderTargetView));
+    ReleaseCom(target);
+
+    return Error::OK;
+}
+
+// Compiles the built-in shaders and creates the buffers Draw() streams
+// through.
+Error::E D3D11RenderSystem::CreateDrawResources() {
+    assert(_device);
+
+    ID3DBlob *vsCode = nullptr;
+    ID3DBlob *psCode = nullptr;
+    HRESULT hr = D3DCompile(kDrawShader, sizeof(kDrawShader) - 1, "DrawShader", NULL, NULL,
+                            "VSMain", "vs_4_0", 0, 0, &vsCode, NULL);
+    if (SUCCEEDED(hr)) {
+        hr = D3DCompile(kDrawShader, sizeof(kDrawShader) - 1, "DrawShader", NULL, NULL,
+                        "PSMain", "ps_4_0", 0, 0, &psCode, NULL);
+    }
+    if (SUCCEEDED(hr)) {
+        hr = _device->CreateVertexShader(vsCode->GetBufferPointer(), vsCode->GetBufferSize(), NULL, &_vertexShader);
+    }
+    if (SUCCEEDED(hr)) {
+        hr = _device->CreatePixelShader(psCode->GetBufferPointer(), psCode->GetBufferSize(), NULL, &_pixelShader);
+    }
+    if (SUCCEEDED(hr)) {
+        D3D11_INPUT_ELEMENT_DESC layout[DrawVertexLayout::kElementCount];
+        DrawVertexLayout::GetInputLayout(layout);
+        hr = _device->CreateInputLayout(layout, DrawVertexLayout::kElementCount,
+                                        vsCode->GetBufferPointer(), vsCode->GetBufferSize(), &_inputLayout);
+    }
+    ReleaseCom(vsCode);
+    ReleaseCom(psCode);
+    if (FAILED(hr)) return Error::RENDER_INIT_FAIL;
+
+    D3D11_BUFFER_DESC bd;
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bd.MiscFlags = 0;
+    bd.StructureByteStride = 0;
+
+    bd.ByteWidth = sizeof(Mat4x4);
+    bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    if (FAILED(_device->CreateBuffer(&bd, NULL, &_constantBuffer))) return Error::RENDER_INIT_FAIL;
+
+    bd.ByteWidth = kMaxDrawVertices * sizeof(Vertex);
+    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    if (FAILED(_device->CreateBuffer(&bd, NULL, &_vertexBuffer))) return Error::RENDER_INIT_FAIL;
+
+    bd.ByteWidth = kMaxDrawIndices * sizeof(UINT);
+    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    if (FAILED(_device->CreateBuffer(&bd, NULL, &_indexBuffer))) return Error::RENDER_INIT_FAIL;
+
+    // Both windings are drawn, like the software rasterizer does.
+    D3D11_RASTERIZER_DESC rd;
+    memset(&rd, 0, sizeof(rd));
+    rd.FillMode = D3D11_FILL_SOLID;
+    rd.CullMode = D3D11_CULL_NONE;
+    rd.DepthClipEnable = TRUE;
+    rd.MultisampleEnable = TRUE;
+    _rasterizerState = _stateCache.GetRasterizerState(rd);
+    if (!_rasterizerState) return Error::RENDER_INIT_FAIL;
+
+    return CreateUploadResources();
+}
+
+// The rings, the queries fencing their frames and, when constants can
+// be bound at an offset, the D3D11.1 context to bind them with.
+Error::E D3D11RenderSystem::CreateUploadResources() {
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+    memset(&options, 0, sizeof(options));
+    _device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+    if (options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer) {
+        _context->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&_context1));
+    }
+
+    D3D11_BUFFER_DESC bd;
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bd.MiscFlags = 0;
+    bd.StructureByteStride = 0;
+
+    for (UINT i = 0; i < UploadKind::COUNT; ++i) {
+        if (i == UploadKind::CONSTANT && !_context1) continue;
+
+        bd.ByteWidth = kUploadCapacity[i];
+        bd.BindFlags = kUploadBindFlags[i];
+        if (FAILED(_device->CreateBuffer(&bd, NULL, &_uploadBuffers[i]))) return Error::RENDER_INIT_FAIL;
+        _uploadRings[i].Initialize(kUploadCapacity[i]);
+    }
+
+    D3D11_QUERY_DESC qd;
+    qd.Query = D3D11_QUERY_EVENT;
+    qd.MiscFlags = 0;
+    for (UINT i = 0; i < kFramesInFlight; ++i) {
+        if (FAILED(_device->CreateQuery(&qd, &_frameQueries[i]))) return Error::RENDER_INIT_FAIL;
+    }
+
+    return Error::OK;
+}
+
+// Binds everything Draw() needs, on the immediate context and at the
+// start of every deferred one. Only the immediate context draws from
+// the upload rings.
+void D3D11RenderSystem::BindPipeline(ID3D11DeviceContext *context) {
+    bool immediate = context == _context;
+    ID3D11Buffer *vertexBuffer = immediate ? _uploadBuffers[UploadKind::VERTEX] : _vertexBuffer;
+    ID3D11Buffer *indexBuffer = immediate ? _uploadBuffers[UploadKind::INDEX] : _indexBuffer;
+    UINT stride = sizeof(Vertex);
+    UINT offset = 0;
+    context->IASetInputLayout(_inputLayout);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    context->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+    context->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+    context->VSSetShader(_vertexShader, NULL, 0);
+    context->VSSetConstantBuffers(0, 1, &_constantBuffer);
+    context->PSSetShader(_pixelShader, NULL, 0);
+    context->RSSetState(_rasterizerState);
+    context->OMSetRenderTargets(1, &_renderTargetView, _depthStencilView);
+
+    D3D11_VIEWPORT vp;
+    vp.TopLeftX = 0;
+    vp.TopLeftY = 0;
+    vp.Width = (float)_swapDesc.BufferDesc.Width;
+    vp.Height = (float)_swapDesc.BufferDesc.Height;
+    vp.MinDepth = 0.0f;
+    vp.MaxDepth = 1.0f;
+
+    context->RSSetViewports(1, &vp);
+}
+
+D3D11CommandList::D3D11CommandList(D3D11RenderSystem &owner, ID3D11DeviceContext *deferred)
+ : CommandList(owner, 0) {
+    _system = &owner;
+    _deferred = deferred;
+    _list = nullptr;
+}
+
+D3D11CommandList::~D3D11CommandList() {
+    ReleaseCom(_list);
+    ReleaseCom(_deferred);
+}
+
+void D3D11CommandList::OnBegin() {
+    ReleaseCom(_list);
+    _system->BindPipeline(_deferred);
+}
+
+void D3D11CommandList::OnEnd() {
+    DEBUG_HR(_deferred->FinishCommandList(FALSE, &_list));
+}
+
+void D3D11CommandList::OnClear(const Vector4f &color) {
+    _system->ClearOn(_deferred, color);
+}
+
+void D3D11CommandList::OnDraw(const DrawCommand &command, bool transient) {
+    // The data is copied while mapping, transient or not.
+    _system->DrawOn(_deferred, command);
+}
+
+Error::E D3D11RenderSystem::CreateDepthStencilBuffer() {
+    D3D11_TEXTURE2D_DESC bd;
+    bd.Width = _swapDesc.BufferDesc.Width;
+    bd.Height = _swapDesc.BufferDesc.Height;
+    bd.MipLevels = 1;
+    bd.ArraySize = 1;
+    bd.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    bd.SampleDesc = _swapDesc.SampleDesc;
+    bd.Usage = D3D11_USAGE_DEFAULT;
+    bd.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+    bd.CPUAccessFlags = 0;
+    bd.MiscFlags  = 0;
+
+    ID3D11Texture2D *buffer;
+    DEBUG_HR(_device->CreateTexture2D(&bd, NULL, &buffer));
+    DEBUG_HR(_device->CreateDepthStencilView(buffer, 0, &_depthStencilView));
+    ReleaseCom(buffer);
+
+    return Error::OK;
+}
+
+} // namespace dx
+
+static IDXGIFactory* FactoryFromDevice(ID3D11Device *device) {
+    assert(device);
+
+    IDXGIDevice *dxgiDevice = nullptr;
+    DEBUG_HR(device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice)));
+
+    IDXGIAdapter *dxgiAdapter = nullptr;
+    DEBUG_HR(dxgiDevice->GetParent(__uuidof(IDXGIAdapter), reinterpret_cast<void**>(&dxgiAdapter)));
+
+    IDXGIFactory *dxgiFactory = nullptr;
+    DEBUG_HR(dxgiAdapter->GetParent(__uuidof(IDXGIFactory), reinterpret_cast<void**>(&dxgiFactory)));
+
+    ReleaseCom(dxgiAdapter);
+    ReleaseCom(dxgiDevice);
+    return dxgiFactory;
+}
\ No newline at end of file
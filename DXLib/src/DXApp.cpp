@@ -1,48 +1,265 @@
 #include <DXApp.h>
+#include <NullRenderSystem.h>
+#include <SoftwareRenderSystem.h>
+#include <Profiler.h>
+
+#include <cassert>
+#include <iostream>
+
+static const size_t kDefaultFrameArenaSize = 1024 * 1024;
+
+static double SecondsSince(unsigned long long startTicks) {
+    return (dx::Timer::GetRawTicks() - startTicks) * dx::Timer::GetSecondsPerTick();
+}
 
 namespace dx {
 
 DXApp::DXApp(UINT width, UINT height, const std::string &title) 
  : Window(width, height, title) {
+    _fixedStep = 0.0;
+    _maxTicksPerFrame = 0;
+    _accumulator = 0.0;
+    _jobWorkers = 0;
+    _pinJobWorkers = false;
+    _isRunning = false;
+    _fps = 0.0f;
+    _pipelined = false;
+    _updateRequested = false;
+    _updateDone = false;
+    _updateQuit = false;
+    _updateAlpha = 1.0f;
+    _updateSeconds = 0.0;
+    _headlessFrames = 0;
+    _headlessDelta = 0.0;
+    _renderer = nullptr;
+    _renderBackend = RenderBackend::D3D11;
+    _isReplaying = false;
+    _frameArenaSize = kDefaultFrameArenaSize;
+    _telemetryInterval = 100;
 
+    _frameCounter = Telemetry::Counter("app.frames");
+    _frameTimeGauge = Telemetry::Gauge("app.frameTimeMs");
+    _fpsGauge = Telemetry::Gauge("app.fps");
+    _jobQueueGauge = Telemetry::Gauge("jobs.queueDepth");
+    _drawCallGauge = Telemetry::Gauge("render.drawCalls");
+    _uploadBytesGauge = Telemetry::Gauge("render.uploadBytes");
+    _uploadStallCounter = Telemetry::Counter("render.uploadStalls");
+    _uploadStalls = 0;
+    _arenaOverflowGauge = Telemetry::Gauge("alloc.frameArenaOverflows");
+    _allocCounter = Telemetry::Counter("alloc.count");
+    _allocBytesGauge = Telemetry::Gauge("alloc.frameBytes");
+    _allocPeakGauge = Telemetry::Gauge("alloc.framePeakBytes");
 }
 
 DXApp::~DXApp() {
-
+    delete _renderer;
 }
 
 Error::E DXApp::Initialize() {
-    Error::E err = Window::Initialize();
-    if (err != Error::OK) return err;
+    assert(!_renderer && "Initialize() called twice");
+    if (!IsHeadless()) {
+        // Replayed events are pushed from the main thread, the message
+        // thread would be a second producer on the event queue.
+        if (_isReplaying && IsThreadedMessagePump()) return Error::INVALID_SETTINGS;
 
-    err = _renderer.Initialize(*this);
+        Error::E err = Window::Initialize();
+        if (err != Error::OK) return err;
+    }
 
-    if (err != Error::OK) return err;
+    _renderer = RenderSystem::Create(_renderBackend);
+    Error::E err = _renderer->Initialize(IsHeadless() ? nullptr : this, GetWidth(), GetHeight(), &_jobs);
+    if (err != Error::OK) {
+        delete _renderer;
+        _renderer = nullptr;
+        return err;
+    }
+
+    _jobs.Initialize(_jobWorkers, _pinJobWorkers);
+
+    _frameArena.Initialize(_frameArenaSize);
+    _doubleFrameArena.Initialize(_frameArenaSize);
 
     return Error::OK;
 }
 
 void DXApp::Run() {
-    Window::SetVisible(true);
+    if (!IsHeadless()) {
+        Window::SetVisible(true);
+    }
     
     _isRunning = true;
 
     _appTimer.Start();
 
+    _simTimer.Start();
+    _accumulator = 0.0;
+
     _frameTime = 0;
     _frames = _lastFrames = 0;
 
+    Profiler::SetThreadName("Main");
+    _pacer.Reset();
+    _frameStats.Reset();
+
+    if (!_recordPath.empty()) {
+        _input.Clear();
+    }
+
+    if (!_telemetryPath.empty()) {
+        if (Telemetry::StartPublishing(_telemetryPath, _telemetryInterval) != Error::OK) {
+            std::cerr << "Failed to publish telemetry to " << _telemetryPath << std::endl;
+        }
+    }
+
+    UINT frame = 0;
+    unsigned long long frameStart = Timer::GetRawTicks();
+    bool firstFrame = true;
+    bool firstUpdate = true;
+    if (_pipelined) {
+        StartUpdateThread();
+    }
+
     while (_isRunning) {
-        _appTimer.Tick();
-        CalculateFPS();
-        
-        // Handle Windows messages.
-        HandleMessages();
+        Profiler::BeginFrame();
+        AllocTracker::BeginFrame();
+        {
+            DX_PROFILE_SCOPE("Frame");
+            // Headless runs simulate time so every run sees the same deltas.
+            if (IsHeadless()) {
+                _appTimer.Advance(_headlessDelta);
+            } else {
+                _appTimer.Tick();
+            }
+            CalculateFPS();
+
+            if (!_pipelined) {
+                ResetFrameArenas();
+            }
+
+            // Wall time, the first frame has no previous one to measure.
+            unsigned long long now = Timer::GetRawTicks();
+            if (!firstFrame) {
+                double frameSeconds = (now - frameStart) * Timer::GetSecondsPerTick();
+                _frameStats.Record(FrameZone::FRAME, frameSeconds);
+                UpdateTelemetry(frameSeconds);
+            }
+            frameStart = now;
+            firstFrame = false;
+
+            // Handle Windows messages.
+            {
+                DX_PROFILE_SCOPE("HandleMessages");
+                HandleMessages();
+            }
+
+            // Pipelined updates may be running, their events are handled
+            // at the sync point instead.
+            if (!_pipelined) {
+                DispatchEvents(frame);
+            }
+
+            float alpha;
+            unsigned long long start;
+            if (_pipelined) {
+                // Hand over the state of the update that ran alongside
+                // the previous frame, then start on the next one.
+                if (!firstUpdate) {
+                    DX_PROFILE_SCOPE("WaitForUpdate");
+                    WaitForUpdate();
+                    _frameStats.Record(FrameZone::UPDATE, _updateSeconds);
+                }
+                firstUpdate = false;
+
+                ResetFrameArenas();
+                DispatchEvents(frame);
+                OnSyncFrame();
+                alpha = _updateAlpha;
+
+                _updateTimer = _appTimer;
+                KickUpdate();
+            } else {
+                start = Timer::GetRawTicks();
+                {
+                    DX_PROFILE_SCOPE("OnUpdate");
+                    alpha = StepSimulation(_appTimer);
+                }
+                _frameStats.Record(FrameZone::UPDATE, SecondsSince(start));
+            }
 
-        OnUpdate(_appTimer);
-        _renderer.Clear(Vector4f::kZero);
-        OnRender(_renderer, _appTimer);
-        _renderer.Present();
+            start = Timer::GetRawTicks();
+            {
+                DX_PROFILE_SCOPE("OnRender");
+                _renderer->Clear(Vector4f::kZero);
+                OnRender(*_renderer, _appTimer, alpha);
+            }
+            _frameStats.Record(FrameZone::RENDER, SecondsSince(start));
+
+            start = Timer::GetRawTicks();
+            {
+                DX_PROFILE_SCOPE("Present");
+                _renderer->Present();
+            }
+            _frameStats.Record(FrameZone::PRESENT, SecondsSince(start));
+            _frameStats.EndFrame();
+
+            {
+                DX_PROFILE_SCOPE("Pacing");
+                _pacer.Wait();
+            }
+        }
+        AllocTracker::EndFrame();
+        Profiler::EndFrame();
+
+        ++frame;
+        if (IsHeadless() && frame >= _headlessFrames) {
+            _isRunning = false;
+        }
+    }
+
+    if (_pipelined) {
+        StopUpdateThread();
+    }
+
+    if (!_telemetryPath.empty()) {
+        Telemetry::StopPublishing();
+    }
+
+    if (!_recordPath.empty()) {
+        if (_input.Save(_recordPath) != Error::OK) {
+            std::cerr << "Failed to save input recording to " << _recordPath << std::endl;
+        }
+    }
+
+    if (IsHeadless()) {
+        _frameStats.Print(std::cout);
+        std::cout << "Frame arena high-water mark: "
+                  << _frameArena.GetHighWaterMark() / 1024 << "KB, double-buffered: "
+                  << _doubleFrameArena.GetHighWaterMark() / 1024 << "KB" << std::endl;
+
+        // Identical input has to produce identical pixels.
+        if (_renderer->GetBackend() == RenderBackend::SOFTWARE) {
+            const SoftwareRenderer &software = static_cast<SoftwareRenderSystem*>(_renderer)->GetSoftwareRenderer();
+            std::cout << "Last frame hash: " << std::hex << software.HashColorBuffer() << std::dec << std::endl;
+        }
+
+        if (_renderer->GetBackend() == RenderBackend::NULL_DEVICE) {
+            const NullRenderStats &totals = static_cast<NullRenderSystem*>(_renderer)->GetTotals();
+            std::cout << "Submitted " << totals.draws << " draws, " << totals.vertices << " vertices, "
+                      << totals.indices << " indices, "
+                      << (totals.presents ? totals.submitSeconds * 1000.0 / totals.presents : 0.0)
+                      << "ms per frame" << std::endl;
+        }
+
+        if (AllocTracker::IsEnabled()) {
+            const AllocFrameStats &allocs = AllocTracker::GetLastFrame();
+            std::cout << "Heap allocations: " << AllocTracker::GetTotalCount() << " total, "
+                      << allocs.count << " (" << allocs.bytes << " bytes) in the last frame, peak "
+                      << allocs.peakBytes / 1024 << "KB live" << std::endl;
+            for (size_t i = 0; i < allocs.tags.size(); ++i) {
+                std::cout << "    " << allocs.tags[i].name << ": " << allocs.tags[i].count
+                          << " (" << allocs.tags[i].bytes << " bytes)" << std::endl;
+            }
+        }
     }
 }
 
@@ -50,6 +267,123 @@ void DXApp::Quit() {
     _isRunning = false;
 }
 
+void DXApp::SetFixedTimestep(double ticksPerSecond, UINT maxTicksPerFrame) {
+    assert(ticksPerSecond > 0.0 && maxTicksPerFrame > 0);
+    _fixedStep = 1.0 / ticksPerSecond;
+    _maxTicksPerFrame = maxTicksPerFrame;
+    _accumulator = 0.0;
+}
+
+void DXApp::SetVariableTimestep() {
+    _fixedStep = 0.0;
+    _accumulator = 0.0;
+}
+
+void DXApp::SetPipelined(bool value) {
+    assert(!_isRunning && "Call SetPipelined() before Run()");
+    _pipelined = value;
+}
+
+void DXApp::SetHeadless(UINT frameCount, double frameDelta) {
+    assert(frameCount > 0 && frameDelta > 0.0);
+    assert(!_renderer && "Call SetHeadless() before Initialize()");
+    _headlessFrames = frameCount;
+    _headlessDelta = frameDelta;
+}
+
+void DXApp::SetRenderBackend(RenderBackend::E backend) {
+    assert(!_renderer && "Call SetRenderBackend() before Initialize()");
+    _renderBackend = backend;
+}
+
+void DXApp::RecordInput(const std::string &path) {
+    _recordPath = path;
+    _isReplaying = false;
+}
+
+Error::E DXApp::ReplayInput(const std::string &path) {
+    _recordPath.clear();
+    Error::E err = _input.Load(path);
+    _isReplaying = (err == Error::OK);
+    return err;
+}
+
+void DXApp::SetFrameArenaSize(size_t bytes) {
+    assert(_frameArena.GetCapacity() == 0 && "Call SetFrameArenaSize() before Initialize()");
+    _frameArenaSize = bytes;
+}
+
+void DXApp::SetJobWorkers(unsigned int workerCount, bool pinThreads) {
+    assert(!_jobs.IsInitialized() && "Call SetJobWorkers() before Initialize()");
+    _jobWorkers = workerCount;
+    _pinJobWorkers = pinThreads;
+}
+
+void DXApp::SetTargetFPS(double fps) {
+    _pacer.SetTargetFPS(fps);
+}
+
+void DXApp::SetFrameBudget(double seconds) {
+    _pacer.SetFrameBudget(seconds);
+}
+
+float DXApp::StepSimulation(const Timer &frameTimer) {
+    if (!IsFixedTimestep()) {
+        OnUpdate(_jobs, frameTimer);
+        return 1.0f;
+    }
+
+    _accumulator += frameTimer.GetDeltaSeconds();
+
+    // Clamp to avoid the spiral of death, when updates can't keep up
+    // the simulation slows down instead of stalling the renderer.
+    const double maxAccumulated = _fixedStep * _maxTicksPerFrame;
+    if (_accumulator > maxAccumulated) {
+        _accumulator = maxAccumulated;
+    }
+
+    while (_accumulator >= _fixedStep) {
+        _simTimer.Advance(_fixedStep);
+        OnUpdate(_jobs, _simTimer);
+        _accumulator -= _fixedStep;
+    }
+
+    return static_cast<float>(_accumulator / _fixedStep);
+}
+
+void DXApp::SetTelemetryFile(const std::string &path, unsigned int intervalMs) {
+    _telemetryPath = path;
+    _telemetryInterval = intervalMs;
+}
+
+// Covers the previous frame, called once its total time is known.
+void DXApp::UpdateTelemetry(double frameSeconds) {
+    _frameCounter.Increment();
+    _frameTimeGauge.Set(frameSeconds * 1000.0);
+    _fpsGauge.Set(_fps.load(std::memory_order_relaxed));
+    _jobQueueGauge.Set(_jobs.GetQueueDepth());
+    _drawCallGauge.Set(_renderer->GetDrawCallCount());
+
+    // Summed over the rings, stalls since startup.
+    double uploadBytes = 0.0;
+    unsigned long long uploadStalls = 0;
+    for (UINT kind = 0; kind < UploadKind::COUNT; ++kind) {
+        const UploadRingStats *upload = _renderer->GetUploadStats(static_cast<UploadKind::E>(kind));
+        if (!upload) continue;
+        uploadBytes += upload->frameBytes;
+        uploadStalls += upload->stalls;
+    }
+    _uploadBytesGauge.Set(uploadBytes);
+    _uploadStallCounter.Add(static_cast<long long>(uploadStalls - _uploadStalls));
+    _uploadStalls = uploadStalls;
+    _arenaOverflowGauge.Set(static_cast<double>(_frameArena.GetOverflowCount()));
+
+    const AllocFrameStats &allocs = AllocTracker::GetLastFrame();
+    _allocCounter.Add(static_cast<long long>(allocs.count));
+    _allocBytesGauge.Set(static_cast<double>(allocs.bytes));
+    _allocPeakGauge.Set(static_cast<double>(allocs.peakBytes));
+}
+
 void DXApp::CalculateFPS() {
     ++_frames;
     _frameTime += _appTimer.GetDeltaSeconds();
@@ -60,8 +394,107 @@ void DXApp::CalculateFPS() {
         _frameTime = 0.0;
     }
 
-    _fps = static_cast<float>(_frames +_lastFrames * (1.0 - _frameTime));
+    _fps.store(static_cast<float>(_frames +_lastFrames * (1.0 - _frameTime)), std::memory_order_relaxed);
+
+}
+
+void DXApp::StartUpdateThread() {
+    _updateRequested = false;
+    _updateDone = false;
+    _updateQuit = false;
+    _updateAlpha = 1.0f;
+    _updateSeconds = 0.0;
+    _updateThread = std::thread(&DXApp::UpdateThreadMain, this);
+}
+
+void DXApp::StopUpdateThread() {
+    {
+        std::unique_lock<std::mutex> lock(_updateMutex);
+        while (_updateRequested && !_updateDone) {
+            _updateSignal.wait(lock);
+        }
+        _updateQuit = true;
+    }
+    _updateSignal.notify_all();
+    _updateThread.join();
+}
+
+void DXApp::KickUpdate() {
+    {
+        std::lock_guard<std::mutex> lock(_updateMutex);
+        _updateDone = false;
+        _updateRequested = true;
+    }
+    _updateSignal.notify_all();
+}
+
+void DXApp::WaitForUpdate() {
+    std::unique_lock<std::mutex> lock(_updateMutex);
+    while (!_updateDone) {
+        _updateSignal.wait(lock);
+    }
+}
+
+void DXApp::UpdateThreadMain() {
+    Profiler::SetThreadName("Update");
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_updateMutex);
+            while (!_updateRequested && !_updateQuit) {
+                _updateSignal.wait(lock);
+            }
+            if (_updateQuit) return;
+            _updateRequested = false;
+        }
+
+        unsigned long long start = Timer::GetRawTicks();
+        {
+            DX_PROFILE_SCOPE("OnUpdate");
+            _updateAlpha = StepSimulation(_updateTimer);
+        }
+        _updateSeconds = SecondsSince(start);
+
+        {
+            std::lock_guard<std::mutex> lock(_updateMutex);
+            _updateDone = true;
+        }
+        _updateSignal.notify_all();
+    }
+}
+
+void DXApp::DispatchEvents(UINT frame) {
+    DX_PROFILE_SCOPE("DispatchEvents");
+
+    // Replayed events go through the queue like live ones.
+    if (_isReplaying) {
+        const InputRecord *records;
+        size_t count = _input.GetFrame(frame, records);
+        for (size_t i = 0; i < count; ++i) {
+            Event event = records[i].event;
+            event.timestamp = Timer::GetRawTicks();
+            PushEvent(event);
+        }
+    }
+
+    const bool recording = !_recordPath.empty();
+    _input.SetFrame(frame);
+
+    Event events[64];
+    unsigned int count;
+    while ((count = PollEvents(events, ARRAY_SIZE(events))) > 0) {
+        for (unsigned int i = 0; i < count; ++i) {
+            if (recording) {
+                _input.Add(events[i]);
+            }
+            DispatchEvent(events[i]);
+        }
+    }
+}
 
+void DXApp::ResetFrameArenas() {
+    _frameArena.Reset();
+    _doubleFrameArena.Flip();
 }
 
 } // namespace dx
\ No newline at end of file
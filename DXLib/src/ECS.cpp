@@ -0,0 +1,409 @@
+#include <ECS.h>
+#include <Profiler.h>
+
+static const unsigned int kChunkHeaderSize = 64;
+static const unsigned int kMaxComponentAlignment = 16;
+
+static std::mutex registryMutex;
+static dx::ComponentInfo componentInfos[dx::kMaxComponentTypes];
+static unsigned int componentCount = 0;
+
+static unsigned int AlignUp(unsigned int value, unsigned int alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Pending entities from a CommandBuffer have generation 0, which no
+// live entity ever has.
+static bool IsPending(dx::Entity entity) {
+    return !entity.IsNull() && entity.GetGeneration() == 0;
+}
+
+namespace dx {
+
+ComponentId ComponentRegistry::Register(const ComponentInfo &info, std::atomic<int> &id) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    int existing = id.load(std::memory_order_relaxed);
+    if (existing >= 0) return static_cast<ComponentId>(existing);
+
+    assert(componentCount < kMaxComponentTypes && "Too many component types");
+    assert(info.alignment <= kMaxComponentAlignment && "Component alignment too large");
+
+    componentInfos[componentCount] = info;
+    id.store(static_cast<int>(componentCount), std::memory_order_release);
+    return componentCount++;
+}
+
+const ComponentInfo& ComponentRegistry::GetInfo(ComponentId id) {
+    assert(id < componentCount);
+    return componentInfos[id];
+}
+
+Archetype::Archetype(ComponentMask mask) {
+    _mask = mask;
+    _entityCount = 0;
+    memset(_addEdges, 0, sizeof(_addEdges));
+    memset(_removeEdges, 0, sizeof(_removeEdges));
+
+    unsigned int rowSize = sizeof(Entity);
+    for (ComponentId id = 0; id < kMaxComponentTypes; ++id) {
+        _columns[id] = -1;
+        if (mask & (1ULL << id)) {
+            _columns[id] = static_cast<int>(_ids.size());
+            _ids.push_back(id);
+            _sizes.push_back(static_cast<unsigned int>(ComponentRegistry::GetInfo(id).size));
+            rowSize += _sizes.back();
+        }
+    }
+
+    // Start from the unpadded estimate and shrink until the aligned
+    // arrays fit.
+    _capacity = (kChunkSize - kChunkHeaderSize) / rowSize;
+    _offsets.resize(_ids.size());
+    for (;;) {
+        assert(_capacity > 0 && "Components don't fit into a chunk");
+
+        unsigned int offset = kChunkHeaderSize;
+        _entityOffset = offset;
+        offset += sizeof(Entity) * _capacity;
+
+        for (size_t i = 0; i < _ids.size(); ++i) {
+            unsigned int alignment = static_cast<unsigned int>(ComponentRegistry::GetInfo(_ids[i]).alignment);
+            offset = AlignUp(offset, alignment);
+            _offsets[i] = offset;
+            offset += _sizes[i] * _capacity;
+        }
+
+        if (offset <= kChunkSize) break;
+        --_capacity;
+    }
+}
+
+CommandBuffer::CommandBuffer() {
+    _pendingCount = 0;
+}
+
+Entity CommandBuffer::CreateEntity() {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Pending index 0 would be the null handle.
+    Entity entity = SlotHandle::Make(++_pendingCount, 0);
+    Command command = { CREATE, entity, 0, 0 };
+    _commands.push_back(command);
+    return entity;
+}
+
+void CommandBuffer::DestroyEntity(Entity entity) {
+    Record(DESTROY, entity, 0, nullptr, 0);
+}
+
+void CommandBuffer::Record(CommandType type, Entity entity, ComponentId component,
+                           const void *data, size_t size) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Command command = { type, entity, component, 0 };
+    if (size > 0) {
+        command.dataOffset = static_cast<unsigned int>(AlignUp(static_cast<unsigned int>(_data.size()), kMaxComponentAlignment));
+        _data.resize(command.dataOffset + size);
+        memcpy(&_data[command.dataOffset], data, size);
+    }
+    _commands.push_back(command);
+}
+
+void CommandBuffer::Playback(World &world, std::vector<Entity> *created) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Real handles of pending entities, by pending index.
+    std::vector<Entity> pending(_pendingCount + 1, SlotHandle::Null());
+
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        const Command &command = _commands[i];
+
+        Entity entity = command.entity;
+        if (IsPending(entity)) {
+            // Pending handles only mean something to the buffer that
+            // handed them out.
+            if (entity.GetIndex() > _pendingCount) {
+                assert(false && "Pending entity of another CommandBuffer");
+                continue;
+            }
+            entity = pending[entity.GetIndex()];
+        }
+
+        switch (command.type) {
+        case CREATE:
+            pending[command.entity.GetIndex()] = world.CreateEntity();
+            if (created) created->push_back(pending[command.entity.GetIndex()]);
+            break;
+        case DESTROY:
+            world.DestroyEntity(entity);
+            break;
+        case ADD: {
+            void *component = world.AddComponent(entity, command.component);
+            if (component) {
+                memcpy(component, &_data[command.dataOffset], ComponentRegistry::GetInfo(command.component).size);
+            }
+            break;
+        }
+        case REMOVE:
+            world.RemoveComponent(entity, command.component);
+            break;
+        }
+    }
+
+    _commands.clear();
+    _data.clear();
+    _pendingCount = 0;
+}
+
+World::World() : _iterating(0) {
+    _chunkPool.Initialize(kChunkSize, 16);
+}
+
+World::~World() {
+    for (size_t i = 0; i < _archetypes.size(); ++i) {
+        delete _archetypes[i];
+    }
+}
+
+Entity World::CreateEntity() {
+    return CreateEntity(0);
+}
+
+Entity World::CreateEntity(ComponentMask mask) {
+    AssertNotIterating();
+
+    EntityRecord record = { nullptr, nullptr, 0 };
+    Entity entity = _entities.Insert(record);
+
+    Archetype *archetype = GetArchetype(mask);
+    EntityRecord &stored = *_entities.Get(entity);
+    AllocateRow(archetype, entity, stored);
+
+    for (size_t i = 0; i < archetype->_ids.size(); ++i) {
+        char *column = static_cast<char*>(archetype->GetColumn(stored.chunk, archetype->_ids[i]));
+        ComponentRegistry::GetInfo(archetype->_ids[i]).construct(column + stored.row * archetype->_sizes[i]);
+    }
+    return entity;
+}
+
+void World::DestroyEntity(Entity entity) {
+    AssertNotIterating();
+
+    EntityRecord *record = _entities.Get(entity);
+    if (!record) return;
+
+    FreeRow(*record);
+    _entities.Erase(entity);
+}
+
+void* World::AddComponent(Entity entity, ComponentId id) {
+    AssertNotIterating();
+
+    EntityRecord *record = _entities.Get(entity);
+    if (!record) return nullptr;
+
+    Archetype *source = record->archetype;
+    if (!source->Has(id)) {
+        Archetype *target = source->_addEdges[id];
+        if (!target) {
+            target = GetArchetype(source->GetMask() | (1ULL << id));
+            source->_addEdges[id] = target;
+        }
+
+        MoveEntity(entity, *record, target);
+        void *component = GetComponent(entity, id);
+        ComponentRegistry::GetInfo(id).construct(component);
+        return component;
+    }
+
+    return GetComponent(entity, id);
+}
+
+void World::RemoveComponent(Entity entity, ComponentId id) {
+    AssertNotIterating();
+
+    EntityRecord *record = _entities.Get(entity);
+    if (!record || !record->archetype->Has(id)) return;
+
+    Archetype *source = record->archetype;
+    Archetype *target = source->_removeEdges[id];
+    if (!target) {
+        target = GetArchetype(source->GetMask() & ~(1ULL << id));
+        source->_removeEdges[id] = target;
+    }
+
+    MoveEntity(entity, *record, target);
+}
+
+void* World::GetComponent(Entity entity, ComponentId id) const {
+    const EntityRecord *record = _entities.Get(entity);
+    if (!record) return nullptr;
+
+    char *column = static_cast<char*>(record->archetype->GetColumn(record->chunk, id));
+    if (!column) return nullptr;
+    return column + record->row * ComponentRegistry::GetInfo(id).size;
+}
+
+void World::GetChunks(const Query &query, std::vector<ChunkView> &out) const {
+    for (size_t a = 0; a < _archetypes.size(); ++a) {
+        Archetype *archetype = _archetypes[a];
+        if (!query.Matches(archetype->GetMask())) continue;
+
+        const std::vector<Chunk*> &chunks = archetype->GetChunks();
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            out.push_back(ChunkView(archetype, chunks[c]));
+        }
+    }
+}
+
+Archetype* World::GetArchetype(ComponentMask mask) {
+    std::unordered_map<ComponentMask, Archetype*>::iterator it = _archetypeMap.find(mask);
+    if (it != _archetypeMap.end()) return it->second;
+
+    Archetype *archetype = new Archetype(mask);
+    _archetypeMap[mask] = archetype;
+    _archetypes.push_back(archetype);
+    return archetype;
+}
+
+void World::AllocateRow(Archetype *archetype, Entity entity, EntityRecord &record) {
+    std::vector<Chunk*> &chunks = archetype->_chunks;
+    if (chunks.empty() || chunks.back()->count == archetype->GetCapacity()) {
+        Chunk *chunk = static_cast<Chunk*>(_chunkPool.Allocate());
+        chunk->archetype = archetype;
+        chunk->count = 0;
+        chunks.push_back(chunk);
+    }
+
+    Chunk *chunk = chunks.back();
+    record.archetype = archetype;
+    record.chunk = chunk;
+    record.row = chunk->count++;
+    archetype->GetEntities(chunk)[record.row] = entity;
+    ++archetype->_entityCount;
+}
+
+void World::FreeRow(const EntityRecord &record) {
+    Archetype *archetype = record.archetype;
+    Chunk *last = archetype->_chunks.back();
+    unsigned int lastRow = last->count - 1;
+
+    // Keep chunks packed by moving the very last row into the hole.
+    if (last != record.chunk || lastRow != record.row) {
+        for (size_t i = 0; i < archetype->_ids.size(); ++i) {
+            ComponentId id = archetype->_ids[i];
+            unsigned int size = archetype->_sizes[i];
+            char *to = static_cast<char*>(archetype->GetColumn(record.chunk, id)) + record.row * size;
+            char *from = static_cast<char*>(archetype->GetColumn(last, id)) + lastRow * size;
+            memcpy(to, from, size);
+        }
+
+        Entity moved = archetype->GetEntities(last)[lastRow];
+        archetype->GetEntities(record.chunk)[record.row] = moved;
+
+        EntityRecord *movedRecord = _entities.Get(moved);
+        movedRecord->chunk = record.chunk;
+        movedRecord->row = record.row;
+    }
+
+    --archetype->_entityCount;
+    if (--last->count == 0) {
+        archetype->_chunks.pop_back();
+        _chunkPool.Free(last);
+    }
+}
+
+void World::MoveEntity(Entity entity, EntityRecord &record, Archetype *target) {
+    EntityRecord old = record;
+    AllocateRow(target, entity, record);
+
+    // Copy over the components both archetypes have.
+    Archetype *source = old.archetype;
+    for (size_t i = 0; i < source->_ids.size(); ++i) {
+        ComponentId id = source->_ids[i];
+        if (!target->Has(id)) continue;
+
+        unsigned int size = source->_sizes[i];
+        char *to = static_cast<char*>(target->GetColumn(record.chunk, id)) + record.row * size;
+        char *from = static_cast<char*>(source->GetColumn(old.chunk, id)) + old.row * size;
+        memcpy(to, from, size);
+    }
+
+    FreeRow(old);
+}
+
+SystemScheduler::SystemScheduler() {
+    _dirty = false;
+}
+
+SystemScheduler::~SystemScheduler() {
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        delete _commands[i];
+    }
+}
+
+void SystemScheduler::Add(System *system) {
+    _systems.push_back(system);
+    _commands.push_back(new CommandBuffer);
+    _dirty = true;
+}
+
+void SystemScheduler::Run(World &world, JobSystem &jobs, const Timer &timer) {
+    if (_dirty) {
+        BuildWaves();
+    }
+
+    std::vector<SystemJob> data(_systems.size());
+    for (size_t i = 0; i < _systems.size(); ++i) {
+        SystemJob job = { _systems[i], _commands[i], &world, &jobs, &timer };
+        data[i] = job;
+    }
+
+    for (size_t w = 0; w < _waves.size(); ++w) {
+        const std::vector<unsigned int> &wave = _waves[w];
+
+        // The calling thread takes the first system itself.
+        JobCounter counter;
+        for (size_t i = 1; i < wave.size(); ++i) {
+            jobs.Run(MakeJob(&RunSystem, &data[wave[i]], &counter));
+        }
+        RunSystem(&data[wave[0]]);
+        jobs.Wait(counter);
+    }
+
+    DX_PROFILE_SCOPE("CommandPlayback");
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        _commands[i]->Playback(world);
+    }
+}
+
+void SystemScheduler::RunSystem(void *data) {
+    SystemJob *job = static_cast<SystemJob*>(data);
+    DX_PROFILE_SCOPE(job->system->GetName());
+    job->system->Update(*job->world, *job->commands, *job->jobs, *job->timer);
+}
+
+void SystemScheduler::BuildWaves() {
+    _waves.clear();
+    std::vector<unsigned int> waveOf(_systems.size());
+
+    for (unsigned int i = 0; i < _systems.size(); ++i) {
+        unsigned int wave = 0;
+        for (unsigned int j = 0; j < i; ++j) {
+            if (_systems[i]->ConflictsWith(*_systems[j]) && waveOf[j] + 1 > wave) {
+                wave = waveOf[j] + 1;
+            }
+        }
+
+        waveOf[i] = wave;
+        if (wave >= _waves.size()) {
+            _waves.resize(wave + 1);
+        }
+        _waves[wave].push_back(i);
+    }
+
+    _dirty = false;
+}
+
+} // namespace dx
\ No newline at end of file
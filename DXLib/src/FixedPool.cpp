@@ -0,0 +1,145 @@
+#include <FixedPool.h>
+#include <JobSystem.h>
+
+#include <cassert>
+#include <malloc.h>
+
+static const size_t kBlockAlignment = 16;
+
+namespace dx {
+
+FixedPool::FixedPool() {
+    _blockSize = 0;
+    _blocksPerPage = 0;
+    _caches = nullptr;
+    _free = nullptr;
+}
+
+FixedPool::~FixedPool() {
+    Shutdown();
+}
+
+void FixedPool::Initialize(size_t blockSize, size_t blocksPerPage) {
+    assert(_blockSize == 0 && "FixedPool already initialized");
+    assert(blockSize > 0 && blocksPerPage > 0);
+
+    if (blockSize < sizeof(FreeBlock)) blockSize = sizeof(FreeBlock);
+    _blockSize = (blockSize + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+    _blocksPerPage = blocksPerPage;
+
+    _caches = new ThreadCache[JobSystem::kMaxThreads];
+    for (unsigned int i = 0; i < JobSystem::kMaxThreads; ++i) {
+        _caches[i].head = nullptr;
+        _caches[i].count = 0;
+    }
+}
+
+void FixedPool::Shutdown() {
+    for (size_t i = 0; i < _pages.size(); ++i) {
+        _aligned_free(_pages[i]);
+    }
+    _pages.clear();
+
+    delete[] _caches;
+    _caches = nullptr;
+    _free = nullptr;
+    _blockSize = 0;
+}
+
+void* FixedPool::Allocate() {
+    assert(_blockSize > 0 && "FixedPool not initialized");
+
+    int index = JobSystem::GetThreadIndex();
+    if (index < 0) {
+        return AllocateShared();
+    }
+
+    ThreadCache &cache = _caches[index];
+    if (!cache.head) {
+        Refill(cache);
+    }
+
+    FreeBlock *block = cache.head;
+    cache.head = block->next;
+    --cache.count;
+    return block;
+}
+
+void FixedPool::Free(void *memory) {
+    if (!memory) return;
+
+    FreeBlock *block = static_cast<FreeBlock*>(memory);
+    int index = JobSystem::GetThreadIndex();
+    if (index < 0) {
+        FreeShared(block);
+        return;
+    }
+
+    ThreadCache &cache = _caches[index];
+    block->next = cache.head;
+    cache.head = block;
+
+    // Don't let one thread hoard what others allocate.
+    if (++cache.count >= kCacheBatch * 2) {
+        Drain(cache);
+    }
+}
+
+FixedPool::FreeBlock* FixedPool::AllocateShared() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_free) {
+        AddPage();
+    }
+
+    FreeBlock *block = _free;
+    _free = block->next;
+    return block;
+}
+
+void FixedPool::FreeShared(FreeBlock *block) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    block->next = _free;
+    _free = block;
+}
+
+void FixedPool::Refill(ThreadCache &cache) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (cache.count < kCacheBatch) {
+        if (!_free) {
+            AddPage();
+        }
+        FreeBlock *block = _free;
+        _free = block->next;
+
+        block->next = cache.head;
+        cache.head = block;
+        ++cache.count;
+    }
+}
+
+void FixedPool::Drain(ThreadCache &cache) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (cache.count > kCacheBatch) {
+        FreeBlock *block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+
+        block->next = _free;
+        _free = block;
+    }
+}
+
+void FixedPool::AddPage() {
+    char *page = static_cast<char*>(_aligned_malloc(_blockSize * _blocksPerPage, kBlockAlignment));
+    assert(page && "FixedPool out of memory");
+    _pages.push_back(page);
+
+    // Link back to front so blocks are handed out in address order.
+    for (size_t i = _blocksPerPage; i-- > 0;) {
+        FreeBlock *block = reinterpret_cast<FreeBlock*>(page + i * _blockSize);
+        block->next = _free;
+        _free = block;
+    }
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include <FramePacer.h>
+#include <Timer.h>
+
+#include <Windows.h>
+#include <cassert>
+#include <cmath>
+
+// Bounds for the adaptive spin window, in seconds.
+static const double kMinSpinThreshold = 0.0005;
+static const double kMaxSpinThreshold = 0.004;
+
+// How quickly the spin window shrinks back after a bad oversleep.
+static const double kSpinDecay = 0.05;
+
+namespace dx {
+
+FramePacer::FramePacer() {
+    _budget = 0.0;
+    _spinThreshold = 0.002;
+    _timerPeriodSet = false;
+    Reset();
+}
+
+FramePacer::~FramePacer() {
+    if (_timerPeriodSet) {
+        timeEndPeriod(1);
+    }
+}
+
+void FramePacer::SetTargetFPS(double fps) {
+    SetFrameBudget(fps > 0.0 ? 1.0 / fps : 0.0);
+}
+
+void FramePacer::SetFrameBudget(double seconds) {
+    assert(seconds >= 0.0);
+    _budget = seconds;
+
+    // The default scheduler tick is ~15.6ms which is useless for pacing.
+    if (IsEnabled() && !_timerPeriodSet) {
+        _timerPeriodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+    }
+
+    Reset();
+}
+
+void FramePacer::Reset() {
+    unsigned long long now = Timer::GetRawTicks();
+    _lastFrameEnd = now;
+    _deadline = now + static_cast<unsigned long long>(_budget / Timer::GetSecondsPerTick());
+
+    _lastError = 0.0;
+    _maxError = 0.0;
+    _errorSum = 0.0;
+    _frames = 0;
+}
+
+void FramePacer::Wait() {
+    if (!IsEnabled()) return;
+
+    const double secondsPerTick = Timer::GetSecondsPerTick();
+    unsigned long long now = Timer::GetRawTicks();
+
+    // Sleep away the bulk of the remaining time.
+    while (now < _deadline) {
+        double remaining = (_deadline - now) * secondsPerTick;
+        if (remaining <= _spinThreshold) break;
+
+        DWORD millis = static_cast<DWORD>((remaining - _spinThreshold) * 1000.0);
+        if (millis == 0) break;
+
+        unsigned long long before = now;
+        Sleep(millis);
+        now = Timer::GetRawTicks();
+
+        // Widen the spin window to the worst oversleep we've seen,
+        // then let it slowly shrink back.
+        double overshoot = (now - before) * secondsPerTick - millis / 1000.0;
+        if (overshoot > _spinThreshold) {
+            _spinThreshold = overshoot;
+        } else {
+            _spinThreshold += (overshoot - _spinThreshold) * kSpinDecay;
+        }
+        if (_spinThreshold < kMinSpinThreshold) _spinThreshold = kMinSpinThreshold;
+        if (_spinThreshold > kMaxSpinThreshold) _spinThreshold = kMaxSpinThreshold;
+    }
+
+    // Spin for the rest.
+    while (now < _deadline) {
+        YieldProcessor();
+        now = Timer::GetRawTicks();
+    }
+
+    _lastError = (now - _lastFrameEnd) * secondsPerTick - _budget;
+    double absError = std::fabs(_lastError);
+    if (absError > _maxError) _maxError = absError;
+    _errorSum += absError;
+    ++_frames;
+
+    // Schedule from the previous deadline so the average rate stays
+    // exact, unless we fell so far behind that catching up would
+    // just produce a burst of unpaced frames.
+    const unsigned long long budgetTicks =
+        static_cast<unsigned long long>(_budget / secondsPerTick);
+    _deadline += budgetTicks;
+    if (_deadline < now) {
+        _deadline = now + budgetTicks;
+    }
+    _lastFrameEnd = now;
+}
+
+double FramePacer::GetMeanError() const {
+    return (_frames == 0) ? 0.0 : _errorSum / _frames;
+}
+
+} // namespace dx
\ No newline at end of file
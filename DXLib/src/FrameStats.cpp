@@ -0,0 +1,197 @@
+#include <FrameStats.h>
+#include <Timer.h>
+
+#include <cassert>
+#include <cstring>
+#include <intrin.h>
+#include <iomanip>
+
+static const int kLinearBuckets = 16;
+static const int kSubBucketBits = 3;
+static const int kSubBuckets = 1 << kSubBucketBits;
+
+static const char *kZoneNames[dx::FrameZone::COUNT] = {
+    "Frame",
+    "Update",
+    "Render",
+    "Present",
+};
+
+// Index of the most significant set bit, v must be non-zero.
+static int HighestBit(unsigned long long v) {
+    unsigned long index;
+    unsigned long high = static_cast<unsigned long>(v >> 32);
+    if (high != 0) {
+        _BitScanReverse(&index, high);
+        return static_cast<int>(index) + 32;
+    }
+    _BitScanReverse(&index, static_cast<unsigned long>(v));
+    return static_cast<int>(index);
+}
+
+static int BucketFromMicros(unsigned long long micros) {
+    if (micros < kLinearBuckets) return static_cast<int>(micros);
+
+    // The top bits below the leading one select the sub-bucket.
+    int exponent = HighestBit(micros);
+    int sub = static_cast<int>(micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    int index = kLinearBuckets + (exponent - 4) * kSubBuckets + sub;
+    return index < dx::TimeHistogram::kBucketCount ? index : dx::TimeHistogram::kBucketCount - 1;
+}
+
+// Returns the middle of the bucket in seconds.
+static double BucketMidpoint(int index) {
+    if (index < kLinearBuckets) return (index + 0.5) / 1000000.0;
+
+    int exponent = 4 + (index - kLinearBuckets) / kSubBuckets;
+    int sub = (index - kLinearBuckets) % kSubBuckets;
+    double width = static_cast<double>(1ULL << (exponent - kSubBucketBits));
+    double lower = (kSubBuckets + sub) * width;
+    return (lower + width * 0.5) / 1000000.0;
+}
+
+namespace dx {
+
+TimeHistogram::TimeHistogram() {
+    Reset();
+}
+
+void TimeHistogram::Record(double seconds) {
+    if (seconds < 0.0) seconds = 0.0;
+
+    unsigned long long micros = static_cast<unsigned long long>(seconds * 1000000.0);
+    ++_buckets[BucketFromMicros(micros)];
+
+    if (_count == 0 || seconds < _min) _min = seconds;
+    if (seconds > _max) _max = seconds;
+    _sum += seconds;
+    ++_count;
+}
+
+void TimeHistogram::Merge(const TimeHistogram &other) {
+    if (other._count == 0) return;
+
+    for (int i = 0; i < kBucketCount; ++i) {
+        _buckets[i] += other._buckets[i];
+    }
+
+    if (_count == 0 || other._min < _min) _min = other._min;
+    if (other._max > _max) _max = other._max;
+    _sum += other._sum;
+    _count += other._count;
+}
+
+void TimeHistogram::Reset() {
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _sum = 0.0;
+    _min = 0.0;
+    _max = 0.0;
+}
+
+double TimeHistogram::GetPercentile(double percentile) const {
+    if (_count == 0) return 0.0;
+    assert(percentile >= 0.0 && percentile <= 100.0);
+
+    // Rank of the sample we're looking for, 1-based.
+    unsigned long long rank = static_cast<unsigned long long>(percentile / 100.0 * _count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > _count) rank = _count;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += _buckets[i];
+        if (seen >= rank) {
+            // Bucket midpoints can lie outside the observed range.
+            double value = BucketMidpoint(i);
+            if (value > _max) value = _max;
+            if (value < _min) value = _min;
+            return value;
+        }
+    }
+    return _max;
+}
+
+FrameStats::FrameStats(unsigned int windowFrames) {
+    assert(windowFrames > 0);
+    _windowFrames = windowFrames;
+    Reset();
+}
+
+void FrameStats::Record(FrameZone::E zone, double seconds) {
+    assert(zone >= 0 && zone < FrameZone::COUNT);
+    _current[zone].Record(seconds);
+    _lifetime[zone].Record(seconds);
+}
+
+void FrameStats::EndFrame() {
+    ++_frames;
+
+    // Once the current window is full it becomes the previous one.
+    if (++_framesInWindow >= _windowFrames) {
+        for (int i = 0; i < FrameZone::COUNT; ++i) {
+            _previous[i] = _current[i];
+            _current[i].Reset();
+        }
+        _framesInWindow = 0;
+    }
+}
+
+void FrameStats::Reset() {
+    for (int i = 0; i < FrameZone::COUNT; ++i) {
+        _current[i].Reset();
+        _previous[i].Reset();
+        _lifetime[i].Reset();
+    }
+    _framesInWindow = 0;
+    _frames = 0;
+}
+
+void FrameStats::GetSnapshot(FrameStatsSnapshot &out) const {
+    out.frames = _frames;
+
+    for (int i = 0; i < FrameZone::COUNT; ++i) {
+        TimeHistogram window = _previous[i];
+        window.Merge(_current[i]);
+
+        ZoneStats &zone = out.zones[i];
+        zone.p50 = window.GetPercentile(50.0);
+        zone.p95 = window.GetPercentile(95.0);
+        zone.p99 = window.GetPercentile(99.0);
+        zone.max = window.GetMax();
+        zone.mean = window.GetMean();
+        zone.count = window.GetCount();
+    }
+}
+
+void FrameStats::Print(std::ostream &out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "Frame statistics (" << _frames << " frames, milliseconds)" << std::endl;
+    out << std::left << std::setw(10) << "Zone" << std::right
+        << std::setw(10) << "mean" << std::setw(10) << "p50"
+        << std::setw(10) << "p95" << std::setw(10) << "p99"
+        << std::setw(10) << "max" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+    for (int i = 0; i < FrameZone::COUNT; ++i) {
+        const TimeHistogram &h = _lifetime[i];
+        out << std::left << std::setw(10) << kZoneNames[i] << std::right
+            << std::setw(10) << TO_MILLIS(h.GetMean())
+            << std::setw(10) << TO_MILLIS(h.GetPercentile(50.0))
+            << std::setw(10) << TO_MILLIS(h.GetPercentile(95.0))
+            << std::setw(10) << TO_MILLIS(h.GetPercentile(99.0))
+            << std::setw(10) << TO_MILLIS(h.GetMax()) << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+const char* FrameStats::GetZoneName(FrameZone::E zone) {
+    assert(zone >= 0 && zone < FrameZone::COUNT);
+    return kZoneNames[zone];
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <InputRecording.h>
+
+#include <cassert>
+#include <fstream>
+
+static const unsigned int kMagic = 0x52495844; // "DXIR"
+static const unsigned int kVersion = 2;
+
+namespace dx {
+
+InputRecording::InputRecording() {
+    Clear();
+}
+
+void InputRecording::Clear() {
+    _records.clear();
+    _frame = 0;
+    _cursor = 0;
+}
+
+void InputRecording::Add(const Event &event) {
+    InputRecord record;
+    record.frame = _frame;
+    record.event = event;
+    _records.push_back(record);
+}
+
+size_t InputRecording::GetFrame(unsigned int frame, const InputRecord *&first) {
+    while (_cursor < _records.size() && _records[_cursor].frame < frame) {
+        ++_cursor;
+    }
+
+    size_t end = _cursor;
+    while (end < _records.size() && _records[end].frame == frame) {
+        ++end;
+    }
+
+    first = (end > _cursor) ? &_records[_cursor] : nullptr;
+    size_t count = end - _cursor;
+    _cursor = end;
+    return count;
+}
+
+Error::E InputRecording::Save(const std::string &path) const {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) return Error::FILE_OPEN_FAIL;
+
+    unsigned int header[3] = { kMagic, kVersion, static_cast<unsigned int>(_records.size()) };
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (!_records.empty()) {
+        out.write(reinterpret_cast<const char*>(&_records[0]), _records.size() * sizeof(InputRecord));
+    }
+
+    return out ? Error::OK : Error::FILE_OPEN_FAIL;
+}
+
+Error::E InputRecording::Load(const std::string &path) {
+    Clear();
+
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) return Error::FILE_OPEN_FAIL;
+
+    unsigned int header[3];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || header[0] != kMagic || header[1] != kVersion) {
+        return Error::FILE_FORMAT_INVALID;
+    }
+
+    _records.resize(header[2]);
+    if (!_records.empty()) {
+        in.read(reinterpret_cast<char*>(&_records[0]), _records.size() * sizeof(InputRecord));
+        if (!in) {
+            _records.clear();
+            return Error::FILE_FORMAT_INVALID;
+        }
+    }
+
+    return Error::OK;
+}
+
+} // namespace dx
\ No newline at end of file
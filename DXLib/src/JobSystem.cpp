@@ -0,0 +1,246 @@
+#include <JobSystem.h>
+#include <Profiler.h>
+#include "WorkStealingDeque.h"
+
+#include <Windows.h>
+#include <cassert>
+#include <cstdio>
+
+// Rounds of stealing attempts before an idle worker goes to sleep.
+static const int kIdleSpins = 64;
+
+static __declspec(thread) int threadIndex = -1;
+static __declspec(thread) unsigned int stealSeed = 0;
+
+static dx::JobSystem *activeSystem = nullptr;
+
+static void PinToProcessor(HANDLE thread, unsigned int index);
+
+namespace dx {
+
+JobSystem::JobSystem() : _sharedCount(0), _sleeping(0), _pending(0), _quit(false) {
+}
+
+JobSystem::~JobSystem() {
+    Shutdown();
+}
+
+void JobSystem::Initialize(unsigned int workerCount, bool pinThreads) {
+    assert(!IsInitialized() && "JobSystem already initialized");
+    assert(!activeSystem && "Only one JobSystem can be active");
+
+    if (workerCount == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        workerCount = (hardware > 1) ? hardware - 1 : 1;
+    }
+    if (workerCount > kMaxThreads - 1) workerCount = kMaxThreads - 1;
+
+    activeSystem = this;
+    _quit.store(false);
+
+    for (unsigned int i = 0; i <= workerCount; ++i) {
+        _deques.push_back(new Deque);
+    }
+
+    threadIndex = 0;
+    if (pinThreads) {
+        PinToProcessor(GetCurrentThread(), 0);
+    }
+
+    for (unsigned int i = 1; i <= workerCount; ++i) {
+        _threads.push_back(std::thread(&JobSystem::WorkerMain, this, i, pinThreads));
+    }
+}
+
+void JobSystem::Shutdown() {
+    if (!IsInitialized()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit.store(true);
+    }
+    _wake.notify_all();
+
+    for (size_t i = 0; i < _threads.size(); ++i) {
+        _threads[i].join();
+    }
+    _threads.clear();
+
+    for (size_t i = 0; i < _deques.size(); ++i) {
+        delete _deques[i];
+    }
+    _deques.clear();
+
+    _shared.clear();
+    _sharedCount.store(0);
+    _pending.store(0);
+
+    threadIndex = -1;
+    activeSystem = nullptr;
+}
+
+int JobSystem::GetThreadIndex() {
+    return threadIndex;
+}
+
+void JobSystem::Run(const Job &job) {
+    if (job.counter) {
+        job.counter->_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    Submit(job);
+}
+
+void JobSystem::Run(const Job *jobs, unsigned int count) {
+    for (unsigned int i = 0; i < count; ++i) {
+        if (jobs[i].counter) {
+            jobs[i].counter->_value.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    for (unsigned int i = 0; i < count; ++i) {
+        Submit(jobs[i]);
+    }
+}
+
+void JobSystem::Wait(const JobCounter &counter) {
+    int index = threadIndex;
+    while (!counter.IsDone()) {
+        Job job;
+        if (TryGetJob(index, job)) {
+            Execute(job);
+        } else {
+            YieldProcessor();
+        }
+    }
+}
+
+void JobSystem::Submit(const Job &job) {
+    if (!IsInitialized()) {
+        Execute(job);
+        return;
+    }
+
+    _pending.fetch_add(1);
+
+    int index = threadIndex;
+    if (index >= 0) {
+        if (!_deques[index]->Push(job)) {
+            // Deque is full, run it right away instead.
+            _pending.fetch_sub(1);
+            Execute(job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        _shared.push_back(job);
+        _sharedCount.fetch_add(1, std::memory_order_release);
+    }
+
+    if (_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _wake.notify_one();
+    }
+}
+
+bool JobSystem::TryGetJob(int index, Job &job) {
+    bool found = false;
+
+    if (index >= 0) {
+        found = _deques[index]->Pop(job);
+    }
+
+    if (!found && _sharedCount.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        if (!_shared.empty()) {
+            job = _shared.front();
+            _shared.pop_front();
+            _sharedCount.fetch_sub(1, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+
+    if (!found) {
+        // Start at a random victim so thieves spread out.
+        unsigned int count = static_cast<unsigned int>(_deques.size());
+        stealSeed = stealSeed * 1664525u + 1013904223u + static_cast<unsigned int>(index + 1);
+        unsigned int start = (stealSeed >> 8) % count;
+        for (unsigned int i = 0; i < count && !found; ++i) {
+            unsigned int victim = (start + i) % count;
+            if (static_cast<int>(victim) == index) continue;
+            found = _deques[victim]->Steal(job);
+        }
+    }
+
+    if (found) {
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return found;
+}
+
+void JobSystem::Execute(const Job &job) {
+    if (job.dependency) {
+        Wait(*job.dependency);
+    }
+
+    job.function(job.data);
+
+    if (job.counter) {
+        job.counter->_value.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void JobSystem::WorkerMain(unsigned int index, bool pin) {
+    threadIndex = static_cast<int>(index);
+    stealSeed = index * 2654435761u;
+
+    if (pin) {
+        PinToProcessor(GetCurrentThread(), index);
+    }
+
+    char name[32];
+    sprintf_s(name, "Worker %u", index);
+    Profiler::SetThreadName(name);
+
+    int idle = 0;
+    while (!_quit.load(std::memory_order_relaxed)) {
+        Job job;
+        if (TryGetJob(threadIndex, job)) {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < kIdleSpins) {
+            YieldProcessor();
+            continue;
+        }
+
+        // Nothing to do, sleep until Submit() wakes us up.
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleeping.fetch_add(1);
+        while (_pending.load() <= 0 && !_quit.load()) {
+            _wake.wait(lock);
+        }
+        _sleeping.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+} // namespace dx
+
+// Maps index to the N-th logical processor across all processor groups,
+// plain affinity masks can't address more than 64 (32 on Win32) CPUs.
+static void PinToProcessor(HANDLE thread, unsigned int index) {
+    WORD groups = GetActiveProcessorGroupCount();
+    for (WORD group = 0; group < groups; ++group) {
+        DWORD count = GetActiveProcessorCount(group);
+        if (index < count) {
+            GROUP_AFFINITY affinity;
+            memset(&affinity, 0, sizeof(affinity));
+            affinity.Group = group;
+            affinity.Mask = static_cast<KAFFINITY>(1) << index;
+            SetThreadGroupAffinity(thread, &affinity, NULL);
+            return;
+        }
+        index -= count;
+    }
+}
\ No newline at end of file
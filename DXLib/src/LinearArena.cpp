@@ -0,0 +1,104 @@
+#include <LinearArena.h>
+
+#include <cassert>
+#include <malloc.h>
+
+namespace dx {
+
+LinearArena::LinearArena() : _offset(0), _overflowBytes(0), _overflowCount(0) {
+    _memory = nullptr;
+    _capacity = 0;
+    _highWaterMark = 0;
+}
+
+LinearArena::~LinearArena() {
+    Shutdown();
+}
+
+void LinearArena::Initialize(size_t capacity) {
+    assert(!_memory && "LinearArena already initialized");
+    _memory = static_cast<char*>(_aligned_malloc(capacity, 64));
+    _capacity = _memory ? capacity : 0;
+    _offset.store(0);
+}
+
+void LinearArena::Shutdown() {
+    Reset();
+    _aligned_free(_memory);
+    _memory = nullptr;
+    _capacity = 0;
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    size_t offset = _offset.load(std::memory_order_relaxed);
+    for (;;) {
+        // Align the address rather than the offset, _memory is only
+        // aligned to 64 bytes.
+        size_t address = reinterpret_cast<size_t>(_memory) + offset;
+        size_t aligned = (address + alignment - 1) & ~(alignment - 1);
+        size_t end = aligned - reinterpret_cast<size_t>(_memory) + size;
+
+        if (!_memory || end > _capacity) {
+            return AllocateOverflow(size, alignment);
+        }
+
+        if (_offset.compare_exchange_weak(offset, end, std::memory_order_relaxed)) {
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+}
+
+void* LinearArena::AllocateOverflow(size_t size, size_t alignment) {
+    void *memory = _aligned_malloc(size > 0 ? size : 1, alignment);
+
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflow.push_back(memory);
+    _overflowBytes.fetch_add(size, std::memory_order_relaxed);
+    _overflowCount.fetch_add(1, std::memory_order_relaxed);
+    return memory;
+}
+
+void LinearArena::Reset() {
+    size_t used = GetUsed();
+    if (used > _highWaterMark) _highWaterMark = used;
+
+    for (size_t i = 0; i < _overflow.size(); ++i) {
+        _aligned_free(_overflow[i]);
+    }
+    _overflow.clear();
+    _overflowBytes.store(0, std::memory_order_relaxed);
+    _overflowCount.store(0, std::memory_order_relaxed);
+
+    _offset.store(0, std::memory_order_relaxed);
+}
+
+size_t LinearArena::GetHighWaterMark() const {
+    size_t used = GetUsed();
+    return used > _highWaterMark ? used : _highWaterMark;
+}
+
+void DoubleBufferedArena::Initialize(size_t capacityPerFrame) {
+    _arenas[0].Initialize(capacityPerFrame);
+    _arenas[1].Initialize(capacityPerFrame);
+    _current = 0;
+}
+
+void DoubleBufferedArena::Shutdown() {
+    _arenas[0].Shutdown();
+    _arenas[1].Shutdown();
+}
+
+void DoubleBufferedArena::Flip() {
+    _current ^= 1;
+    _arenas[_current].Reset();
+}
+
+size_t DoubleBufferedArena::GetHighWaterMark() const {
+    size_t a = _arenas[0].GetHighWaterMark();
+    size_t b = _arenas[1].GetHighWaterMark();
+    return a > b ? a : b;
+}
+
+} // namespace dx
\ No newline at end of file
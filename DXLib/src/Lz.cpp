@@ -0,0 +1,144 @@
+#include <Lz.h>
+
+#include <cstring>
+
+typedef unsigned char BYTE;
+
+static const size_t kMinMatch = 4;
+static const size_t kMaxOffset = 65535;
+static const unsigned int kHashBits = 12;
+
+static unsigned int Read32(const BYTE *p) {
+    unsigned int value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static unsigned int Hash(unsigned int sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Lengths of 15 and more continue in bytes of 255 and a final rest.
+static bool WriteLength(BYTE *&out, BYTE *end, size_t length) {
+    for (; length >= 255; length -= 255) {
+        if (out == end) return false;
+        *out++ = 255;
+    }
+    if (out == end) return false;
+    *out++ = static_cast<BYTE>(length);
+    return true;
+}
+
+static bool ReadLength(const BYTE *&in, const BYTE *end, size_t &length) {
+    for (;;) {
+        if (in == end) return false;
+        BYTE next = *in++;
+        length += next;
+        if (next != 255) return true;
+    }
+}
+
+// Literals and, unless this is the last sequence, the match after them.
+static bool WriteSequence(BYTE *&out, BYTE *end, const BYTE *literals, size_t literalCount,
+                          size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+    if (out == end) return false;
+    BYTE *token = out++;
+    *token = static_cast<BYTE>(((literalCount < 15 ? literalCount : 15) << 4) |
+                               (matchCode < 15 ? matchCode : 15));
+
+    if (literalCount >= 15 && !WriteLength(out, end, literalCount - 15)) return false;
+    if (static_cast<size_t>(end - out) < literalCount) return false;
+    memcpy(out, literals, literalCount);
+    out += literalCount;
+
+    if (matchLength == 0) return true;
+    if (end - out < 2) return false;
+    *out++ = static_cast<BYTE>(offset);
+    *out++ = static_cast<BYTE>(offset >> 8);
+    return matchCode < 15 || WriteLength(out, end, matchCode - 15);
+}
+
+namespace dx {
+
+size_t LzCompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t LzCompress(const void *in, size_t size, void *out, size_t capacity) {
+    const BYTE *src = static_cast<const BYTE*>(in);
+    BYTE *dst = static_cast<BYTE*>(out);
+    BYTE *dstEnd = dst + capacity;
+
+    // Last position + 1 each 4 byte sequence was seen at, 0 if never.
+    unsigned int table[1 << kHashBits];
+    memset(table, 0, sizeof(table));
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + kMinMatch <= size) {
+        unsigned int sequence = Read32(src + pos);
+        unsigned int &slot = table[Hash(sequence)];
+        size_t candidate = slot;
+        slot = static_cast<unsigned int>(pos + 1);
+
+        if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || Read32(src + candidate - 1) != sequence) {
+            ++pos;
+            continue;
+        }
+
+        size_t match = candidate - 1;
+        size_t length = kMinMatch;
+        while (pos + length < size && src[match + length] == src[pos + length]) ++length;
+
+        if (!WriteSequence(dst, dstEnd, src + anchor, pos - anchor, pos - match, length)) return 0;
+        pos += length;
+        anchor = pos;
+    }
+
+    if (!WriteSequence(dst, dstEnd, src + anchor, size - anchor, 0, 0)) return 0;
+    return dst - static_cast<BYTE*>(out);
+}
+
+bool LzDecompress(const void *in, size_t size, void *out, size_t outSize) {
+    const BYTE *src = static_cast<const BYTE*>(in);
+    const BYTE *srcEnd = src + size;
+    BYTE *dst = static_cast<BYTE*>(out);
+    BYTE *dstStart = dst;
+    BYTE *dstEnd = dst + outSize;
+
+    while (src < srcEnd) {
+        BYTE token = *src++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !ReadLength(src, srcEnd, literalCount)) return false;
+        if (static_cast<size_t>(srcEnd - src) < literalCount) return false;
+        if (static_cast<size_t>(dstEnd - dst) < literalCount) return false;
+        memcpy(dst, src, literalCount);
+        src += literalCount;
+        dst += literalCount;
+
+        // The last sequence has no match.
+        if (src == srcEnd) break;
+
+        if (srcEnd - src < 2) return false;
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(src, srcEnd, matchLength)) return false;
+        matchLength += kMinMatch;
+
+        if (offset == 0 || offset > static_cast<size_t>(dst - dstStart)) return false;
+        if (static_cast<size_t>(dstEnd - dst) < matchLength) return false;
+        // Matches may overlap what they produce, copy byte by byte.
+        const BYTE *match = dst - offset;
+        for (size_t i = 0; i < matchLength; ++i) {
+            dst[i] = match[i];
+        }
+        dst += matchLength;
+    }
+
+    return dst == dstEnd;
+}
+
+} // namespace dx
\ No newline at end of file
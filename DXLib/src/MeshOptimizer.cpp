@@ -0,0 +1,364 @@
+#include <MeshOptimizer.h>
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Forsyth's tuning, see "Linear-Speed Vertex Cache Optimisation".
+static const float kCacheDecayPower = 1.5f;
+static const float kLastTriangleScore = 0.75f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+// Valences past this share the smallest boost.
+static const UINT kMaxValence = 64;
+
+static const UINT kUnused = 0xFFFFFFFF;
+
+namespace {
+
+// Precomputed per call rather than once, static locals aren't
+// initialized thread-safely on every compiler we build with.
+struct ScoreTables {
+    float cache[dx::kVertexCacheSize];
+    float valence[kMaxValence + 1];
+
+    ScoreTables() {
+        for (UINT i = 0; i < dx::kVertexCacheSize; ++i) {
+            if (i < 3) {
+                // The last triangle's vertices, fixed so its neighbours
+                // don't keep winning with the same vertices.
+                cache[i] = kLastTriangleScore;
+            } else {
+                float scale = 1.0f - static_cast<float>(i - 3) / (dx::kVertexCacheSize - 3);
+                cache[i] = std::pow(scale, kCacheDecayPower);
+            }
+        }
+        valence[0] = 0.0f;
+        for (UINT i = 1; i <= kMaxValence; ++i) {
+            valence[i] = kValenceBoostScale * std::pow(static_cast<float>(i), -kValenceBoostPower);
+        }
+    }
+
+    inline float Score(int cachePosition, UINT remaining) const {
+        // No triangles left, nothing to gain.
+        if (remaining == 0) return -1.0f;
+
+        float score = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+        return score + valence[remaining < kMaxValence ? remaining : kMaxValence];
+    }
+};
+
+} // namespace
+
+// Runs a triangle through a FIFO cache of kVertexCacheAnalyzeSize,
+// returns how many of its vertices missed. A vertex is cached while
+// fewer than the cache size others went in after it.
+static UINT CountMisses(const UINT *triangle, std::vector<UINT> &inserted, UINT &time) {
+    UINT misses = 0;
+    for (UINT c = 0; c < 3; ++c) {
+        UINT vertex = triangle[c];
+        if (time - inserted[vertex] > dx::kVertexCacheAnalyzeSize) {
+            inserted[vertex] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+namespace dx {
+
+VertexCacheStats AnalyzeVertexCache(const UINT *indices, UINT indexCount, UINT vertexCount, UINT cacheSize) {
+    VertexCacheStats stats;
+    stats.triangles = indexCount / 3;
+    stats.vertices = 0;
+    stats.transforms = 0;
+
+    // A vertex is cached while fewer than cacheSize others went in after
+    // it. Starting past cacheSize makes everything miss at first.
+    std::vector<UINT> inserted(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    UINT time = cacheSize + 1;
+    for (UINT i = 0; i < indexCount; ++i) {
+        UINT vertex = indices[i];
+        assert(vertex < vertexCount);
+        if (time - inserted[vertex] > cacheSize) {
+            inserted[vertex] = time++;
+            ++stats.transforms;
+        }
+        if (!used[vertex]) {
+            used[vertex] = true;
+            ++stats.vertices;
+        }
+    }
+
+    stats.acmr = stats.triangles ? static_cast<float>(stats.transforms) / stats.triangles : 0.0f;
+    stats.atvr = stats.vertices ? static_cast<float>(stats.transforms) / stats.vertices : 0.0f;
+    return stats;
+}
+
+void OptimizeVertexCache(UINT *destination, const UINT *indices, UINT indexCount, UINT vertexCount) {
+    assert(indexCount % 3 == 0);
+    assert(destination != indices);
+    UINT triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    ScoreTables tables;
+
+    // Triangles using each vertex, the first *remaining* of them not
+    // emitted yet.
+    std::vector<UINT> remaining(vertexCount, 0);
+    for (UINT i = 0; i < indexCount; ++i) {
+        assert(indices[i] < vertexCount);
+        ++remaining[indices[i]];
+    }
+    std::vector<UINT> firstTriangle(vertexCount + 1);
+    firstTriangle[0] = 0;
+    for (UINT v = 0; v < vertexCount; ++v) firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+
+    std::vector<UINT> adjacency(indexCount);
+    std::vector<UINT> filled(vertexCount, 0);
+    for (UINT i = 0; i < indexCount; ++i) {
+        UINT vertex = indices[i];
+        adjacency[firstTriangle[vertex] + filled[vertex]++] = i / 3;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (UINT v = 0; v < vertexCount; ++v) vertexScore[v] = tables.Score(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (UINT t = 0; t < triangleCount; ++t) {
+        const UINT *corner = indices + t * 3;
+        triangleScore[t] = vertexScore[corner[0]] + vertexScore[corner[1]] + vertexScore[corner[2]];
+    }
+
+    // Three more than the cache for the vertices a triangle pushes out.
+    UINT cache[kVertexCacheSize + 3];
+    UINT newCache[kVertexCacheSize + 3];
+    UINT cacheCount = 0;
+
+    UINT next = 0;
+    UINT best = kUnused;
+    for (UINT out = 0; out < triangleCount; ++out) {
+        if (best == kUnused) {
+            // Nothing cached has triangles left, carry on with the next
+            // one in input order.
+            while (emitted[next]) ++next;
+            best = next;
+        }
+
+        const UINT *corner = indices + best * 3;
+        destination[out * 3 + 0] = corner[0];
+        destination[out * 3 + 1] = corner[1];
+        destination[out * 3 + 2] = corner[2];
+        emitted[best] = true;
+
+        for (UINT c = 0; c < 3; ++c) {
+            UINT vertex = corner[c];
+            UINT *triangles = &adjacency[firstTriangle[vertex]];
+            UINT last = --remaining[vertex];
+            for (UINT i = 0; i <= last; ++i) {
+                if (triangles[i] == best) {
+                    triangles[i] = triangles[last];
+                    break;
+                }
+            }
+        }
+
+        // The triangle's vertices move to the front, the rest keep their
+        // order behind them.
+        UINT newCount = 0;
+        for (UINT c = 0; c < 3; ++c) {
+            UINT vertex = corner[c];
+            if (std::find(newCache, newCache + newCount, vertex) == newCache + newCount) newCache[newCount++] = vertex;
+        }
+        for (UINT i = 0; i < cacheCount; ++i) {
+            UINT vertex = cache[i];
+            if (vertex != corner[0] && vertex != corner[1] && vertex != corner[2]) newCache[newCount++] = vertex;
+        }
+
+        // Rescore everything that moved, including what fell out, and
+        // pass the change on to the triangles left to use it.
+        for (UINT i = 0; i < newCount; ++i) {
+            UINT vertex = newCache[i];
+            int position = i < kVertexCacheSize ? static_cast<int>(i) : -1;
+            cachePosition[vertex] = position;
+
+            float score = tables.Score(position, remaining[vertex]);
+            float delta = score - vertexScore[vertex];
+            vertexScore[vertex] = score;
+
+            const UINT *triangles = &adjacency[firstTriangle[vertex]];
+            for (UINT j = 0; j < remaining[vertex]; ++j) triangleScore[triangles[j]] += delta;
+        }
+
+        cacheCount = newCount < kVertexCacheSize ? newCount : kVertexCacheSize;
+        memcpy(cache, newCache, cacheCount * sizeof(UINT));
+
+        // The next triangle comes from those with a vertex cached.
+        best = kUnused;
+        float bestScore = 0.0f;
+        for (UINT i = 0; i < cacheCount; ++i) {
+            UINT vertex = cache[i];
+            const UINT *triangles = &adjacency[firstTriangle[vertex]];
+            for (UINT j = 0; j < remaining[vertex]; ++j) {
+                UINT triangle = triangles[j];
+                if (best == kUnused || triangleScore[triangle] > bestScore) {
+                    best = triangle;
+                    bestScore = triangleScore[triangle];
+                }
+            }
+        }
+    }
+}
+
+void OptimizeOverdraw(UINT *destination, const UINT *indices, UINT indexCount,
+                      const Vertex *vertices, UINT vertexCount, float threshold) {
+    assert(indexCount % 3 == 0);
+    assert(destination != indices);
+    UINT triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    // One FIFO simulation for the whole mesh, flushed by moving *time*
+    // past every timestamp in it. Per cluster arrays would cost
+    // vertexCount each, far too much with thousands of clusters.
+    std::vector<UINT> inserted(vertexCount, 0);
+    UINT time = kVertexCacheAnalyzeSize + 1;
+
+    // Hard boundaries are where the cache order started over, every
+    // vertex of the triangle missing. Each cluster's ACMR is counted
+    // along the way.
+    std::vector<UINT> clusters;
+    std::vector<float> clusterAcmr;
+    UINT clusterMisses = 0;
+    for (UINT t = 0; t < triangleCount; ++t) {
+        UINT misses = CountMisses(indices + t * 3, inserted, time);
+        if (t > 0 && misses == 3) {
+            clusterAcmr.push_back(static_cast<float>(clusterMisses) / (t - clusters.back()));
+            clusterMisses = 0;
+        }
+        if (t == 0 || misses == 3) clusters.push_back(t);
+        clusterMisses += misses;
+    }
+    clusterAcmr.push_back(static_cast<float>(clusterMisses) / (triangleCount - clusters.back()));
+    clusters.push_back(triangleCount);
+
+    // Soft boundaries split those further wherever the cache restarting
+    // costs little: as soon as the part so far is within *threshold* of
+    // the whole cluster's ACMR.
+    std::vector<UINT> boundaries;
+    for (size_t i = 0; i + 1 < clusters.size(); ++i) {
+        UINT start = clusters[i];
+        UINT end = clusters[i + 1];
+
+        time += kVertexCacheAnalyzeSize + 1;
+        UINT misses = 0;
+        boundaries.push_back(start);
+        for (UINT t = start; t < end; ++t) {
+            misses += CountMisses(indices + t * 3, inserted, time);
+
+            UINT done = t + 1 - boundaries.back();
+            if (t + 1 < end && static_cast<float>(misses) / done <= threshold * clusterAcmr[i]) {
+                boundaries.push_back(t + 1);
+                time += kVertexCacheAnalyzeSize + 1;
+                misses = 0;
+            }
+        }
+    }
+    boundaries.push_back(triangleCount);
+
+    // Each cluster's area weighted center and normal, and the mesh's
+    // center to see which way clusters face.
+    UINT clusterCount = static_cast<UINT>(boundaries.size() - 1);
+    std::vector<Vector3f> centers(clusterCount);
+    std::vector<Vector3f> normals(clusterCount);
+    Vector3f meshCenter;
+    float meshArea = 0.0f;
+    for (UINT i = 0; i < clusterCount; ++i) {
+        Vector3f center, normal;
+        float area = 0.0f;
+        for (UINT t = boundaries[i]; t < boundaries[i + 1]; ++t) {
+            const Vector3f &p0 = vertices[indices[t * 3 + 0]].position;
+            const Vector3f &p1 = vertices[indices[t * 3 + 1]].position;
+            const Vector3f &p2 = vertices[indices[t * 3 + 2]].position;
+
+            Vector3f faceNormal = (p1 - p0).Cross(p2 - p0);
+            float faceArea = faceNormal.Length() * 0.5f;
+            center += (p0 + p1 + p2) * (faceArea / 3.0f);
+            normal += faceNormal;
+            area += faceArea;
+        }
+
+        meshCenter += center;
+        meshArea += area;
+        centers[i] = area > 0.0f ? center / area : center;
+        float length = normal.Length();
+        normals[i] = length > 0.0f ? normal / length : normal;
+    }
+    if (meshArea > 0.0f) meshCenter /= meshArea;
+
+    std::vector<float> keys(clusterCount);
+    std::vector<UINT> order(clusterCount);
+    for (UINT i = 0; i < clusterCount; ++i) {
+        keys[i] = (centers[i] - meshCenter).Dot(normals[i]);
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](UINT a, UINT b) { return keys[a] > keys[b]; });
+
+    UINT *out = destination;
+    for (UINT i = 0; i < clusterCount; ++i) {
+        UINT cluster = order[i];
+        UINT first = boundaries[cluster] * 3;
+        UINT count = boundaries[cluster + 1] * 3 - first;
+        memcpy(out, indices + first, count * sizeof(UINT));
+        out += count;
+    }
+}
+
+UINT OptimizeVertexFetch(Vertex *destination, UINT *indices, UINT indexCount,
+                         const Vertex *vertices, UINT vertexCount) {
+    assert(destination != vertices);
+
+    std::vector<UINT> remap(vertexCount, kUnused);
+    UINT next = 0;
+    for (UINT i = 0; i < indexCount; ++i) {
+        UINT vertex = indices[i];
+        assert(vertex < vertexCount);
+        if (remap[vertex] == kUnused) {
+            remap[vertex] = next;
+            destination[next++] = vertices[vertex];
+        }
+        indices[i] = remap[vertex];
+    }
+    return next;
+}
+
+void OptimizeMesh(IndexedMesh &mesh, float overdrawThreshold) {
+    mesh.before = AnalyzeVertexCache(mesh.indices, mesh.indexCount, mesh.vertexCount);
+    if (mesh.indexCount >= 3) {
+        std::vector<UINT> cacheOrder(mesh.indexCount);
+        OptimizeVertexCache(&cacheOrder[0], mesh.indices, mesh.indexCount, mesh.vertexCount);
+        OptimizeOverdraw(mesh.indices, &cacheOrder[0], mesh.indexCount, mesh.vertices, mesh.vertexCount, overdrawThreshold);
+
+        std::vector<Vertex> vertices(mesh.vertices, mesh.vertices + mesh.vertexCount);
+        mesh.vertexCount = OptimizeVertexFetch(mesh.vertices, mesh.indices, mesh.indexCount, &vertices[0], mesh.vertexCount);
+    }
+    mesh.after = AnalyzeVertexCache(mesh.indices, mesh.indexCount, mesh.vertexCount);
+}
+
+void OptimizeMeshes(IndexedMesh *meshes, UINT count, JobSystem *jobs) {
+    if (!jobs) {
+        for (UINT i = 0; i < count; ++i) OptimizeMesh(meshes[i]);
+        return;
+    }
+
+    jobs->ParallelFor(0, count, 1, [meshes](UINT first, UINT last) {
+        for (UINT i = first; i < last; ++i) OptimizeMesh(meshes[i]);
+    });
+}
+
+} // namespace dx
\ No newline at end of file
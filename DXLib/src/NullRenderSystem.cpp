@@ -0,0 +1,90 @@
+#include <NullRenderSystem.h>
+#include <Timer.h>
+#include <Window.h>
+
+namespace dx {
+
+NullRenderSystem::NullRenderSystem() {
+    _width = 0;
+    _height = 0;
+    _windowed = false;
+    _frameStart = 0;
+    _recording = false;
+}
+
+NullRenderSystem::~NullRenderSystem() {
+
+}
+
+Error::E NullRenderSystem::Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs) {
+    if (window) {
+        width = window->GetWidth();
+        height = window->GetHeight();
+    }
+
+    _width = width;
+    _height = height;
+    _windowed = (window != nullptr);
+    return Error::OK;
+}
+
+void NullRenderSystem::Clear(const Vector4f &color) {
+    BeginCall();
+    ++_frame.clears;
+    Record(NullRenderCall::CLEAR, 0, 0);
+}
+
+void NullRenderSystem::Draw(const DrawCommand &command) {
+    BeginCall();
+    CountDrawCall();
+    ++_frame.draws;
+    _frame.vertices += command.vertexCount;
+    _frame.indices += command.indexCount;
+    Record(NullRenderCall::DRAW, command.vertexCount, command.indexCount);
+}
+
+void NullRenderSystem::Present() {
+    if (_frameStart != 0) {
+        _frame.submitSeconds = (Timer::GetRawTicks() - _frameStart) * Timer::GetSecondsPerTick();
+    }
+    ++_frame.presents;
+    Record(NullRenderCall::PRESENT, 0, 0);
+
+    _totals.clears += _frame.clears;
+    _totals.draws += _frame.draws;
+    _totals.presents += _frame.presents;
+    _totals.vertices += _frame.vertices;
+    _totals.indices += _frame.indices;
+    _totals.submitSeconds += _frame.submitSeconds;
+
+    _lastFrame = _frame;
+    _frame.Reset();
+    _frameStart = 0;
+
+    EndFrameCounters();
+}
+
+void NullRenderSystem::ResetStats() {
+    _frame.Reset();
+    _lastFrame.Reset();
+    _totals.Reset();
+    _frameStart = 0;
+}
+
+void NullRenderSystem::BeginCall() {
+    if (_frameStart == 0) {
+        _frameStart = Timer::GetRawTicks();
+    }
+}
+
+void NullRenderSystem::Record(NullRenderCall::E call, UINT vertexCount, UINT indexCount) {
+    if (!_recording) return;
+
+    NullRenderRecord record;
+    record.call = call;
+    record.vertexCount = vertexCount;
+    record.indexCount = indexCount;
+    _records.push_back(record);
+}
+
+} // namespace dx
\ No newline at end of file
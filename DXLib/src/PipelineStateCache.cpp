@@ -0,0 +1,282 @@
+#include <PipelineStateCache.h>
+#include <Timer.h>
+#include "Util.h"
+
+#include <cassert>
+#include <cstring>
+
+// Twice the states a table may hold, keeps probe runs short.
+static const UINT kSlotCount = dx::PipelineStateCache::kMaxStatesPerKind * 2;
+
+static const UINT kDescSizes[dx::PipelineStateKind::COUNT] = {
+    sizeof(D3D11_BLEND_DESC),
+    sizeof(D3D11_RASTERIZER_DESC),
+    sizeof(D3D11_DEPTH_STENCIL_DESC),
+    sizeof(D3D11_SAMPLER_DESC),
+};
+
+static double SecondsSince(unsigned long long startTicks) {
+    return (dx::Timer::GetRawTicks() - startTicks) * dx::Timer::GetSecondsPerTick();
+}
+
+// FNV-1a, 0 marks empty slots and is never returned.
+static unsigned long long HashDesc(const void *desc, UINT size) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(desc);
+    unsigned long long hash = 14695981039346656037ull;
+    for (UINT i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
+// The descriptions below have padding or fields the driver ignores,
+// keys are copied field by field into zeroed ones so equal states hash
+// equal.
+static D3D11_BLEND_DESC BlendKey(const D3D11_BLEND_DESC &desc) {
+    D3D11_BLEND_DESC key;
+    memset(&key, 0, sizeof(key));
+    key.AlphaToCoverageEnable = desc.AlphaToCoverageEnable;
+    key.IndependentBlendEnable = desc.IndependentBlendEnable;
+
+    // Without independent blending only the first target counts.
+    UINT targets = desc.IndependentBlendEnable ? 8 : 1;
+    for (UINT i = 0; i < targets; ++i) {
+        const D3D11_RENDER_TARGET_BLEND_DESC &src = desc.RenderTarget[i];
+        D3D11_RENDER_TARGET_BLEND_DESC &dst = key.RenderTarget[i];
+        dst.BlendEnable = src.BlendEnable;
+        dst.SrcBlend = src.SrcBlend;
+        dst.DestBlend = src.DestBlend;
+        dst.BlendOp = src.BlendOp;
+        dst.SrcBlendAlpha = src.SrcBlendAlpha;
+        dst.DestBlendAlpha = src.DestBlendAlpha;
+        dst.BlendOpAlpha = src.BlendOpAlpha;
+        dst.RenderTargetWriteMask = src.RenderTargetWriteMask;
+    }
+    return key;
+}
+
+static D3D11_DEPTH_STENCIL_DESC DepthStencilKey(const D3D11_DEPTH_STENCIL_DESC &desc) {
+    D3D11_DEPTH_STENCIL_DESC key;
+    memset(&key, 0, sizeof(key));
+    key.DepthEnable = desc.DepthEnable;
+    key.DepthWriteMask = desc.DepthWriteMask;
+    key.DepthFunc = desc.DepthFunc;
+    key.StencilEnable = desc.StencilEnable;
+    key.StencilReadMask = desc.StencilReadMask;
+    key.StencilWriteMask = desc.StencilWriteMask;
+    key.FrontFace = desc.FrontFace;
+    key.BackFace = desc.BackFace;
+    return key;
+}
+
+namespace dx {
+
+PipelineStateCache::PipelineStateCache() {
+    _device = nullptr;
+    for (UINT kind = 0; kind < PipelineStateKind::COUNT; ++kind) {
+        Table &table = _tables[kind];
+        table.slots = new Slot[kSlotCount];
+        table.descSize = kDescSizes[kind];
+        table.count = 0;
+        for (UINT i = 0; i < kSlotCount; ++i) {
+            table.slots[i].hash = 0;
+            table.slots[i].desc = nullptr;
+            table.slots[i].state = nullptr;
+        }
+    }
+    _lookups = 0;
+    _hits = 0;
+}
+
+PipelineStateCache::~PipelineStateCache() {
+    Release();
+    for (UINT kind = 0; kind < PipelineStateKind::COUNT; ++kind) {
+        delete[] _tables[kind].slots;
+    }
+}
+
+void PipelineStateCache::Initialize(ID3D11Device *device) {
+    assert(!_device && "PipelineStateCache already initialized");
+    _device = device;
+}
+
+void PipelineStateCache::Release() {
+    std::lock_guard<std::mutex> lock(_createMutex);
+    for (UINT kind = 0; kind < PipelineStateKind::COUNT; ++kind) {
+        Table &table = _tables[kind];
+        for (UINT i = 0; i < kSlotCount; ++i) {
+            Slot &slot = table.slots[i];
+            if (slot.hash.load(std::memory_order_relaxed) == 0) continue;
+            ReleaseCom(slot.state);
+            delete[] static_cast<const char*>(slot.desc);
+            slot.desc = nullptr;
+            slot.hash.store(0, std::memory_order_relaxed);
+        }
+        table.count = 0;
+    }
+    _device = nullptr;
+}
+
+ID3D11BlendState* PipelineStateCache::GetBlendState(const D3D11_BLEND_DESC &desc) {
+    D3D11_BLEND_DESC key = BlendKey(desc);
+    return static_cast<ID3D11BlendState*>(Get(PipelineStateKind::BLEND, &key, false));
+}
+
+ID3D11RasterizerState* PipelineStateCache::GetRasterizerState(const D3D11_RASTERIZER_DESC &desc) {
+    return static_cast<ID3D11RasterizerState*>(Get(PipelineStateKind::RASTERIZER, &desc, false));
+}
+
+ID3D11DepthStencilState* PipelineStateCache::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC &desc) {
+    D3D11_DEPTH_STENCIL_DESC key = DepthStencilKey(desc);
+    return static_cast<ID3D11DepthStencilState*>(Get(PipelineStateKind::DEPTH_STENCIL, &key, false));
+}
+
+ID3D11SamplerState* PipelineStateCache::GetSamplerState(const D3D11_SAMPLER_DESC &desc) {
+    return static_cast<ID3D11SamplerState*>(Get(PipelineStateKind::SAMPLER, &desc, false));
+}
+
+Error::E PipelineStateCache::Warm(const PipelineStateSet &set) {
+    bool ok = true;
+    for (size_t i = 0; i < set.blend.size(); ++i) {
+        D3D11_BLEND_DESC key = BlendKey(set.blend[i]);
+        ok &= Get(PipelineStateKind::BLEND, &key, true) != nullptr;
+    }
+    for (size_t i = 0; i < set.rasterizer.size(); ++i) {
+        ok &= Get(PipelineStateKind::RASTERIZER, &set.rasterizer[i], true) != nullptr;
+    }
+    for (size_t i = 0; i < set.depthStencil.size(); ++i) {
+        D3D11_DEPTH_STENCIL_DESC key = DepthStencilKey(set.depthStencil[i]);
+        ok &= Get(PipelineStateKind::DEPTH_STENCIL, &key, true) != nullptr;
+    }
+    for (size_t i = 0; i < set.sampler.size(); ++i) {
+        ok &= Get(PipelineStateKind::SAMPLER, &set.sampler[i], true) != nullptr;
+    }
+    return ok ? Error::OK : Error::RENDER_INIT_FAIL;
+}
+
+UINT PipelineStateCache::GetStateCount(PipelineStateKind::E kind) const {
+    return _tables[kind].count.load(std::memory_order_relaxed);
+}
+
+PipelineStateCacheStats PipelineStateCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(_createMutex);
+    PipelineStateCacheStats stats = _createStats;
+    stats.lookups = _lookups.load(std::memory_order_relaxed);
+    stats.hits = _hits.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PipelineStateCache::ResetStats() {
+    std::lock_guard<std::mutex> lock(_createMutex);
+    _createStats.Reset();
+    _lookups = 0;
+    _hits = 0;
+}
+
+ID3D11DeviceChild* PipelineStateCache::Get(PipelineStateKind::E kind, const void *desc, bool prebuild) {
+    const Table &table = _tables[kind];
+    unsigned long long hash = HashDesc(desc, table.descSize);
+
+    if (!prebuild) _lookups.fetch_add(1, std::memory_order_relaxed);
+    ID3D11DeviceChild *state = Find(table, desc, hash);
+    if (state) {
+        if (!prebuild) _hits.fetch_add(1, std::memory_order_relaxed);
+        return state;
+    }
+
+    std::lock_guard<std::mutex> lock(_createMutex);
+    // Another thread may have created it meanwhile.
+    state = Find(table, desc, hash);
+    if (state) {
+        if (!prebuild) _hits.fetch_add(1, std::memory_order_relaxed);
+        return state;
+    }
+
+    unsigned long long start = Timer::GetRawTicks();
+    state = Create(kind, desc);
+    _createStats.createSeconds += SecondsSince(start);
+    if (!state) {
+        ++_createStats.failures;
+        return nullptr;
+    }
+    if (prebuild) {
+        ++_createStats.prebuilt;
+    } else {
+        ++_createStats.misses;
+    }
+
+    Table &writable = _tables[kind];
+    char *copy = new char[writable.descSize];
+    memcpy(copy, desc, writable.descSize);
+
+    UINT i = static_cast<UINT>(hash) & (kSlotCount - 1);
+    while (writable.slots[i].hash.load(std::memory_order_relaxed) != 0) {
+        i = (i + 1) & (kSlotCount - 1);
+    }
+    Slot &slot = writable.slots[i];
+    slot.desc = copy;
+    slot.state = state;
+    slot.hash.store(hash, std::memory_order_release);
+    writable.count.fetch_add(1, std::memory_order_relaxed);
+    return state;
+}
+
+ID3D11DeviceChild* PipelineStateCache::Find(const Table &table, const void *desc, unsigned long long hash) const {
+    UINT i = static_cast<UINT>(hash) & (kSlotCount - 1);
+    for (;;) {
+        const Slot &slot = table.slots[i];
+        unsigned long long slotHash = slot.hash.load(std::memory_order_acquire);
+        if (slotHash == 0) return nullptr;
+        // Equal hashes of different descriptions are told apart here.
+        if (slotHash == hash && memcmp(slot.desc, desc, table.descSize) == 0) {
+            return slot.state;
+        }
+        i = (i + 1) & (kSlotCount - 1);
+    }
+}
+
+// Called with _createMutex held.
+ID3D11DeviceChild* PipelineStateCache::Create(PipelineStateKind::E kind, const void *desc) {
+    assert(_device && "PipelineStateCache not initialized");
+    if (_tables[kind].count.load(std::memory_order_relaxed) >= kMaxStatesPerKind) return nullptr;
+
+    HRESULT hr = E_FAIL;
+    ID3D11DeviceChild *state = nullptr;
+    switch (kind) {
+    case PipelineStateKind::BLEND: {
+        ID3D11BlendState *blend = nullptr;
+        hr = _device->CreateBlendState(static_cast<const D3D11_BLEND_DESC*>(desc), &blend);
+        state = blend;
+        break;
+    }
+    case PipelineStateKind::RASTERIZER: {
+        ID3D11RasterizerState *rasterizer = nullptr;
+        hr = _device->CreateRasterizerState(static_cast<const D3D11_RASTERIZER_DESC*>(desc), &rasterizer);
+        state = rasterizer;
+        break;
+    }
+    case PipelineStateKind::DEPTH_STENCIL: {
+        ID3D11DepthStencilState *depthStencil = nullptr;
+        hr = _device->CreateDepthStencilState(static_cast<const D3D11_DEPTH_STENCIL_DESC*>(desc), &depthStencil);
+        state = depthStencil;
+        break;
+    }
+    case PipelineStateKind::SAMPLER: {
+        ID3D11SamplerState *sampler = nullptr;
+        hr = _device->CreateSamplerState(static_cast<const D3D11_SAMPLER_DESC*>(desc), &sampler);
+        state = sampler;
+        break;
+    }
+    default:
+        assert(false && "Unknown PipelineStateKind");
+    }
+
+    if (FAILED(hr)) {
+        ReleaseCom(state);
+        return nullptr;
+    }
+    return state;
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include <Profiler.h>
+#include <Timer.h>
+
+#include <Windows.h>
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace dx {
+
+// Per-thread recording state. Only the owning thread writes to it,
+// readers take a snapshot and use head to discard torn entries.
+struct ProfilerThreadBuffer {
+    ProfileEvent events[Profiler::kRingSize];
+    // Total number of events ever written.
+    std::atomic<unsigned long long> head;
+
+    // Open zones.
+    const char *names[Profiler::kMaxDepth];
+    unsigned long long begins[Profiler::kMaxDepth];
+    unsigned int depth;
+
+    // Value of head when BeginFrame() was called on this thread.
+    unsigned long long frameStart;
+
+    DWORD threadId;
+    char threadName[32];
+};
+
+// Buffers are owned by the registry and kept alive until exit so that
+// zones of finished threads still make it into the trace.
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ProfilerThreadBuffer>> registry;
+
+static __declspec(thread) ProfilerThreadBuffer *threadBuffer = nullptr;
+
+// Trace timestamps are relative to this.
+static const unsigned long long kEpoch = Timer::GetRawTicks();
+
+static std::vector<ProfileNode> lastFrame;
+static std::vector<ProfileEvent> scratch;
+
+static ProfilerThreadBuffer* GetThreadBuffer() {
+    if (threadBuffer) return threadBuffer;
+
+    std::unique_ptr<ProfilerThreadBuffer> buffer(new ProfilerThreadBuffer);
+    buffer->head.store(0, std::memory_order_relaxed);
+    buffer->depth = 0;
+    buffer->frameStart = 0;
+    buffer->threadId = GetCurrentThreadId();
+    buffer->threadName[0] = '\0';
+
+    threadBuffer = buffer.get();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(std::move(buffer));
+    return threadBuffer;
+}
+
+// Copies the events in [from, head) that have not been overwritten.
+static void Snapshot(const ProfilerThreadBuffer &buffer, unsigned long long from,
+                     std::vector<ProfileEvent> &out) {
+    const unsigned long long size = Profiler::kRingSize;
+    unsigned long long head = buffer.head.load(std::memory_order_acquire);
+    if (head > size && from < head - size) from = head - size;
+
+    out.clear();
+    for (unsigned long long i = from; i < head; ++i) {
+        out.push_back(buffer.events[i % size]);
+    }
+
+    // Anything the writer lapped while we were copying is garbage, and
+    // so is the slot it may be filling for event *after*, which
+    // overwrites event after - size.
+    unsigned long long after = buffer.head.load(std::memory_order_acquire);
+    if (after + 1 > size && after + 1 - size > from) {
+        unsigned long long torn = (std::min)(after + 1 - size - from, (unsigned long long)out.size());
+        out.erase(out.begin(), out.begin() + (size_t)torn);
+    }
+}
+
+static bool EarlierFirst(const ProfileEvent &a, const ProfileEvent &b) {
+    if (a.begin != b.begin) return a.begin < b.begin;
+    return a.depth < b.depth;
+}
+
+static void WriteEscaped(std::ofstream &out, const char *str) {
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') out << '\\';
+        out << *str;
+    }
+}
+
+std::atomic<bool> Profiler::_enabled(false);
+
+void Profiler::SetEnabled(bool value) {
+    _enabled.store(value, std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const char *name) {
+    ProfilerThreadBuffer *buffer = GetThreadBuffer();
+    strncpy_s(buffer->threadName, name, _TRUNCATE);
+}
+
+void Profiler::BeginFrame() {
+    if (!IsEnabled()) return;
+    ProfilerThreadBuffer *buffer = GetThreadBuffer();
+    buffer->frameStart = buffer->head.load(std::memory_order_relaxed);
+}
+
+void Profiler::EndFrame() {
+    if (!IsEnabled()) return;
+    ProfilerThreadBuffer *buffer = GetThreadBuffer();
+    Snapshot(*buffer, buffer->frameStart, scratch);
+
+    // Events are stored as zones close, children before their parents.
+    // Ordering by start time gives us a depth-first walk of the tree.
+    std::sort(scratch.begin(), scratch.end(), &EarlierFirst);
+
+    lastFrame.clear();
+    int path[kMaxDepth];
+    std::fill(path, path + kMaxDepth, -1);
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        const ProfileEvent &e = scratch[i];
+        int parent = (e.depth == 0) ? -1 : path[e.depth - 1];
+
+        // Merge with a sibling of the same name if there is one.
+        int node = -1;
+        for (int n = (int)lastFrame.size() - 1; n > parent; --n) {
+            if (lastFrame[n].parent == parent && lastFrame[n].name == e.name) {
+                node = n;
+                break;
+            }
+        }
+        if (node == -1) {
+            ProfileNode added = { e.name, parent, e.depth, 0, 0.0 };
+            lastFrame.push_back(added);
+            node = (int)lastFrame.size() - 1;
+        }
+
+        lastFrame[node].calls++;
+        lastFrame[node].totalSeconds += (e.end - e.begin) * Timer::GetSecondsPerTick();
+        path[e.depth] = node;
+    }
+}
+
+const std::vector<ProfileNode>& Profiler::GetLastFrame() {
+    return lastFrame;
+}
+
+bool Profiler::WriteChromeTrace(const std::string &path) {
+    std::ofstream out(path.c_str());
+    if (!out) return false;
+
+    const double toMicros = Timer::GetSecondsPerTick() * 1000000.0;
+    const DWORD pid = GetCurrentProcessId();
+    std::vector<ProfileEvent> events;
+    bool first = true;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (size_t t = 0; t < registry.size(); ++t) {
+        const ProfilerThreadBuffer &buffer = *registry[t];
+
+        if (buffer.threadName[0] != '\0') {
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+                << pid << ",\"tid\":" << buffer.threadId << ",\"args\":{\"name\":\"";
+            WriteEscaped(out, buffer.threadName);
+            out << "\"}}";
+            first = false;
+        }
+
+        Snapshot(buffer, 0, events);
+        for (size_t i = 0; i < events.size(); ++i) {
+            const ProfileEvent &e = events[i];
+            out << (first ? "" : ",") << "\n{\"name\":\"";
+            WriteEscaped(out, e.name);
+            out << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << buffer.threadId
+                << ",\"ts\":" << (e.begin - kEpoch) * toMicros
+                << ",\"dur\":" << (e.end - e.begin) * toMicros << "}";
+            first = false;
+        }
+    }
+
+    out << "\n]}\n";
+    return out.good();
+}
+
+void Profiler::BeginZone(const char *name) {
+    ProfilerThreadBuffer *buffer = GetThreadBuffer();
+    unsigned int depth = buffer->depth++;
+    if (depth >= kMaxDepth) return;
+
+    buffer->names[depth] = name;
+    buffer->begins[depth] = Timer::GetRawTicks();
+}
+
+void Profiler::EndZone() {
+    ProfilerThreadBuffer *buffer = threadBuffer;
+    assert(buffer && buffer->depth > 0 && "EndZone() without BeginZone()");
+    unsigned int depth = --buffer->depth;
+    if (depth >= kMaxDepth) return;
+
+    unsigned long long head = buffer->head.load(std::memory_order_relaxed);
+    ProfileEvent &e = buffer->events[head % kRingSize];
+    e.name = buffer->names[depth];
+    e.begin = buffer->begins[depth];
+    e.end = Timer::GetRawTicks();
+    e.depth = depth;
+
+    // Publish the event to readers.
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+const char* Profiler::GetCurrentZone() {
+    ProfilerThreadBuffer *buffer = threadBuffer;
+    if (!buffer || buffer->depth == 0) return nullptr;
+
+    // Zones past kMaxDepth aren't recorded, report the deepest that is.
+    unsigned int depth = (buffer->depth < kMaxDepth) ? buffer->depth : kMaxDepth;
+    return buffer->names[depth - 1];
+}
+
+} // namespace dx
\ No newline at end of file
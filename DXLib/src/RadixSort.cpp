@@ -0,0 +1,107 @@
+#include <RadixSort.h>
+#include <JobSystem.h>
+
+#include <cassert>
+#include <cstring>
+
+static const unsigned int kRadixBits = 8;
+static const unsigned int kRadix = 1 << kRadixBits;
+
+// Smallest block of entries worth counting and scattering on its own.
+static const UINT kMinBlockSize = 2048;
+
+namespace dx {
+
+void RadixSorter::Reserve(UINT count) {
+    _scratch.reserve(count);
+}
+
+void RadixSorter::Sort(std::vector<SortEntry> &entries, JobSystem *jobs) {
+    const UINT count = static_cast<UINT>(entries.size());
+    _scratch.resize(count);
+
+    // Keys that are the same in every entry tell which passes to skip.
+    unsigned long long andKeys = ~0ull;
+    unsigned long long orKeys = 0;
+    for (UINT i = 0; i < count; ++i) {
+        andKeys &= entries[i].key;
+        orKeys |= entries[i].key;
+    }
+    const unsigned long long varying = andKeys ^ orKeys;
+
+    UINT blockCount = 1;
+    if (jobs && jobs->IsInitialized() && count >= kParallelThreshold) {
+        blockCount = jobs->GetThreadCount() * 4;
+        if (blockCount > count / kMinBlockSize) blockCount = count / kMinBlockSize;
+        if (blockCount == 0) blockCount = 1;
+    }
+    const UINT blockSize = (count + blockCount - 1) / blockCount;
+    _histograms.resize(blockCount * kRadix);
+
+    for (unsigned int shift = 0; shift < 64; shift += kRadixBits) {
+        if (((varying >> shift) & (kRadix - 1)) == 0) continue;
+        SortPass(entries, blockCount > 1 ? jobs : nullptr, shift, blockCount, blockSize);
+        entries.swap(_scratch);
+    }
+}
+
+// Stable counting sort of *entries* into _scratch on one byte of the
+// key. Every block scatters to offsets that come after the same digit
+// in all earlier blocks, which keeps the order within a digit.
+void RadixSorter::SortPass(std::vector<SortEntry> &entries, JobSystem *jobs, unsigned int shift,
+                           UINT blockCount, UINT blockSize) {
+    const UINT count = static_cast<UINT>(entries.size());
+    const SortEntry *source = entries.empty() ? nullptr : &entries[0];
+    SortEntry *target = _scratch.empty() ? nullptr : &_scratch[0];
+    UINT *histograms = &_histograms[0];
+
+    auto countBlocks = [=](UINT first, UINT last) {
+        for (UINT block = first; block < last; ++block) {
+            UINT *histogram = histograms + block * kRadix;
+            memset(histogram, 0, kRadix * sizeof(UINT));
+
+            UINT end = (block + 1) * blockSize;
+            if (end > count) end = count;
+            for (UINT i = block * blockSize; i < end; ++i) {
+                ++histogram[(source[i].key >> shift) & (kRadix - 1)];
+            }
+        }
+    };
+
+    auto scatterBlocks = [=](UINT first, UINT last) {
+        for (UINT block = first; block < last; ++block) {
+            UINT *offsets = histograms + block * kRadix;
+
+            UINT end = (block + 1) * blockSize;
+            if (end > count) end = count;
+            for (UINT i = block * blockSize; i < end; ++i) {
+                target[offsets[(source[i].key >> shift) & (kRadix - 1)]++] = source[i];
+            }
+        }
+    };
+
+    if (jobs) {
+        jobs->ParallelFor(0, blockCount, 1, countBlocks);
+    } else {
+        countBlocks(0, blockCount);
+    }
+
+    // Exclusive prefix sum, digit major and block minor.
+    UINT offset = 0;
+    for (UINT digit = 0; digit < kRadix; ++digit) {
+        for (UINT block = 0; block < blockCount; ++block) {
+            UINT n = histograms[block * kRadix + digit];
+            histograms[block * kRadix + digit] = offset;
+            offset += n;
+        }
+    }
+    assert(offset == count);
+
+    if (jobs) {
+        jobs->ParallelFor(0, blockCount, 1, scatterBlocks);
+    } else {
+        scatterBlocks(0, blockCount);
+    }
+}
+
+} // namespace dx
\ No newline at end of file
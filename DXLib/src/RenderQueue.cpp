@@ -0,0 +1,104 @@
+#include <RenderQueue.h>
+#include <Profiler.h>
+#include <RenderSystem.h>
+#include <Timer.h>
+
+#include <cassert>
+
+static double SecondsSince(unsigned long long startTicks) {
+    return (dx::Timer::GetRawTicks() - startTicks) * dx::Timer::GetSecondsPerTick();
+}
+
+namespace dx {
+
+RenderQueue::RenderQueue() {
+    _isSorted = false;
+}
+
+RenderQueue::~RenderQueue() {
+
+}
+
+void RenderQueue::Reserve(UINT items) {
+    _items.reserve(items);
+    _sorted.reserve(items);
+    _sorter.Reserve(items);
+}
+
+void RenderQueue::Clear() {
+    _items.clear();
+    _sorted.clear();
+    _isSorted = false;
+}
+
+void RenderQueue::Push(unsigned long long key, const DrawCommand &command) {
+    RenderItem item;
+    item.key = key;
+    item.command = command;
+    _items.push_back(item);
+    _isSorted = false;
+}
+
+void RenderQueue::Sort(JobSystem *jobs) {
+    DX_PROFILE_SCOPE("RenderQueue::Sort");
+    unsigned long long start = Timer::GetRawTicks();
+
+    const UINT count = GetCount();
+    _sorted.resize(count);
+    for (UINT i = 0; i < count; ++i) {
+        _sorted[i].key = _items[i].key;
+        _sorted[i].index = i;
+    }
+    _sorter.Sort(_sorted, jobs);
+
+    _isSorted = true;
+    _stats.items = count;
+    _stats.sortSeconds = SecondsSince(start);
+}
+
+void RenderQueue::Submit(RenderSystem &r, RenderQueueBinder *binder) {
+    assert(_isSorted && "Sort() the queue before submitting it");
+    DX_PROFILE_SCOPE("RenderQueue::Submit");
+    unsigned long long start = Timer::GetRawTicks();
+
+    _stats.passChanges = 0;
+    _stats.materialChanges = 0;
+    _stats.meshChanges = 0;
+
+    bool first = true;
+    unsigned long long last = 0;
+    for (UINT i = 0; i < GetCount(); ++i) {
+        const RenderItem &item = _items[_sorted[i].index];
+        const unsigned long long key = item.key;
+
+        // Layer and pass decide everything below them.
+        const unsigned long long passMask = ~0ull << RenderKey::kPassShift;
+        const unsigned long long materialMask = ((1ull << RenderKey::kMaterialBits) - 1) << RenderKey::kMaterialShift;
+        const unsigned long long meshMask = ((1ull << RenderKey::kMeshBits) - 1) << RenderKey::kMeshShift;
+
+        bool newPass = first || ((key ^ last) & passMask) != 0;
+        bool newMaterial = newPass || ((key ^ last) & materialMask) != 0;
+        bool newMesh = newPass || ((key ^ last) & meshMask) != 0;
+
+        if (newPass) {
+            ++_stats.passChanges;
+            if (binder) binder->BindPass(r, RenderKey::GetLayer(key), RenderKey::GetPass(key));
+        }
+        if (newMaterial) {
+            ++_stats.materialChanges;
+            if (binder) binder->BindMaterial(r, RenderKey::GetMaterial(key));
+        }
+        if (newMesh) {
+            ++_stats.meshChanges;
+            if (binder) binder->BindMesh(r, RenderKey::GetMesh(key));
+        }
+
+        r.Draw(item.command);
+        last = key;
+        first = false;
+    }
+
+    _stats.submitSeconds = SecondsSince(start);
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include <SoftwareRenderSystem.h>
+#include <Profiler.h>
+#include <Window.h>
+
+#include <cstring>
+
+namespace dx {
+
+SoftwareRenderSystem::SoftwareRenderSystem() {
+    _presentWindow = NULL;
+}
+
+SoftwareRenderSystem::~SoftwareRenderSystem() {
+
+}
+
+Error::E SoftwareRenderSystem::Initialize(const Window *window, UINT width, UINT height, JobSystem *jobs) {
+    if (window) {
+        width = window->GetWidth();
+        height = window->GetHeight();
+        _presentWindow = window->GetHandle();
+    }
+
+    return _renderer.Initialize(width, height, jobs);
+}
+
+void SoftwareRenderSystem::Clear(const Vector4f &color) {
+    _renderer.Clear(color);
+}
+
+void SoftwareRenderSystem::Draw(const DrawCommand &command) {
+    CountDrawCall();
+    _renderer.Draw(command);
+}
+
+void SoftwareRenderSystem::Present() {
+    _renderer.Flush();
+    if (_presentWindow) {
+        CopyToWindow();
+    }
+
+    EndFrameCounters();
+}
+
+void SoftwareRenderSystem::CopyToWindow() {
+    DX_PROFILE_SCOPE("CopyToWindow");
+
+    // Top-down DIB, rows are a pitch apart.
+    BITMAPINFO info;
+    memset(&info, 0, sizeof(info));
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = _renderer.GetPitch();
+    info.bmiHeader.biHeight = -static_cast<LONG>(_renderer.GetHeight());
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    HDC dc = GetDC(_presentWindow);
+    SetDIBitsToDevice(dc, 0, 0, _renderer.GetWidth(), _renderer.GetHeight(),
+                      0, 0, 0, _renderer.GetHeight(), _renderer.GetColorBuffer(),
+                      &info, DIB_RGB_COLORS);
+    ReleaseDC(_presentWindow, dc);
+}
+
+} // namespace dx
\ No newline at end of file
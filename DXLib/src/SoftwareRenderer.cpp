@@ -0,0 +1,358 @@
+#include <SoftwareRenderer.h>
+#include <JobSystem.h>
+#include <Profiler.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <malloc.h>
+#include <emmintrin.h>
+
+// Triangles with a vertex this close to the eye are dropped, there's
+// no near plane clipping.
+static const float kMinW = 1e-5f;
+
+// Converts a PackColor() value to the framebuffer's layout.
+static UINT SwapRedBlue(UINT color) {
+    return (color & 0xFF00FF00) | ((color & 0xFF) << 16) | ((color >> 16) & 0xFF);
+}
+
+namespace dx {
+
+SoftwareRenderer::SoftwareRenderer() {
+    _width = 0;
+    _height = 0;
+    _pitch = 0;
+    _tilesX = 0;
+    _tilesY = 0;
+    _color = nullptr;
+    _depth = nullptr;
+    _jobs = nullptr;
+    _clearPending = false;
+    _clearColor = 0;
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    Shutdown();
+}
+
+Error::E SoftwareRenderer::Initialize(UINT width, UINT height, JobSystem *jobs) {
+    assert(!IsInitialized() && "SoftwareRenderer already initialized");
+    assert(width > 0 && height > 0);
+
+    _width = width;
+    _height = height;
+    // Rows start 16 byte aligned, so 4 pixels load at once.
+    _pitch = (width + 3) & ~3u;
+    _tilesX = (width + kTileSize - 1) / kTileSize;
+    _tilesY = (height + kTileSize - 1) / kTileSize;
+    _jobs = jobs;
+
+    _color = static_cast<UINT*>(_aligned_malloc(_pitch * height * sizeof(UINT), 16));
+    _depth = static_cast<float*>(_aligned_malloc(_pitch * height * sizeof(float), 16));
+    if (!_color || !_depth) {
+        Shutdown();
+        return Error::RENDER_INIT_FAIL;
+    }
+
+    _bins.resize(_tilesX * _tilesY);
+
+    // Start out cleared to black.
+    _clearPending = true;
+    _clearColor = 0;
+    Flush();
+    return Error::OK;
+}
+
+void SoftwareRenderer::Shutdown() {
+    _aligned_free(_color);
+    _aligned_free(_depth);
+    _color = nullptr;
+    _depth = nullptr;
+    _triangles.clear();
+    _bins.clear();
+}
+
+void SoftwareRenderer::Clear(const Vector4f &color) {
+    if (!_triangles.empty()) {
+        Flush();
+    }
+    _clearPending = true;
+    _clearColor = SwapRedBlue(PackColor(color));
+}
+
+void SoftwareRenderer::Draw(const DrawCommand &command) {
+    assert(IsInitialized());
+
+    _clip.resize(command.vertexCount);
+    for (UINT i = 0; i < command.vertexCount; ++i) {
+        _clip[i] = command.transform.Transform(Vector4f(command.vertices[i].position));
+    }
+
+    Vector4f clip[3];
+    UINT colors[3];
+    if (command.indices) {
+        for (UINT i = 0; i + 2 < command.indexCount; i += 3) {
+            for (UINT v = 0; v < 3; ++v) {
+                UINT index = command.indices[i + v];
+                assert(index < command.vertexCount);
+                clip[v] = _clip[index];
+                colors[v] = command.vertices[index].color;
+            }
+            SetupTriangle(clip, colors);
+        }
+    } else {
+        for (UINT i = 0; i + 2 < command.vertexCount; i += 3) {
+            for (UINT v = 0; v < 3; ++v) {
+                clip[v] = _clip[i + v];
+                colors[v] = command.vertices[i + v].color;
+            }
+            SetupTriangle(clip, colors);
+        }
+    }
+}
+
+void SoftwareRenderer::SetupTriangle(const Vector4f *clip, const UINT *colors) {
+    float x[3], y[3], attributes[3][5];
+    for (int i = 0; i < 3; ++i) {
+        if (clip[i].w < kMinW) return;
+
+        float invW = 1.0f / clip[i].w;
+        x[i] = (clip[i].x * invW * 0.5f + 0.5f) * _width;
+        y[i] = (0.5f - clip[i].y * invW * 0.5f) * _height;
+
+        UINT color = colors[i];
+        attributes[i][0] = clip[i].z * invW;
+        attributes[i][1] = static_cast<float>((color >> 16) & 0xFF);
+        attributes[i][2] = static_cast<float>((color >> 8) & 0xFF);
+        attributes[i][3] = static_cast<float>(color & 0xFF);
+        attributes[i][4] = static_cast<float>(color >> 24);
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.0f) return;
+
+    // Clipped before converting, vertices may be far off screen.
+    float minX = std::max(std::min(x[0], std::min(x[1], x[2])), 0.0f);
+    float minY = std::max(std::min(y[0], std::min(y[1], y[2])), 0.0f);
+    float maxX = std::min(std::max(x[0], std::max(x[1], x[2])), _width - 1.0f);
+    float maxY = std::min(std::max(y[0], std::max(y[1], y[2])), _height - 1.0f);
+    if (minX > maxX || minY > maxY) return;
+
+    Triangle t;
+    t.minX = static_cast<int>(std::floor(minX));
+    t.minY = static_cast<int>(std::floor(minY));
+    t.maxX = static_cast<int>(std::ceil(maxX));
+    t.maxY = static_cast<int>(std::ceil(maxY));
+
+    // Edge i lies opposite vertex i and equals the area at it. Flipping
+    // the sign of clockwise triangles makes the inside positive.
+    float sign = (area > 0.0f) ? 1.0f : -1.0f;
+    float invArea = 1.0f / (area * sign);
+    for (int i = 0; i < 5; ++i) {
+        t.planeA[i] = t.planeB[i] = t.planeC[i] = 0.0f;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3, k = (i + 2) % 3;
+        float a = (y[j] - y[k]) * sign;
+        float b = (x[k] - x[j]) * sign;
+        float c = (x[j] * y[k] - x[k] * y[j]) * sign;
+        // Evaluated at pixel centers.
+        c += 0.5f * a + 0.5f * b;
+
+        t.edgeA[i] = a;
+        t.edgeB[i] = b;
+        t.edgeC[i] = c;
+        t.topLeft[i] = (a > 0.0f) || (a == 0.0f && b > 0.0f);
+
+        // Barycentric weight of vertex i is edge i over the area.
+        for (int p = 0; p < 5; ++p) {
+            float value = attributes[i][p] * invArea;
+            t.planeA[p] += a * value;
+            t.planeB[p] += b * value;
+            t.planeC[p] += c * value;
+        }
+    }
+
+    _triangles.push_back(t);
+    BinTriangle(static_cast<UINT>(_triangles.size() - 1));
+}
+
+void SoftwareRenderer::BinTriangle(UINT index) {
+    const Triangle &t = _triangles[index];
+    int tx0 = t.minX / kTileSize, tx1 = t.maxX / kTileSize;
+    int ty0 = t.minY / kTileSize, ty1 = t.maxY / kTileSize;
+    bool single = (tx0 == tx1 && ty0 == ty1);
+
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            if (!single) {
+                // Skip tiles entirely outside one of the edges, tested
+                // at the corner furthest inside.
+                float minX = static_cast<float>(tx * kTileSize);
+                float minY = static_cast<float>(ty * kTileSize);
+                float maxX = minX + kTileSize - 1;
+                float maxY = minY + kTileSize - 1;
+
+                bool outside = false;
+                for (int e = 0; e < 3 && !outside; ++e) {
+                    float cx = (t.edgeA[e] > 0.0f) ? maxX : minX;
+                    float cy = (t.edgeB[e] > 0.0f) ? maxY : minY;
+                    outside = (t.edgeA[e] * cx + t.edgeB[e] * cy + t.edgeC[e]) < 0.0f;
+                }
+                if (outside) continue;
+            }
+            _bins[ty * _tilesX + tx].push_back(index);
+        }
+    }
+}
+
+void SoftwareRenderer::Flush() {
+    if (_triangles.empty() && !_clearPending) return;
+    DX_PROFILE_FUNCTION();
+
+    UINT tileCount = _tilesX * _tilesY;
+    if (_jobs && _jobs->IsInitialized()) {
+        // Tiles don't share pixels, so they need no synchronization.
+        _jobs->ParallelFor(0, tileCount, 1, [this](UINT first, UINT last) {
+            for (UINT tile = first; tile < last; ++tile) {
+                RasterizeTile(tile);
+            }
+        });
+    } else {
+        for (UINT tile = 0; tile < tileCount; ++tile) {
+            RasterizeTile(tile);
+        }
+    }
+
+    for (size_t i = 0; i < _bins.size(); ++i) {
+        _bins[i].clear();
+    }
+    _triangles.clear();
+    _clearPending = false;
+}
+
+void SoftwareRenderer::RasterizeTile(UINT tile) {
+    const int tileX0 = (tile % _tilesX) * kTileSize;
+    const int tileY0 = (tile / _tilesX) * kTileSize;
+    const int tileX1 = std::min(tileX0 + static_cast<int>(kTileSize), static_cast<int>(_width)) - 1;
+    const int tileY1 = std::min(tileY0 + static_cast<int>(kTileSize), static_cast<int>(_height)) - 1;
+
+    if (_clearPending) {
+        // Includes the row padding past the last tile.
+        int end = std::min(tileX0 + static_cast<int>(kTileSize), static_cast<int>(_pitch));
+        for (int y = tileY0; y <= tileY1; ++y) {
+            std::fill(_color + y * _pitch + tileX0, _color + y * _pitch + end, _clearColor);
+            std::fill(_depth + y * _pitch + tileX0, _depth + y * _pitch + end, 1.0f);
+        }
+    }
+
+    const std::vector<UINT> &bin = _bins[tile];
+    const __m128 offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxChannel = _mm_set1_ps(255.0f);
+
+    for (size_t n = 0; n < bin.size(); ++n) {
+        const Triangle &t = _triangles[bin[n]];
+
+        // Groups of 4 start aligned, tiles are a multiple of 4 wide.
+        int x0 = std::max(t.minX, tileX0) & ~3;
+        int x1 = std::min(t.maxX, tileX1);
+        int y0 = std::max(t.minY, tileY0);
+        int y1 = std::min(t.maxY, tileY1);
+
+        __m128 edgeA[3], topLeft[3];
+        for (int e = 0; e < 3; ++e) {
+            edgeA[e] = _mm_set1_ps(t.edgeA[e]);
+            topLeft[e] = _mm_castsi128_ps(_mm_set1_epi32(t.topLeft[e] ? -1 : 0));
+        }
+        __m128 planeA[5];
+        for (int p = 0; p < 5; ++p) {
+            planeA[p] = _mm_set1_ps(t.planeA[p]);
+        }
+
+        for (int y = y0; y <= y1; ++y) {
+            float fy = static_cast<float>(y);
+            __m128 edgeRow[3], planeRow[5];
+            for (int e = 0; e < 3; ++e) {
+                edgeRow[e] = _mm_set1_ps(t.edgeB[e] * fy + t.edgeC[e]);
+            }
+            for (int p = 0; p < 5; ++p) {
+                planeRow[p] = _mm_set1_ps(t.planeB[p] * fy + t.planeC[p]);
+            }
+
+            UINT *colorRow = _color + y * _pitch;
+            float *depthRow = _depth + y * _pitch;
+
+            for (int x = x0; x <= x1; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+
+                // Inside when all edges are positive, or zero on a
+                // top-left edge.
+                __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int e = 0; e < 3; ++e) {
+                    __m128 value = _mm_add_ps(_mm_mul_ps(edgeA[e], px), edgeRow[e]);
+                    __m128 inside = _mm_or_ps(_mm_cmpgt_ps(value, zero),
+                                              _mm_and_ps(_mm_cmpeq_ps(value, zero), topLeft[e]));
+                    mask = _mm_and_ps(mask, inside);
+                }
+                if (_mm_movemask_ps(mask) == 0) continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(planeA[0], px), planeRow[0]);
+                __m128 oldDepth = _mm_load_ps(depthRow + x);
+                mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmplt_ps(z, oldDepth), _mm_cmpge_ps(z, zero)));
+                if (_mm_movemask_ps(mask) == 0) continue;
+
+                _mm_store_ps(depthRow + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, oldDepth)));
+
+                __m128i pixels = _mm_setzero_si128();
+                for (int p = 1; p < 5; ++p) {
+                    __m128 channel = _mm_add_ps(_mm_mul_ps(planeA[p], px), planeRow[p]);
+                    channel = _mm_min_ps(_mm_max_ps(channel, zero), maxChannel);
+                    __m128i bits = _mm_cvtps_epi32(channel);
+                    pixels = _mm_or_si128(pixels, _mm_slli_epi32(bits, (p - 1) * 8));
+                }
+
+                __m128i *target = reinterpret_cast<__m128i*>(colorRow + x);
+                __m128i write = _mm_castps_si128(mask);
+                __m128i old = _mm_load_si128(target);
+                _mm_store_si128(target, _mm_or_si128(_mm_and_si128(write, pixels), _mm_andnot_si128(write, old)));
+            }
+        }
+    }
+}
+
+unsigned long long SoftwareRenderer::HashColorBuffer() const {
+    unsigned long long hash = 14695981039346656037ull;
+    for (UINT y = 0; y < _height; ++y) {
+        const unsigned char *row = reinterpret_cast<const unsigned char*>(_color + y * _pitch);
+        for (UINT i = 0; i < _width * sizeof(UINT); ++i) {
+            hash ^= row[i];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+bool SoftwareRenderer::WriteImage(const std::string &path) const {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) return false;
+
+    out << "P6\n" << _width << " " << _height << "\n255\n";
+
+    std::vector<char> row(_width * 3);
+    for (UINT y = 0; y < _height; ++y) {
+        for (UINT x = 0; x < _width; ++x) {
+            UINT pixel = _color[y * _pitch + x];
+            row[x * 3 + 0] = static_cast<char>(pixel >> 16);
+            row[x * 3 + 1] = static_cast<char>(pixel >> 8);
+            row[x * 3 + 2] = static_cast<char>(pixel);
+        }
+        out.write(&row[0], row.size());
+    }
+    return out.good();
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <SpriteBatch.h>
+#include <JobSystem.h>
+#include <Profiler.h>
+#include <RenderQueue.h>
+#include <RenderSystem.h>
+#include <Timer.h>
+
+#include <cassert>
+#include <cmath>
+#include <xmmintrin.h>
+
+// Sprites expanded per job.
+static const UINT kExpandGrain = 4096;
+
+static double SecondsSince(unsigned long long startTicks) {
+    return (dx::Timer::GetRawTicks() - startTicks) * dx::Timer::GetSecondsPerTick();
+}
+
+// Layer and texture in the top 32 bits, the rest is never sorted on.
+static unsigned long long SpriteKey(const dx::Sprite &sprite) {
+    return (static_cast<unsigned long long>(sprite.layer) << 56) |
+           (static_cast<unsigned long long>(sprite.texture) << 32);
+}
+
+namespace dx {
+
+SpriteBatch::SpriteBatch() {
+    _scaleX = 0.0f;
+    _scaleY = 0.0f;
+    _drawing = false;
+
+    _indices.resize(kMaxSpritesPerDraw * 6);
+    for (UINT i = 0; i < kMaxSpritesPerDraw; ++i) {
+        UINT *quad = &_indices[i * 6];
+        UINT base = i * 4;
+        quad[0] = base;
+        quad[1] = base + 1;
+        quad[2] = base + 2;
+        quad[3] = base;
+        quad[4] = base + 2;
+        quad[5] = base + 3;
+    }
+}
+
+SpriteBatch::~SpriteBatch() {
+
+}
+
+void SpriteBatch::Reserve(UINT sprites) {
+    _sprites.reserve(sprites);
+    _order.reserve(sprites);
+    _sorter.Reserve(sprites);
+    _vertices.reserve(sprites * 4);
+}
+
+void SpriteBatch::Begin(UINT width, UINT height) {
+    assert(!_drawing && "SpriteBatch::Begin() called twice");
+    assert(width > 0 && height > 0);
+    _scaleX = 2.0f / width;
+    _scaleY = 2.0f / height;
+    _sprites.clear();
+    _drawing = true;
+}
+
+void SpriteBatch::Draw(const Sprite &sprite) {
+    assert(_drawing && "SpriteBatch::Draw() outside Begin() and End()");
+    assert(sprite.layer < kMaxLayers && sprite.texture < kMaxTextures);
+    _sprites.push_back(sprite);
+}
+
+void SpriteBatch::Draw(const RectangleF &dest, UINT color, UINT texture, UINT layer) {
+    Sprite sprite;
+    sprite.dest = dest;
+    sprite.color = color;
+    sprite.texture = texture;
+    sprite.layer = layer;
+    Draw(sprite);
+}
+
+void SpriteBatch::End(RenderSystem &r, JobSystem *jobs, RenderQueueBinder *binder) {
+    assert(_drawing && "SpriteBatch::End() without Begin()");
+    DX_PROFILE_SCOPE("SpriteBatch::End");
+    _drawing = false;
+    _stats.Reset();
+
+    const UINT count = GetCount();
+    _stats.sprites = count;
+    if (count == 0) return;
+
+    unsigned long long start = Timer::GetRawTicks();
+    _order.resize(count);
+    for (UINT i = 0; i < count; ++i) {
+        _order[i].key = SpriteKey(_sprites[i]);
+        _order[i].index = i;
+    }
+    _sorter.Sort(_order, jobs);
+    _stats.sortSeconds = SecondsSince(start);
+
+    start = Timer::GetRawTicks();
+    _vertices.resize(count * 4);
+    if (jobs && jobs->IsInitialized()) {
+        jobs->ParallelFor(0, count, kExpandGrain, [this](UINT first, UINT last) {
+            Expand(first, last);
+        });
+    } else {
+        Expand(0, count);
+    }
+    _stats.expandSeconds = SecondsSince(start);
+
+    start = Timer::GetRawTicks();
+    Submit(r, binder);
+    _stats.submitSeconds = SecondsSince(start);
+}
+
+// Writes the corners of the sprites at sorted positions [first, last),
+// clockwise from the top left.
+void SpriteBatch::Expand(UINT first, UINT last) {
+    const __m128 scaleX = _mm_set1_ps(_scaleX);
+    const __m128 scaleY = _mm_set1_ps(_scaleY);
+    const __m128 one = _mm_set1_ps(1.0f);
+    // Corner signs around the center, x and y.
+    const __m128 signX = _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f);
+    const __m128 signY = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+
+    __declspec(align(16)) float xs[4];
+    __declspec(align(16)) float ys[4];
+
+    for (UINT i = first; i < last; ++i) {
+        const Sprite &sprite = _sprites[_order[i].index];
+        const RectangleF &dest = sprite.dest;
+
+        __m128 halfW = _mm_set1_ps(dest.w * 0.5f);
+        __m128 halfH = _mm_set1_ps(dest.h * 0.5f);
+        __m128 centerX = _mm_set1_ps(dest.x + dest.w * 0.5f);
+        __m128 centerY = _mm_set1_ps(dest.y + dest.h * 0.5f);
+        __m128 offsetX = _mm_mul_ps(signX, halfW);
+        __m128 offsetY = _mm_mul_ps(signY, halfH);
+
+        __m128 x, y;
+        if (sprite.rotation != 0.0f) {
+            __m128 c = _mm_set1_ps(cosf(sprite.rotation));
+            __m128 s = _mm_set1_ps(sinf(sprite.rotation));
+            x = _mm_add_ps(centerX, _mm_sub_ps(_mm_mul_ps(offsetX, c), _mm_mul_ps(offsetY, s)));
+            y = _mm_add_ps(centerY, _mm_add_ps(_mm_mul_ps(offsetX, s), _mm_mul_ps(offsetY, c)));
+        } else {
+            x = _mm_add_ps(centerX, offsetX);
+            y = _mm_add_ps(centerY, offsetY);
+        }
+
+        // Pixels to clip space, y pointing up.
+        _mm_store_ps(xs, _mm_sub_ps(_mm_mul_ps(x, scaleX), one));
+        _mm_store_ps(ys, _mm_sub_ps(one, _mm_mul_ps(y, scaleY)));
+
+        Vertex *v = &_vertices[i * 4];
+        for (int corner = 0; corner < 4; ++corner) {
+            v[corner].position = Vector3f(xs[corner], ys[corner], sprite.depth);
+            v[corner].color = sprite.color;
+        }
+    }
+}
+
+// One draw per run of equal layer and texture, split where a run is
+// longer than a draw may be.
+void SpriteBatch::Submit(RenderSystem &r, RenderQueueBinder *binder) {
+    const UINT count = GetCount();
+
+    UINT start = 0;
+    while (start < count) {
+        const unsigned long long key = _order[start].key;
+        const Sprite &sprite = _sprites[_order[start].index];
+        if (start == 0 || key != _order[start - 1].key) {
+            ++_stats.textureChanges;
+            if (binder) {
+                if (start == 0 || sprite.layer != _sprites[_order[start - 1].index].layer) {
+                    binder->BindPass(r, sprite.layer, 0);
+                }
+                binder->BindMaterial(r, sprite.texture);
+            }
+        }
+
+        UINT end = start + 1;
+        while (end < count && end - start < kMaxSpritesPerDraw && _order[end].key == key) {
+            ++end;
+        }
+
+        DrawCommand command;
+        command.vertices = &_vertices[start * 4];
+        command.vertexCount = (end - start) * 4;
+        command.indices = &_indices[0];
+        command.indexCount = (end - start) * 6;
+        r.Draw(command);
+        ++_stats.draws;
+
+        start = end;
+    }
+}
+
+} // namespace dx
\ No newline at end of file
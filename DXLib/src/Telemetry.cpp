@@ -0,0 +1,174 @@
+#include <Telemetry.h>
+#include <Profiler.h>
+#include <Timer.h>
+
+#include <Windows.h>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static_assert(sizeof(dx::TelemetryFileHeader) == 64, "Telemetry file layout changed");
+static_assert(sizeof(dx::TelemetryFileEntry) == 64, "Telemetry file layout changed");
+
+namespace dx {
+
+// Each metric on its own cache line, so threads updating different
+// metrics don't contend.
+__declspec(align(64)) struct TelemetrySlot {
+    std::atomic<long long> value;
+    TelemetryKind::E kind;
+    char name[TelemetryFileEntry::kNameLength];
+};
+
+static TelemetrySlot slots[Telemetry::kMaxMetrics];
+// Slots below this are fully written, published with release.
+static std::atomic<unsigned int> slotCount(0);
+static std::mutex registerMutex;
+
+// Publisher state, guarded by publishMutex.
+static std::mutex publishMutex;
+static std::condition_variable publishSignal;
+static std::thread publishThread;
+static bool publishQuit = false;
+static unsigned int publishInterval = 100;
+static HANDLE file = INVALID_HANDLE_VALUE;
+static HANDLE mapping = NULL;
+static TelemetryFileHeader *header = nullptr;
+
+std::atomic<long long> Telemetry::_discard(0);
+
+static void Publish(unsigned long long startTicks) {
+    TelemetryFileEntry *entries = reinterpret_cast<TelemetryFileEntry*>(header + 1);
+    unsigned int count = slotCount.load(std::memory_order_acquire);
+
+    InterlockedIncrement(&header->sequence);
+    for (unsigned int i = 0; i < count; ++i) {
+        TelemetryFileEntry &entry = entries[i];
+        long long bits = slots[i].value.load(std::memory_order_relaxed);
+
+        memcpy(entry.name, slots[i].name, sizeof(entry.name));
+        entry.kind = static_cast<unsigned int>(slots[i].kind);
+        if (slots[i].kind == TelemetryKind::GAUGE) {
+            memcpy(&entry.value, &bits, sizeof(entry.value));
+        } else {
+            entry.value = static_cast<double>(bits);
+        }
+    }
+    header->count = count;
+    header->publishCount++;
+    header->uptime = (Timer::GetRawTicks() - startTicks) * Timer::GetSecondsPerTick();
+    InterlockedIncrement(&header->sequence);
+}
+
+static void PublishThreadMain() {
+    Profiler::SetThreadName("Telemetry");
+
+    unsigned long long start = Timer::GetRawTicks();
+    std::unique_lock<std::mutex> lock(publishMutex);
+    while (!publishQuit) {
+        Publish(start);
+        publishSignal.wait_for(lock, std::chrono::milliseconds(publishInterval));
+    }
+    // One last time, so short runs still leave their totals behind.
+    Publish(start);
+}
+
+static void CloseFile() {
+    if (header) UnmapViewOfFile(header);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    header = nullptr;
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+}
+
+TelemetryCounter Telemetry::Counter(const char *name) {
+    return TelemetryCounter(Register(name, TelemetryKind::COUNTER));
+}
+
+TelemetryGauge Telemetry::Gauge(const char *name) {
+    return TelemetryGauge(Register(name, TelemetryKind::GAUGE));
+}
+
+std::atomic<long long>* Telemetry::Register(const char *name, TelemetryKind::E kind) {
+    std::lock_guard<std::mutex> lock(registerMutex);
+
+    unsigned int count = slotCount.load(std::memory_order_relaxed);
+    for (unsigned int i = 0; i < count; ++i) {
+        if (strncmp(slots[i].name, name, TelemetryFileEntry::kNameLength - 1) == 0) {
+            assert(slots[i].kind == kind && "Metric registered as counter and gauge");
+            return &slots[i].value;
+        }
+    }
+
+    if (count == kMaxMetrics) {
+        assert(false && "Too many telemetry metrics");
+        return &_discard;
+    }
+
+    TelemetrySlot &slot = slots[count];
+    slot.value.store(0, std::memory_order_relaxed);
+    slot.kind = kind;
+    strncpy_s(slot.name, name, _TRUNCATE);
+    slotCount.store(count + 1, std::memory_order_release);
+    return &slot.value;
+}
+
+Error::E Telemetry::StartPublishing(const std::string &path, unsigned int intervalMs) {
+    assert(!IsPublishing() && "Telemetry already publishing");
+
+    const DWORD size = sizeof(TelemetryFileHeader) + sizeof(TelemetryFileEntry) * kMaxMetrics;
+
+    // Readers keep the file mapped while we write to it, and a mapped
+    // file can't be truncated. It always has the same size anyway, so a
+    // viewer left open picks up the next run.
+    file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                       FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                       OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return Error::FILE_OPEN_FAIL;
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, size, NULL);
+    if (mapping) {
+        header = static_cast<TelemetryFileHeader*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+    }
+    if (!header) {
+        CloseFile();
+        return Error::FILE_OPEN_FAIL;
+    }
+
+    memset(header, 0, size);
+    header->magic = TelemetryFileHeader::kMagic;
+    header->version = TelemetryFileHeader::kVersion;
+    header->capacity = kMaxMetrics;
+    header->intervalMs = intervalMs;
+
+    publishInterval = intervalMs;
+    publishQuit = false;
+    publishThread = std::thread(&PublishThreadMain);
+    return Error::OK;
+}
+
+void Telemetry::StopPublishing() {
+    if (!IsPublishing()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        publishQuit = true;
+    }
+    publishSignal.notify_all();
+    publishThread.join();
+
+    CloseFile();
+}
+
+bool Telemetry::IsPublishing() {
+    return publishThread.joinable();
+}
+
+unsigned int Telemetry::GetMetricCount() {
+    return slotCount.load(std::memory_order_acquire);
+}
+
+} // namespace dx
\ No newline at end of file
@@ -2,6 +2,11 @@
 #include <windows.h>
 #include <cassert>
 
+static double QuerySecondsPerTick();
+
+// Resolved once during static initialization.
+static const double kSecondsPerTick = QuerySecondsPerTick();
+
 namespace dx {
 
 Timer::Timer() {
@@ -75,4 +80,29 @@ void Timer::Tick() {
     _totalSeconds += _deltaSeconds;
 }
 
-} // namespace dx
\ No newline at end of file
+void Timer::Advance(double seconds) {
+    assert(_isRunning);
+
+    if (_isPaused) return;
+
+    _deltaSeconds = seconds;
+    _totalSeconds += _deltaSeconds;
+}
+
+unsigned long long Timer::GetRawTicks() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return static_cast<unsigned long long>(now.QuadPart);
+}
+
+double Timer::GetSecondsPerTick() {
+    return kSecondsPerTick;
+}
+
+} // namespace dx
+
+static double QuerySecondsPerTick() {
+    LARGE_INTEGER frequency;
+    if (!QueryPerformanceFrequency(&frequency)) return 0.0;
+    return 1.0 / static_cast<double>(frequency.QuadPart);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <Transform.h>
+
+namespace dx {
+
+MovementSystem::MovementSystem() : System("MovementSystem") {
+    Reads<Velocity>();
+    Writes<Transform>();
+}
+
+void MovementSystem::Update(World &world, CommandBuffer &commands,
+                            JobSystem &jobs, const Timer &timer) {
+    const float dt = static_cast<float>(timer.GetDeltaSeconds());
+
+    world.ParallelForEach<Transform, Velocity>(jobs,
+        [dt](Entity entity, Transform &transform, Velocity &velocity) {
+            transform.position += velocity.linear * dt;
+            transform.rotation += velocity.angular * dt;
+        });
+}
+
+TransformSystem::TransformSystem() : System("TransformSystem") {
+    Reads<Transform>();
+    Writes<LocalToWorld>();
+}
+
+void TransformSystem::Update(World &world, CommandBuffer &commands,
+                             JobSystem &jobs, const Timer &timer) {
+    world.ParallelForEach<Transform, LocalToWorld>(jobs,
+        [](Entity entity, Transform &transform, LocalToWorld &localToWorld) {
+            localToWorld.matrix = Mat4x4::CreateScale(transform.scale.x, transform.scale.y, transform.scale.z) *
+                           Mat4x4::CreateRotationX(transform.rotation.x) *
+                           Mat4x4::CreateRotationY(transform.rotation.y) *
+                           Mat4x4::CreateRotationZ(transform.rotation.z) *
+                           Mat4x4::CreateTranslation(transform.position);
+        });
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <UploadRing.h>
+
+#include <cassert>
+
+namespace dx {
+
+UploadRing::UploadRing() {
+    _capacity = 0;
+    Reset();
+}
+
+void UploadRing::Initialize(UINT capacity) {
+    _capacity = capacity;
+    Reset();
+    _stats.Reset();
+    _stats.capacity = capacity;
+}
+
+void UploadRing::Reset() {
+    _head = 0;
+    _used = 0;
+    _firstFrame = 0;
+    _frameCount = 0;
+    _currentBytes = 0;
+    _currentAllocations = 0;
+}
+
+UINT UploadRing::Allocate(UINT size, UINT alignment) {
+    UINT offset, consumed;
+    bool wrap;
+    Place(size, alignment, offset, consumed, wrap);
+    if (_used + consumed > _capacity) return kNoSpace;
+
+    _head = offset + size;
+    if (_head == _capacity) _head = 0;
+    _used += consumed;
+    _currentBytes += consumed;
+    ++_currentAllocations;
+
+    if (wrap) ++_stats.wraps;
+    if (_used > _stats.peakBytes) _stats.peakBytes = _used;
+    return offset;
+}
+
+bool UploadRing::Fits(UINT size, UINT alignment) const {
+    UINT offset, consumed;
+    bool wrap;
+    Place(size, alignment, offset, consumed, wrap);
+    return _used + consumed <= _capacity;
+}
+
+void UploadRing::Place(UINT size, UINT alignment, UINT &offset, UINT &consumed, bool &wrap) const {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    assert(size <= _capacity && "Allocation larger than the ring");
+
+    // Nothing in use, start over rather than wrap needlessly.
+    UINT head = _used == 0 ? 0 : _head;
+
+    // Allocations are contiguous, what doesn't fit at the end starts
+    // over at 0 and the rest of the end is skipped.
+    offset = (head + alignment - 1) & ~(alignment - 1);
+    wrap = offset + size > _capacity || offset < head;
+    if (wrap) offset = 0;
+
+    consumed = wrap ? (_capacity - head) + size : (offset - head) + size;
+}
+
+void UploadRing::EndFrame() {
+    assert(_frameCount < kMaxFramesInFlight && "Too many frames in flight, retire some first");
+    _frameBytes[(_firstFrame + _frameCount) % kMaxFramesInFlight] = _currentBytes;
+    ++_frameCount;
+
+    _stats.frameBytes = _currentBytes;
+    _stats.frameAllocations = _currentAllocations;
+    _currentBytes = 0;
+    _currentAllocations = 0;
+}
+
+void UploadRing::RetireFrame() {
+    assert(_frameCount > 0 && "No frame in flight");
+    UINT bytes = _frameBytes[_firstFrame];
+    _firstFrame = (_firstFrame + 1) % kMaxFramesInFlight;
+    --_frameCount;
+
+    _used -= bytes;
+}
+
+void UploadRing::RecordStall(double seconds) {
+    ++_stats.stalls;
+    _stats.stallSeconds += seconds;
+}
+
+} // namespace dx
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include <VertexFormat.h>
+
+#include <emmintrin.h>
+
+// 1.0 as a half, the w of every position.
+static const unsigned short kHalfOne = 0x3C00;
+
+// Floats in four lanes to halves in the low 16 bits of each, rounding to
+// nearest even. After Fabian Giesen's float_to_half_fast3_rtne.
+static __m128i FloatToHalf4(__m128 value) {
+    const __m128i signMask = _mm_set1_epi32(0x80000000);
+    // Everything from here on rounds to infinity.
+    const __m128i halfMax = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+    const __m128i infinity = _mm_set1_epi32(0x7C00);
+    // Smallest float that makes a normal half.
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    // Rebiases the exponent and adds the rounding.
+    const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+
+    __m128 sign = _mm_and_ps(_mm_castsi128_ps(signMask), value);
+    __m128 absolute = _mm_xor_ps(value, sign);
+    __m128i bits = _mm_castps_si128(absolute);
+
+    __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+    __m128i isRegular = _mm_cmpgt_epi32(halfMax, bits);
+    __m128i special = _mm_or_si128(_mm_and_si128(isNan, nanBit), infinity);
+
+    // Subnormal results: adding the magic number rounds the mantissa.
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, bits);
+    __m128 subnormalSum = _mm_add_ps(absolute, _mm_castsi128_ps(subnormalMagic));
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormalSum), subnormalMagic);
+
+    // Normal results, rounding up ties when the kept mantissa is odd.
+    __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+    __m128i rounded = _mm_sub_epi32(_mm_add_epi32(bits, normalBias), odd);
+    __m128i normal = _mm_srli_epi32(rounded, 13);
+
+    __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    __m128i result = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+    __m128i halfSign = _mm_srli_epi32(_mm_castps_si128(sign), 16);
+    return _mm_or_si128(result, halfSign);
+}
+
+// Halves in the low 16 bits of four lanes to floats. After Fabian
+// Giesen's half_to_float_SSE2.
+static __m128 HalfToFloat4(__m128i value) {
+    const __m128i noSign = _mm_set1_epi32(0x7FFF);
+    // Multiplying by this rebiases the exponent, subnormals included.
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const __m128i largestFinite = _mm_set1_epi32(0x7BFF);
+    const __m128 floatInfinity = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+    __m128i exponentMantissa = _mm_and_si128(value, noSign);
+    __m128i sign = _mm_slli_epi32(_mm_xor_si128(value, exponentMantissa), 16);
+    __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponentMantissa, 13)), magic);
+
+    __m128i isInfNan = _mm_cmpgt_epi32(exponentMantissa, largestFinite);
+    __m128 infNan = _mm_and_ps(_mm_castsi128_ps(isInfNan), floatInfinity);
+    return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), infNan));
+}
+
+// Values in [0, scale] rounded to integers in four lanes.
+static __m128i ToFixed4(__m128 value, float low, float high, float scale) {
+    value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(low)), _mm_set1_ps(high));
+    return _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(scale)));
+}
+
+// The sign of *sign* on the magnitude of *value*.
+static inline __m128 CopySign4(__m128 value, __m128 sign) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    return _mm_or_ps(_mm_andnot_ps(signMask, value), _mm_and_ps(signMask, sign));
+}
+
+static inline __m128 Select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Four lanes of low 16 bits from *low* and *high* interleaved into four
+// 32-bit lanes, *low* in the lower half.
+static inline __m128i Interleave16(__m128i low, __m128i high) {
+    return _mm_or_si128(_mm_and_si128(low, _mm_set1_epi32(0xFFFF)), _mm_slli_epi32(high, 16));
+}
+
+namespace dx {
+
+unsigned short FloatToHalf(float value) {
+    return static_cast<unsigned short>(_mm_cvtsi128_si32(FloatToHalf4(_mm_set_ss(value))));
+}
+
+float HalfToFloat(unsigned short value) {
+    return _mm_cvtss_f32(HalfToFloat4(_mm_cvtsi32_si128(value)));
+}
+
+// The batches below gather four vertices' fields into lanes, convert
+// them together and scatter the results, the last batch padded.
+
+void EncodePositionsHalf4(const MeshVertex *in, UINT count, void *out, UINT stride) {
+    char *bytes = static_cast<char*>(out);
+    for (UINT first = 0; first < count; first += 4) {
+        UINT n = count - first < 4 ? count - first : 4;
+        float x[4] = { 0.0f }, y[4] = { 0.0f }, z[4] = { 0.0f };
+        for (UINT i = 0; i < n; ++i) {
+            const Vector3f &position = in[first + i].position;
+            x[i] = position.x;
+            y[i] = position.y;
+            z[i] = position.z;
+        }
+
+        // x and y share a lane, as do z and the w of 1.
+        __m128i xy = Interleave16(FloatToHalf4(_mm_loadu_ps(x)), FloatToHalf4(_mm_loadu_ps(y)));
+        __m128i zw = Interleave16(FloatToHalf4(_mm_loadu_ps(z)), _mm_set1_epi32(kHalfOne));
+        UINT packed[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(packed), _mm_unpacklo_epi32(xy, zw));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(packed + 4), _mm_unpackhi_epi32(xy, zw));
+        for (UINT i = 0; i < n; ++i) memcpy(bytes + (first + i) * stride, packed + i * 2, 8);
+    }
+}
+
+void DecodePositionsHalf4(const void *in, UINT stride, UINT count, MeshVertex *out) {
+    const char *bytes = static_cast<const char*>(in);
+    for (UINT first = 0; first < count; first += 4) {
+        UINT n = count - first < 4 ? count - first : 4;
+        UINT xy[4] = { 0 }, zw[4] = { 0 };
+        for (UINT i = 0; i < n; ++i) {
+            memcpy(&xy[i], bytes + (first + i) * stride, 4);
+            memcpy(&zw[i], bytes + (first + i) * stride + 4, 4);
+        }
+
+        __m128i packedXy = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xy));
+        __m128i packedZw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(zw));
+        float x[4], y[4], z[4];
+        _mm_storeu_ps(x, HalfToFloat4(_mm_and_si128(packedXy, _mm_set1_epi32(0xFFFF))));
+        _mm_storeu_ps(y, HalfToFloat4(_mm_srli_epi32(packedXy, 16)));
+        _mm_storeu_ps(z, HalfToFloat4(_mm_and_si128(packedZw, _mm_set1_epi32(0xFFFF))));
+        for (UINT i = 0; i < n; ++i) out[first + i].position = Vector3f(x[i], y[i], z[i]);
+    }
+}
+
+void EncodeNormalsOct16(const MeshVertex *in, UINT count, void *out, UINT stride) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    char *bytes = static_cast<char*>(out);
+    for (UINT first = 0; first < count; first += 4) {
+        UINT n = count - first < 4 ? count - first : 4;
+        // Padding lanes get a valid normal.
+        float nx[4] = { 0.0f }, ny[4] = { 0.0f }, nz[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (UINT i = 0; i < n; ++i) {
+            const Vector3f &normal = in[first + i].normal;
+            nx[i] = normal.x;
+            ny[i] = normal.y;
+            nz[i] = normal.z;
+        }
+        __m128 x = _mm_loadu_ps(nx);
+        __m128 y = _mm_loadu_ps(ny);
+        __m128 z = _mm_loadu_ps(nz);
+
+        // Onto the octahedron |x| + |y| + |z| = 1.
+        __m128 absX = _mm_andnot_ps(signMask, x);
+        __m128 absY = _mm_andnot_ps(signMask, y);
+        __m128 absZ = _mm_andnot_ps(signMask, z);
+        __m128 scale = _mm_div_ps(one, _mm_max_ps(_mm_add_ps(_mm_add_ps(absX, absY), absZ), _mm_set1_ps(1e-20f)));
+        x = _mm_mul_ps(x, scale);
+        y = _mm_mul_ps(y, scale);
+        absX = _mm_mul_ps(absX, scale);
+        absY = _mm_mul_ps(absY, scale);
+
+        // The lower half folds out over the corners.
+        __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+        __m128 foldedX = CopySign4(_mm_sub_ps(one, absY), x);
+        __m128 foldedY = CopySign4(_mm_sub_ps(one, absX), y);
+        x = Select4(lower, foldedX, x);
+        y = Select4(lower, foldedY, y);
+
+        __m128i packed = Interleave16(ToFixed4(x, -1.0f, 1.0f, 32767.0f), ToFixed4(y, -1.0f, 1.0f, 32767.0f));
+        UINT lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), packed);
+        for (UINT i = 0; i < n; ++i) memcpy(bytes + (first + i) * stride, &lanes[i], 4);
+    }
+}
+
+void DecodeNormalsOct16(const void *in, UINT stride, UINT count, MeshVertex *out) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 snormScale = _mm_set1_ps(1.0f / 32767.0f);
+
+    const char *bytes = static_cast<const char*>(in);
+    for (UINT first = 0; first < count; first += 4) {
+        UINT n = count - first < 4 ? count - first : 4;
+        UINT lanes[4] = { 0 };
+        for (UINT i = 0; i < n; ++i) memcpy(&lanes[i], bytes + (first + i) * stride, 4);
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+
+        // Sign extends each half.
+        __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 16), 16)), snormScale);
+        __m128 y = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(packed, 16)), snormScale);
+        x = _mm_max_ps(x, _mm_set1_ps(-1.0f));
+        y = _mm_max_ps(y, _mm_set1_ps(-1.0f));
+
+        __m128 z = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+        __m128 fold = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+        x = _mm_sub_ps(x, CopySign4(fold, x));
+        y = _mm_sub_ps(y, CopySign4(fold, y));
+
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        __m128 scale = _mm_div_ps(one, length);
+        float nx[4], ny[4], nz[4];
+        _mm_storeu_ps(nx, _mm_mul_ps(x, scale));
+        _mm_storeu_ps(ny, _mm_mul_ps(y, scale));
+        _mm_storeu_ps(nz, _mm_mul_ps(z, scale));
+        for (UINT i = 0; i < n; ++i) out[first + i].normal = Vector3f(nx[i], ny[i], nz[i]);
+    }
+}
+
+void EncodeTexcoordsUnorm16(const MeshVertex *in, UINT count, void *out, UINT stride) {
+    char *bytes = static_cast<char*>(out);
+    for (UINT first = 0; first < count; first += 4) {
+        UINT n = count - first < 4 ? count - first : 4;
+        float u[4] = { 0.0f }, v[4] = { 0.0f };
+        for (UINT i = 0; i < n; ++i) {
+            u[i] = in[first + i].texcoord.x;
+            v[i] = in[first + i].texcoord.y;
+        }
+
+        __m128i packed = Interleave16(ToFixed4(_mm_loadu_ps(u), 0.0f, 1.0f, 65535.0f),
+                                      ToFixed4(_mm_loadu_ps(v), 0.0f, 1.0f, 65535.0f));
+        UINT lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), packed);
+        for (UINT i = 0; i < n; ++i) memcpy(bytes + (first + i) * stride, &lanes[i], 4);
+    }
+}
+
+void DecodeTexcoordsUnorm16(const void *in, UINT stride, UINT count, MeshVertex *out) {
+    const __m128 unormScale = _mm_set1_ps(1.0f / 65535.0f);
+
+    const char *bytes = static_cast<const char*>(in);
+    for (UINT first = 0; first < count; first += 4) {
+        UINT n = count - first < 4 ? count - first : 4;
+        UINT lanes[4] = { 0 };
+        for (UINT i = 0; i < n; ++i) memcpy(&lanes[i], bytes + (first + i) * stride, 4);
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+
+        float u[4], v[4];
+        _mm_storeu_ps(u, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(packed, _mm_set1_epi32(0xFFFF))), unormScale));
+        _mm_storeu_ps(v, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(packed, 16)), unormScale));
+        for (UINT i = 0; i < n; ++i) out[first + i].texcoord = Vector2f(u[i], v[i]);
+    }
+}
+
+} // namespace dx
\ No newline at end of file
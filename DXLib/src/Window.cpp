@@ -1,11 +1,20 @@
 #include "Window.h"
+#include "Profiler.h"
+#include "Timer.h"
 
 #include <cassert>
+#include <windowsx.h>
 
 #define ASSERT_HWND assert(_hwnd && "Window not created")
 
+// Requests the message thread performs on behalf of others, windows
+// may only be changed by the thread that created them.
+static const UINT kSetTitleMessage = WM_APP + 0;
+static const UINT kDestroyMessage = WM_APP + 1;
+
 // Forward declarations
 void CalculateClientSize(DWORD styles, UINT &width, UINT &height);
+static bool EventFromMessage(UINT msg, WPARAM wParam, LPARAM lParam, dx::Event &event);
 
 namespace dx {
 
@@ -24,13 +33,23 @@ Window::Window(UINT width, UINT height, const std::string &title,
     _hwnd = 0;
     _width = width;
     _height = height;
+    _minimized = false;
     _shouldClose = false;
+    _threadedPump = false;
+    _initDone = false;
+    _initResult = Error::OK;
 }
 
 // Destructor
 Window::~Window() {
-    if (_hwnd != 0)
+    if (_messageThread.joinable()) {
+        // Fails harmlessly if the window is already gone, the thread
+        // quits on its own then.
+        PostMessage(_hwnd, kDestroyMessage, 0, 0);
+        _messageThread.join();
+    } else if (_hwnd != 0) {
         DestroyWindow(_hwnd);
+    }
 }
 
 // Responsible for creating the actual window, since we don't use exceptions
@@ -45,7 +64,47 @@ Error::E Window::Initialize() {
         if (err != Error::OK) return err;
     }
 
-    return InitWindow();
+    if (!_threadedPump) {
+        return InitWindow();
+    }
+
+    _messageThread = std::thread(&Window::MessageThreadMain, this);
+
+    std::unique_lock<std::mutex> lock(_initMutex);
+    while (!_initDone) {
+        _initSignal.wait(lock);
+    }
+    if (_initResult != Error::OK) {
+        lock.unlock();
+        _messageThread.join();
+    }
+    return _initResult;
+}
+
+void Window::SetThreadedMessagePump(bool value) {
+    assert(_hwnd == NULL && "Call SetThreadedMessagePump() before Initialize()");
+    _threadedPump = value;
+}
+
+// Owns the window when the message pump is threaded.
+void Window::MessageThreadMain() {
+    Profiler::SetThreadName("Messages");
+
+    Error::E err = InitWindow();
+    {
+        std::lock_guard<std::mutex> lock(_initMutex);
+        _initResult = err;
+        _initDone = true;
+    }
+    _initSignal.notify_all();
+
+    if (err != Error::OK) return;
+
+    MSG msg = { 0 };
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
 }
 
 bool Window::IsVisible() const {
@@ -57,27 +116,31 @@ bool Window::IsVisible() const {
 
 void Window::SetVisible(bool value) {
     ASSERT_HWND;
-    ShowWindow(_hwnd, static_cast<int>(value));
+    if (_threadedPump) {
+        ShowWindowAsync(_hwnd, value ? SW_SHOW : SW_HIDE);
+    } else {
+        ShowWindow(_hwnd, static_cast<int>(value));
+    }
 }
 
 UINT Window::GetWidth() const {
-    return _width;
+    return _width.load(std::memory_order_relaxed);
 }
 
 UINT Window::GetHeight() const {
-    return _height;
+    return _height.load(std::memory_order_relaxed);
 }
 
 // Returns size of the actual window, including borders.
 UINT Window::GetRealWidth() const {
-    UINT w = _width, h = _height;
+    UINT w = GetWidth(), h = GetHeight();
     CalculateClientSize(_kWindowStyles, w, h);
     return w;
 }
 
 // Returns size of the actual window, including borders.
 UINT Window::GetRealHeight() const {
-    UINT w = _width, h = _height;
+    UINT w = GetWidth(), h = GetHeight();
     CalculateClientSize(_kWindowStyles, w, h);
     return h;
 }
@@ -87,21 +150,44 @@ void Window::SetSize(UINT nWidth, UINT nHeight) {
     _width = nWidth;
     _height = nHeight;
 
-    CalculateClientSize(_kWindowStyles, _width, _height);
-    SetWindowPos(_hwnd, NULL, 0, 0, _width, _height, SWP_NOMOVE);
+    UINT w = nWidth, h = nHeight;
+    CalculateClientSize(_kWindowStyles, w, h);
+
+    // Don't wait for a busy message thread.
+    UINT flags = SWP_NOMOVE | (_threadedPump ? SWP_ASYNCWINDOWPOS : 0);
+    SetWindowPos(_hwnd, NULL, 0, 0, w, h, flags);
 }
 
 std::string Window::GetTitle() const {
+    std::lock_guard<std::mutex> lock(_titleMutex);
     return _title;
 }
 
 void Window::SetTitle(const std::string &str) {
-    ASSERT_HWND;
-    SetWindowText(_hwnd, str.c_str());
+    SetTitle(str.c_str());
+}
+
+// Reuses the title's buffer, so updating it often doesn't allocate.
+void Window::SetTitle(const char *str) {
+    std::lock_guard<std::mutex> lock(_titleMutex);
+    _title.assign(str);
+
+    if (!_hwnd) return;
+
+    // From any thread but the window's, SetWindowText blocks until that
+    // thread handles it, which deadlocks with an update thread the
+    // main thread is waiting on.
+    if (GetWindowThreadProcessId(_hwnd, NULL) != GetCurrentThreadId()) {
+        PostMessage(_hwnd, kSetTitleMessage, 0, 0);
+    } else {
+        SetWindowText(_hwnd, _title.c_str());
+    }
 }
 
 // Standard message pump.
 void Window::HandleMessages() {
+    if (_threadedPump) return;
+
     MSG msg = { 0 };
     while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
         TranslateMessage(&msg);
@@ -109,8 +195,12 @@ void Window::HandleMessages() {
     }
 }
 
+bool Window::IsMinimized() const {
+    return _minimized.load(std::memory_order_relaxed);
+}
+
 bool Window::IsCloseRequested() const {
-    return _shouldClose;
+    return _shouldClose.load(std::memory_order_relaxed);
 }
 
 HWND Window::GetHandle() const {
@@ -118,6 +208,35 @@ HWND Window::GetHandle() const {
     return _hwnd;
 }
 
+bool Window::PushEvent(const Event &event) {
+    assert(!_messageThread.joinable() && "The message thread is the event queue's producer");
+    return _events.Push(event);
+}
+
+void Window::DispatchEvent(const Event &event) {
+    OnEvent(event);
+
+    switch (event.type) {
+    case EventType::CLOSE:
+        OnClose();
+        break;
+    case EventType::FOCUS_GAINED:
+        OnGainFocus();
+        break;
+    case EventType::FOCUS_LOST:
+        OnLostFocus();
+        break;
+    case EventType::MINIMIZED:
+        OnMinimize();
+        break;
+    case EventType::MAXIMIZED:
+        OnMaximize();
+        break;
+    default:
+        break;
+    }
+}
+
 // Static, registers the class used by all dx::Window instances.
 Error::E Window::RegisterDXClass(HINSTANCE hInst) {
     assert(!_isClassReg && "Class already registered.");
@@ -180,20 +299,32 @@ LRESULT Window::WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
     switch (msg) {
     case WM_DESTROY:
-        OnClose();
         _shouldClose = true;
-        break;
-    case WM_ACTIVATE:
-        if (wParam == WA_INACTIVE) OnGainFocus();
-        else OnLostFocus();
+        if (_threadedPump) {
+            PostQuitMessage(0);
+        }
         break;
     case WM_SIZE:
-        if (wParam & SIZE_MAXIMIZED)
-            OnMaximize();
-        else if (wParam & SIZE_MINIMIZED)
-            OnMinimize();
-
+        _minimized.store(wParam == SIZE_MINIMIZED, std::memory_order_relaxed);
+        if (wParam != SIZE_MINIMIZED) {
+            _width.store(LOWORD(lParam), std::memory_order_relaxed);
+            _height.store(HIWORD(lParam), std::memory_order_relaxed);
+        }
         break;
+    case kSetTitleMessage: {
+        std::string title = GetTitle();
+        SetWindowText(hwnd, title.c_str());
+        return 0;
+    }
+    case kDestroyMessage:
+        DestroyWindow(hwnd);
+        return 0;
+    }
+
+    // Handlers run later, when the game thread drains the queue.
+    Event event;
+    if (EventFromMessage(msg, wParam, lParam, event)) {
+        _events.Push(event);
     }
 
 
@@ -208,4 +339,85 @@ static void CalculateClientSize(DWORD styles, UINT &width, UINT &height) {
     AdjustWindowRect(&r, styles, false);
     width = r.right - r.left;
     height = r.bottom - r.top;
+}
+
+// Turns the messages we're interested in into events.
+static bool EventFromMessage(UINT msg, WPARAM wParam, LPARAM lParam, dx::Event &event) {
+    using namespace dx;
+
+    memset(&event, 0, sizeof(event));
+    event.timestamp = Timer::GetRawTicks();
+
+    switch (msg) {
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+        event.type = EventType::KEY_DOWN;
+        event.key.code = static_cast<unsigned int>(wParam);
+        // Bit 30 is set when the key was already down.
+        event.key.repeat = (lParam & (1 << 30)) != 0;
+        return true;
+    case WM_KEYUP:
+    case WM_SYSKEYUP:
+        event.type = EventType::KEY_UP;
+        event.key.code = static_cast<unsigned int>(wParam);
+        return true;
+    case WM_CHAR:
+        event.type = EventType::TEXT;
+        event.text.codepoint = static_cast<unsigned int>(wParam);
+        return true;
+    case WM_MOUSEMOVE:
+        event.type = EventType::MOUSE_MOVE;
+        break;
+    case WM_LBUTTONDOWN:
+    case WM_RBUTTONDOWN:
+    case WM_MBUTTONDOWN:
+        event.type = EventType::MOUSE_DOWN;
+        break;
+    case WM_LBUTTONUP:
+    case WM_RBUTTONUP:
+    case WM_MBUTTONUP:
+        event.type = EventType::MOUSE_UP;
+        break;
+    case WM_MOUSEWHEEL:
+        event.type = EventType::MOUSE_WHEEL;
+        event.mouse.wheel = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wParam)) / WHEEL_DELTA;
+        break;
+    case WM_ACTIVATE:
+        event.type = (LOWORD(wParam) == WA_INACTIVE) ? EventType::FOCUS_LOST : EventType::FOCUS_GAINED;
+        return true;
+    case WM_SIZE:
+        if (wParam == SIZE_MINIMIZED) {
+            event.type = EventType::MINIMIZED;
+        } else {
+            event.type = (wParam == SIZE_MAXIMIZED) ? EventType::MAXIMIZED : EventType::RESIZED;
+            event.size.width = LOWORD(lParam);
+            event.size.height = HIWORD(lParam);
+        }
+        return true;
+    case WM_DESTROY:
+        event.type = EventType::CLOSE;
+        return true;
+    default:
+        return false;
+    }
+
+    // Mouse messages, wheel positions are in screen coordinates but
+    // we don't need them.
+    event.mouse.x = GET_X_LPARAM(lParam);
+    event.mouse.y = GET_Y_LPARAM(lParam);
+
+    switch (msg) {
+    case WM_RBUTTONDOWN:
+    case WM_RBUTTONUP:
+        event.mouse.button = MouseButton::RIGHT;
+        break;
+    case WM_MBUTTONDOWN:
+    case WM_MBUTTONUP:
+        event.mouse.button = MouseButton::MIDDLE;
+        break;
+    default:
+        event.mouse.button = MouseButton::LEFT;
+        break;
+    }
+    return true;
 }
\ No newline at end of file
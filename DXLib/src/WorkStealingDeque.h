@@ -0,0 +1,84 @@
+#ifndef DXLIB_WORKSTEALINGDEQUE_H
+#define DXLIB_WORKSTEALINGDEQUE_H
+
+#include <atomic>
+
+namespace dx {
+
+// Fixed capacity Chase-Lev deque. The owning thread pushes and pops at
+// the bottom, any other thread may steal from the top. T must be
+// trivially copyable, Capacity a power of two.
+template<typename T, unsigned int Capacity>
+class WorkStealingDeque {
+public:
+    WorkStealingDeque() : _top(0), _bottom(0) { }
+
+    // Owner only. Returns false when the deque is full.
+    bool Push(const T &item) {
+        long long b = _bottom.load(std::memory_order_relaxed);
+        long long t = _top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<long long>(Capacity)) return false;
+
+        _items[b & kMask] = item;
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only, takes the most recently pushed item.
+    bool Pop(T &item) {
+        long long b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = _top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty.
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = _items[b & kMask];
+        if (t != b) return true;
+
+        // Last item, race the thieves for it.
+        bool won = _top.compare_exchange_strong(t, t + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    // Any thread, takes the oldest item.
+    bool Steal(T &item) {
+        long long t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long b = _bottom.load(std::memory_order_acquire);
+
+        if (t >= b) return false;
+
+        item = _items[t & kMask];
+        return _top.compare_exchange_strong(t, t + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Only a hint while other threads are active.
+    inline unsigned int GetSize() const {
+        long long size = _bottom.load(std::memory_order_relaxed) -
+                         _top.load(std::memory_order_relaxed);
+        return size > 0 ? static_cast<unsigned int>(size) : 0;
+    }
+
+private:
+    static const long long kMask = Capacity - 1;
+
+    // Thieves and the owner hammer different ends, keep them on
+    // separate cache lines.
+    std::atomic<long long> _top;
+    char _pad0[64];
+    std::atomic<long long> _bottom;
+    char _pad1[64];
+    T _items[Capacity];
+};
+
+} // namespace dx
+#endif // !DXLIB_WORKSTEALINGDEQUE_H
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef DXLIBBENCH_BENCH_H
+#define DXLIBBENCH_BENCH_H
+
+#include <Timer.h>
+
+// Runs *fn* *repeats* times, returns the fastest run in seconds.
+template<typename F>
+inline double BestOf(int repeats, const F &fn) {
+    double best = 0.0;
+    for (int i = 0; i < repeats; ++i) {
+        unsigned long long start = dx::Timer::GetRawTicks();
+        fn();
+        double seconds = (dx::Timer::GetRawTicks() - start) * dx::Timer::GetSecondsPerTick();
+        if (i == 0 || seconds < best) best = seconds;
+    }
+    return best;
+}
+
+// Benchmarks, each prints its own results.
+void RunJobSystemBench();
+void RunRasterBench();
+void RunQueueBench();
+void RunSpriteBench();
+
+#endif // !DXLIBBENCH_BENCH_H
@@ -0,0 +1,32 @@
+#include <iostream>
+#include <cstring>
+
+#include "Bench.h"
+
+struct Benchmark {
+    const char *name;
+    void (*run)();
+};
+
+static const Benchmark kBenchmarks[] = {
+    { "jobs", &RunJobSystemBench },
+    { "raster", &RunRasterBench },
+    { "queue", &RunQueueBench },
+    { "sprites", &RunSpriteBench },
+};
+
+// Runs every benchmark, or only the ones named on the command line.
+int main(int argc, char **argv) {
+    for (size_t i = 0; i < sizeof(kBenchmarks) / sizeof(kBenchmarks[0]); ++i) {
+        bool selected = (argc < 2);
+        for (int arg = 1; arg < argc; ++arg) {
+            if (strcmp(argv[arg], kBenchmarks[i].name) == 0) selected = true;
+        }
+        if (!selected) continue;
+
+        std::cout << "== " << kBenchmarks[i].name << " ==" << std::endl;
+        kBenchmarks[i].run();
+        std::cout << std::endl;
+    }
+    return 0;
+}
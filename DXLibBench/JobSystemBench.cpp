@@ -0,0 +1,90 @@
+#include <JobSystem.h>
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+
+static const unsigned int kItems = 1 << 22;
+static const unsigned int kTinyJobs = 200000;
+static const int kRepeats = 5;
+
+// Enough arithmetic per item that the loop is compute bound.
+static float Work(float x) {
+    float acc = x;
+    for (int i = 0; i < 32; ++i) {
+        acc = std::sqrt(acc * acc + 1.0f) * 0.5f + std::sin(acc);
+    }
+    return acc;
+}
+
+static void TinyJob(void *data) {
+    float *value = static_cast<float*>(data);
+    *value = Work(*value);
+}
+
+// Measures ParallelFor throughput and raw scheduling overhead with a
+// growing number of threads, speedups are relative to a single thread.
+void RunJobSystemBench() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    std::vector<float> data(kItems, 1.0f);
+    std::vector<float> tiny(kTinyJobs, 1.0f);
+    std::vector<dx::Job> jobs(kTinyJobs);
+
+    std::cout << "Hardware threads: " << hardware << std::endl;
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "parallel_for ms" << std::setw(10) << "speedup"
+              << std::setw(16) << "tiny jobs ms" << std::setw(10) << "speedup"
+              << std::endl;
+
+    double baseFor = 0.0, baseTiny = 0.0;
+    const unsigned int counts[] = { 1, 2, 4, 8, 16, 24, 32, 48, 64 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        unsigned int threads = counts[c];
+        if (threads > hardware || threads > dx::JobSystem::kMaxThreads) break;
+
+        dx::JobSystem system;
+        if (threads > 1) {
+            system.Initialize(threads - 1, true);
+        }
+
+        double forSeconds = BestOf(kRepeats, [&]() {
+            system.ParallelFor(0, kItems, 4096, [&](unsigned int first, unsigned int last) {
+                for (unsigned int i = first; i < last; ++i) {
+                    data[i] = Work(data[i]);
+                }
+            });
+        });
+
+        // Batches fit the submitter's deque, anything beyond it would
+        // run inline and leave the workers idle.
+        double tinySeconds = BestOf(kRepeats, [&]() {
+            dx::JobCounter counter;
+            for (unsigned int i = 0; i < kTinyJobs; ++i) {
+                jobs[i] = dx::MakeJob(&TinyJob, &tiny[i], &counter);
+            }
+            for (unsigned int first = 0; first < kTinyJobs; first += dx::JobSystem::kDequeSize) {
+                unsigned int count = kTinyJobs - first;
+                if (count > dx::JobSystem::kDequeSize) count = dx::JobSystem::kDequeSize;
+                system.Run(&jobs[first], count);
+                system.Wait(counter);
+            }
+        });
+
+        if (threads == 1) {
+            baseFor = forSeconds;
+            baseTiny = tinySeconds;
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << threads
+                  << std::setw(16) << TO_MILLIS(forSeconds)
+                  << std::setw(10) << baseFor / forSeconds
+                  << std::setw(16) << TO_MILLIS(tinySeconds)
+                  << std::setw(10) << baseTiny / tinySeconds
+                  << std::endl;
+    }
+}
@@ -0,0 +1,84 @@
+#include <JobSystem.h>
+#include <NullRenderSystem.h>
+#include <RenderQueue.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+
+static const UINT kItems = 50000;
+static const int kRepeats = 10;
+
+// Materials and meshes changed between consecutive keys.
+static UINT CountStateChanges(const std::vector<unsigned long long> &keys) {
+    UINT changes = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i == 0 || dx::RenderKey::GetMaterial(keys[i]) != dx::RenderKey::GetMaterial(keys[i - 1])) ++changes;
+        if (i == 0 || dx::RenderKey::GetMesh(keys[i]) != dx::RenderKey::GetMesh(keys[i - 1])) ++changes;
+    }
+    return changes;
+}
+
+// Sorts and submits a scene of 50k draws with random state, compared to
+// std::sort and to submitting in push order.
+void RunQueueBench() {
+    srand(1234);
+    std::vector<unsigned long long> keys(kItems);
+    for (UINT i = 0; i < kItems; ++i) {
+        // A quarter is blended and sorted back to front, the opaque rest
+        // leaves depth out so it groups by state.
+        UINT layer = (rand() % 4 == 0) ? 1 : 0;
+        UINT depth = layer ? dx::RenderKey::QuantizeDepth(rand() / static_cast<float>(RAND_MAX), true) : 0;
+        keys[i] = dx::RenderKey::Make(layer, rand() % 3, depth, rand() % 64, rand() % 32);
+    }
+
+    dx::DrawCommand command;
+    dx::RenderQueue queue;
+    queue.Reserve(kItems);
+    for (UINT i = 0; i < kItems; ++i) {
+        queue.Push(keys[i], command);
+    }
+
+    std::vector<unsigned long long> sorted;
+    double stdSort = BestOf(kRepeats, [&]() {
+        sorted = keys;
+        std::stable_sort(sorted.begin(), sorted.end());
+    });
+    double serial = BestOf(kRepeats, [&]() { queue.Sort(); });
+
+    dx::NullRenderSystem r;
+    r.Initialize(nullptr, 1, 1, nullptr);
+    double submit = BestOf(kRepeats, [&]() {
+        queue.Submit(r);
+        r.Present();
+    });
+    const dx::RenderQueueStats &stats = queue.GetStats();
+
+    std::cout << kItems << " draws" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(28) << "std::stable_sort ms" << std::setw(10) << stdSort * 1000.0 << std::endl;
+    std::cout << std::setw(28) << "radix, 1 thread ms" << std::setw(10) << serial * 1000.0 << std::endl;
+
+    unsigned int hardware = std::thread::hardware_concurrency();
+    const unsigned int counts[] = { 2, 4, 8, 16 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        if (counts[c] > hardware) break;
+
+        dx::JobSystem jobs;
+        jobs.Initialize(counts[c] - 1);
+        double parallel = BestOf(kRepeats, [&]() { queue.Sort(&jobs); });
+        jobs.Shutdown();
+
+        std::cout << std::setw(18) << "radix, " << counts[c] << " threads ms"
+                  << std::setw(10) << parallel * 1000.0 << std::endl;
+    }
+
+    std::cout << std::setw(28) << "submit ms" << std::setw(10) << submit * 1000.0 << std::endl;
+    std::cout << "State changes: " << CountStateChanges(keys) << " in push order, "
+              << stats.materialChanges + stats.meshChanges << " sorted" << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <JobSystem.h>
+#include <SoftwareRenderer.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+
+static const UINT kWidth = 1280;
+static const UINT kHeight = 720;
+static const unsigned int kTriangles = 20000;
+static const int kRepeats = 5;
+
+static float Random(float min, float max) {
+    return min + (max - min) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+// Renders a frame of small random triangles with a growing number of
+// threads, speedups are relative to a single thread.
+void RunRasterBench() {
+    srand(1234);
+    std::vector<dx::Vertex> vertices(kTriangles * 3);
+    for (unsigned int t = 0; t < kTriangles; ++t) {
+        float cx = Random(-1.0f, 1.0f), cy = Random(-1.0f, 1.0f);
+        for (unsigned int v = 0; v < 3; ++v) {
+            dx::Vertex &vertex = vertices[t * 3 + v];
+            vertex.position = Vector3f(cx + Random(-0.05f, 0.05f), cy + Random(-0.05f, 0.05f), Random(0.0f, 1.0f));
+            vertex.color = static_cast<UINT>(rand()) | 0xFF000000;
+        }
+    }
+
+    dx::DrawCommand command;
+    command.vertices = &vertices[0];
+    command.vertexCount = static_cast<UINT>(vertices.size());
+
+    unsigned int hardware = std::thread::hardware_concurrency();
+    std::cout << kTriangles << " triangles at " << kWidth << "x" << kHeight << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "frame ms"
+              << std::setw(10) << "speedup" << std::setw(20) << "hash" << std::endl;
+
+    double base = 0.0;
+    const unsigned int counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        unsigned int threads = counts[c];
+        if (threads > hardware || threads > dx::JobSystem::kMaxThreads) break;
+
+        dx::JobSystem system;
+        if (threads > 1) {
+            system.Initialize(threads - 1, true);
+        }
+
+        dx::SoftwareRenderer renderer;
+        renderer.Initialize(kWidth, kHeight, &system);
+
+        double seconds = BestOf(kRepeats, [&]() {
+            renderer.Clear(Vector4f::kZero);
+            renderer.Draw(command);
+            renderer.Flush();
+        });
+        if (threads == 1) base = seconds;
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(12) << std::fixed << std::setprecision(2) << seconds * 1000.0
+                  << std::setw(10) << base / seconds
+                  << std::setw(20) << std::hex << renderer.HashColorBuffer() << std::dec << std::endl;
+    }
+}
\ No newline at end of file
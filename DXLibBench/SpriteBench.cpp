@@ -0,0 +1,86 @@
+#include <JobSystem.h>
+#include <SoftwareRenderSystem.h>
+#include <SpriteBatch.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+
+static const UINT kWidth = 1280;
+static const UINT kHeight = 720;
+static const UINT kSprites = 1000000;
+static const UINT kTextures = 32;
+static const int kRepeats = 3;
+
+static float Random(float min, float max) {
+    return min + (max - min) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+// Batches a million small sprites over 32 textures on the software
+// backend. Batch is the CPU time of End() without the rasterizer, which
+// runs in Present().
+void RunSpriteBench() {
+    srand(1234);
+    std::vector<dx::Sprite> sprites(kSprites);
+    for (UINT i = 0; i < kSprites; ++i) {
+        dx::Sprite &s = sprites[i];
+        s.dest = RectangleF(Random(0.0f, kWidth - 4.0f), Random(0.0f, kHeight - 4.0f), 3.0f, 3.0f);
+        s.color = static_cast<UINT>(rand()) | 0xFF000000;
+        s.rotation = (i % 4 == 0) ? Random(0.0f, 6.28f) : 0.0f;
+        s.depth = Random(0.0f, 1.0f);
+        s.texture = rand() % kTextures;
+    }
+
+    std::cout << kSprites << " sprites, " << kTextures << " textures at " << kWidth << "x" << kHeight << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(10) << "sort ms" << std::setw(12) << "expand ms"
+              << std::setw(12) << "submit ms" << std::setw(12) << "raster ms" << std::setw(8) << "draws" << std::endl;
+
+    unsigned int hardware = std::thread::hardware_concurrency();
+    const unsigned int counts[] = { 1, 2, 4, 8, 16 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        unsigned int threads = counts[c];
+        if (threads > hardware) break;
+
+        dx::JobSystem jobs;
+        if (threads > 1) {
+            jobs.Initialize(threads - 1);
+        }
+
+        dx::SoftwareRenderSystem r;
+        r.Initialize(nullptr, kWidth, kHeight, &jobs);
+        dx::SpriteBatch batch;
+        batch.Reserve(kSprites);
+
+        dx::SpriteBatchStats best;
+        double bestBatch = 0.0;
+        double bestRaster = 0.0;
+        for (int repeat = 0; repeat < kRepeats; ++repeat) {
+            r.Clear(Vector4f::kZero);
+            batch.Begin(kWidth, kHeight);
+            for (UINT i = 0; i < kSprites; ++i) {
+                batch.Draw(sprites[i]);
+            }
+            batch.End(r, &jobs);
+            double raster = BestOf(1, [&]() { r.Present(); });
+
+            const dx::SpriteBatchStats &stats = batch.GetStats();
+            double seconds = stats.sortSeconds + stats.expandSeconds + stats.submitSeconds;
+            if (repeat == 0 || seconds < bestBatch) {
+                best = stats;
+                bestBatch = seconds;
+            }
+            if (repeat == 0 || raster < bestRaster) bestRaster = raster;
+        }
+
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2)
+                  << std::setw(10) << best.sortSeconds * 1000.0
+                  << std::setw(12) << best.expandSeconds * 1000.0
+                  << std::setw(12) << best.submitSeconds * 1000.0
+                  << std::setw(12) << bestRaster * 1000.0
+                  << std::setw(8) << best.draws << std::endl;
+    }
+}
\ No newline at end of file
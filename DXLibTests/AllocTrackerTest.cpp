@@ -0,0 +1,101 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <AllocTracker.h>
+#include <Event.h>
+#include <LinearArena.h>
+
+#include <cstring>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static size_t violationCount = 0;
+
+static void CountViolation(const char *scope, size_t bytes) {
+    ++violationCount;
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(AllocTrackerTest)
+	{
+	public:
+
+        TEST_METHOD_INITIALIZE(InstallHandler) {
+            violationCount = 0;
+            dx::AllocTracker::SetViolationHandler(&CountViolation);
+        }
+
+        TEST_METHOD_CLEANUP(RemoveHandler) {
+            dx::AllocTracker::SetViolationHandler(nullptr);
+        }
+
+        // Only checks anything when DXLib is built with
+        // DXLIB_TRACK_ALLOCATIONS, as in Debug.
+        TEST_METHOD(ReportsAllocationInNoAllocScope) {
+            if (!dx::AllocTracker::IsEnabled()) return;
+
+            {
+                dx::NoAllocScope scope("Test");
+                int *value = new int(1);
+                delete value;
+            }
+            Assert::IsTrue(violationCount == 1);
+
+            // Outside of the scope again.
+            delete new int(2);
+            Assert::IsTrue(violationCount == 1);
+        }
+
+        TEST_METHOD(CountsTaggedAllocations) {
+            if (!dx::AllocTracker::IsEnabled()) return;
+
+            dx::AllocTracker::BeginFrame();
+            {
+                dx::AllocTagScope tag("AllocTrackerTest");
+                for (int i = 0; i < 10; ++i) {
+                    delete new char[100];
+                }
+            }
+            dx::AllocTracker::EndFrame();
+
+            const dx::AllocFrameStats &stats = dx::AllocTracker::GetLastFrame();
+            Assert::IsTrue(stats.count >= 10);
+            Assert::IsTrue(stats.peakBytes >= 100);
+
+            bool found = false;
+            for (size_t i = 0; i < stats.tags.size(); ++i) {
+                if (strcmp(stats.tags[i].name, "AllocTrackerTest") == 0) {
+                    Assert::IsTrue(stats.tags[i].count == 10);
+                    Assert::IsTrue(stats.tags[i].bytes == 1000);
+                    found = true;
+                }
+            }
+            Assert::IsTrue(found);
+        }
+
+        // Per-frame paths that must stay off the heap.
+        TEST_METHOD(HotPathsDontAllocate) {
+            if (!dx::AllocTracker::IsEnabled()) return;
+
+            dx::EventQueue queue;
+            dx::LinearArena arena;
+            arena.Initialize(4096);
+
+            dx::Event event;
+            memset(&event, 0, sizeof(event));
+            dx::Event out[64];
+
+            {
+                dx::NoAllocScope scope("HotPaths");
+                for (int i = 0; i < 100; ++i) {
+                    queue.Push(event);
+                    queue.Drain(out, 64);
+                    arena.Allocate(32);
+                }
+                arena.Reset();
+            }
+            Assert::IsTrue(violationCount == 0);
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <AssetPack.h>
+#include <AssetPackWriter.h>
+#include <JobSystem.h>
+#include <Lz.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static const char *kPackPath = "AssetPackTest.pack";
+
+static void AddTestMesh(dx::AssetPackWriter &writer, const char *name, UINT vertexCount) {
+    std::vector<dx::Vertex> vertices(vertexCount);
+    std::vector<UINT> indices(vertexCount);
+    for (UINT i = 0; i < vertexCount; ++i) {
+        vertices[i].position = Vector3f(static_cast<float>(i % 17), static_cast<float>(i % 5), 0.5f);
+        vertices[i].color = 0xFF000000 | i;
+        indices[i] = vertexCount - 1 - i;
+    }
+    writer.AddMesh(name, &vertices[0], vertexCount, &indices[0], vertexCount);
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(AssetPackTest)
+	{
+	public:
+
+        TEST_METHOD(LzRoundTrips) {
+            std::vector<char> data(100000);
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = static_cast<char>((i / 7) % 13 + (i % 1000 == 0 ? i : 0));
+            }
+
+            std::vector<char> packed(dx::LzCompressBound(data.size()));
+            size_t size = dx::LzCompress(&data[0], data.size(), &packed[0], packed.size());
+            Assert::IsTrue(size > 0 && size < data.size() / 4);
+
+            std::vector<char> unpacked(data.size());
+            Assert::IsTrue(dx::LzDecompress(&packed[0], size, &unpacked[0], unpacked.size()));
+            Assert::IsTrue(unpacked == data);
+            // One byte short must be noticed, not overrun.
+            Assert::IsFalse(dx::LzDecompress(&packed[0], size, &unpacked[0], unpacked.size() - 1));
+        }
+
+        TEST_METHOD(ViewsPointIntoTheMapping) {
+            {
+                dx::AssetPackWriter writer;
+                AddTestMesh(writer, "meshes/quad", 4);
+                AddTestMesh(writer, "meshes/strip", 1001);
+
+                UINT pixels[6] = { 1, 2, 3, 4, 5, 6 };
+                writer.AddTexture("textures/small", 3, 2, pixels);
+
+                dx::Transform keys[2 * 3];
+                keys[5].position = Vector3f(1.0f, 2.0f, 3.0f);
+                writer.AddAnimation("anims/wave", 2, 3, 30.0f, keys);
+                writer.AddRaw("notes", dx::AssetType::RAW, "hello", 5);
+                Assert::IsTrue(writer.Write(kPackPath) == dx::Error::OK);
+            }
+
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kPackPath) == dx::Error::OK);
+            Assert::IsTrue(pack.GetAssetCount() == 5);
+            Assert::IsTrue(pack.Find("missing") == nullptr);
+
+            for (UINT i = 0; i < pack.GetAssetCount(); ++i) {
+                Assert::IsTrue(pack.GetEntry(i).offset % dx::AssetPackHeader::kAlignment == 0);
+            }
+
+            dx::MeshView mesh;
+            Assert::IsTrue(pack.GetMesh("meshes/strip", mesh));
+            Assert::IsTrue(mesh.vertexCount == 1001 && mesh.indexCount == 1001);
+            Assert::IsTrue(mesh.vertices[1000].color == (0xFF000000 | 1000));
+            Assert::IsTrue(mesh.indices[0] == 1000);
+            const dx::AssetPackEntry *entry = pack.Find("meshes/strip");
+            Assert::IsTrue(reinterpret_cast<const char*>(mesh.vertices) ==
+                           static_cast<const char*>(pack.GetData(*entry)) + sizeof(dx::MeshBlobHeader));
+            // Wrong type.
+            Assert::IsFalse(pack.GetMesh("textures/small", mesh));
+
+            dx::TextureView texture;
+            Assert::IsTrue(pack.GetTexture("textures/small", texture));
+            Assert::IsTrue(texture.width == 3 && texture.height == 2 && texture.pitch == 12);
+            Assert::IsTrue(static_cast<const UINT*>(texture.pixels)[5] == 6);
+
+            dx::AnimationView animation;
+            Assert::IsTrue(pack.GetAnimation("anims/wave", animation));
+            Assert::IsTrue(animation.boneCount == 2 && animation.frameCount == 3);
+            Assert::IsTrue(animation.keys[5].position.z == 3.0f);
+
+            entry = pack.Find("notes");
+            Assert::IsTrue(entry && entry->size == 5 && memcmp(pack.GetData(*entry), "hello", 5) == 0);
+
+            pack.Close();
+            remove(kPackPath);
+        }
+
+        TEST_METHOD(CompressedBlobsDecompressOnJobs) {
+            {
+                dx::AssetPackWriter writer;
+                writer.SetCompression(true);
+                // Large enough for several blocks.
+                AddTestMesh(writer, "meshes/big", 40000);
+                Assert::IsTrue(writer.Write(kPackPath) == dx::Error::OK);
+                Assert::IsTrue(writer.GetStats().compressed == 1);
+                Assert::IsTrue(writer.GetStats().fileBytes < writer.GetStats().rawBytes);
+            }
+
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kPackPath) == dx::Error::OK);
+            const dx::AssetPackEntry *entry = pack.Find("meshes/big");
+            Assert::IsTrue(entry && entry->compression == dx::AssetCompression::LZ_BLOCKS);
+            Assert::IsTrue(entry->blockCount > 4);
+
+            dx::MeshView mesh;
+            Assert::IsFalse(pack.GetMesh("meshes/big", mesh));
+
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+            std::vector<char> raw(static_cast<size_t>(entry->rawSize));
+            Assert::IsTrue(pack.Decompress(*entry, &raw[0], &jobs) == dx::Error::OK);
+            jobs.Shutdown();
+
+            Assert::IsTrue(dx::AssetPack::ViewMesh(&raw[0], raw.size(), mesh));
+            Assert::IsTrue(mesh.vertexCount == 40000);
+            for (UINT i = 0; i < mesh.vertexCount; ++i) {
+                Assert::IsTrue(mesh.vertices[i].color == (0xFF000000 | i));
+                Assert::IsTrue(mesh.indices[i] == 39999 - i);
+            }
+
+            pack.Close();
+            remove(kPackPath);
+        }
+
+        TEST_METHOD(RejectsOtherFiles) {
+            char junk[256] = { 'n', 'o', 'p', 'e' };
+            {
+                std::ofstream file(kPackPath, std::ios::binary);
+                file.write(junk, sizeof(junk));
+            }
+
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kPackPath) == dx::Error::FILE_FORMAT_INVALID);
+            Assert::IsFalse(pack.IsOpen());
+            Assert::IsTrue(pack.Open("no such file.pack") == dx::Error::FILE_OPEN_FAIL);
+            remove(kPackPath);
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <AssetPack.h>
+#include <AssetPackWriter.h>
+#include <AssetStreamer.h>
+#include <JobSystem.h>
+#include <Timer.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static const char *kStreamPackPath = "AssetStreamerTest.pack";
+
+// Raw assets "asset0".."assetN" of *size* bytes, byte i of asset a being
+// (a + i / 16) & 0xFF.
+static void WriteTestPack(UINT count, size_t size, bool compress) {
+    dx::AssetPackWriter writer;
+    writer.SetCompression(compress);
+    std::vector<char> data(size);
+    for (UINT a = 0; a < count; ++a) {
+        for (size_t i = 0; i < size; ++i) {
+            // Repetitive enough to compress.
+            data[i] = static_cast<char>((a + i / 16) & 0xFF);
+        }
+        std::string name = "asset" + std::to_string(a);
+        writer.AddRaw(name.c_str(), dx::AssetType::RAW, &data[0], size);
+    }
+    Assert::IsTrue(writer.Write(kStreamPackPath) == dx::Error::OK);
+}
+
+// Streamer indices of the test assets, the pack orders them by hash.
+static std::vector<UINT> FindTestAssets(const dx::AssetStreamer &streamer, UINT count) {
+    std::vector<UINT> assets(count);
+    for (UINT a = 0; a < count; ++a) {
+        assets[a] = streamer.FindAsset(("asset" + std::to_string(a)).c_str());
+        Assert::IsTrue(assets[a] != dx::AssetStreamer::kInvalidAsset);
+    }
+    return assets;
+}
+
+static bool HasTestData(const void *data, UINT asset, size_t size) {
+    const char *bytes = static_cast<const char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        if (bytes[i] != static_cast<char>((asset + i / 16) & 0xFF)) return false;
+    }
+    return true;
+}
+
+// Updates until *asset* leaves the queue, at most a few seconds.
+static dx::AssetState::E WaitFor(dx::AssetStreamer &streamer, UINT asset) {
+    unsigned long long start = dx::Timer::GetRawTicks();
+    for (;;) {
+        streamer.Update();
+        dx::AssetState::E state = streamer.GetState(asset);
+        if (state != dx::AssetState::QUEUED && state != dx::AssetState::LOADING) return state;
+        if ((dx::Timer::GetRawTicks() - start) * dx::Timer::GetSecondsPerTick() > 5.0) return state;
+    }
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(AssetStreamerTest)
+	{
+	public:
+
+        TEST_METHOD(HigherPriorityLoadsFirst) {
+            // Large enough that reading all takes a while.
+            WriteTestPack(24, 1024 * 1024, false);
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kStreamPackPath) == dx::Error::OK);
+
+            dx::AssetStreamer streamer;
+            Assert::IsTrue(streamer.Initialize(pack, nullptr, 64 * 1024 * 1024) == dx::Error::OK);
+            std::vector<UINT> assets = FindTestAssets(streamer, 24);
+            for (UINT a = 0; a < 23; ++a) streamer.Request(assets[a], 0);
+            streamer.Request(assets[23], 10);
+            Assert::IsTrue(streamer.FindAsset("missing") == dx::AssetStreamer::kInvalidAsset);
+
+            Assert::IsTrue(WaitFor(streamer, assets[23]) == dx::AssetState::RESIDENT);
+            // Queued before it, still waiting.
+            Assert::IsTrue(streamer.GetState(assets[22]) == dx::AssetState::QUEUED);
+
+            Assert::IsTrue(WaitFor(streamer, assets[22]) == dx::AssetState::RESIDENT);
+            for (UINT a = 0; a < 24; ++a) {
+                size_t size = 0;
+                const void *data = streamer.GetData(assets[a], &size);
+                Assert::IsTrue(data != nullptr && size == 1024 * 1024);
+                Assert::IsTrue(HasTestData(data, a, size));
+            }
+            Assert::IsTrue(streamer.GetStats().loads == 24);
+
+            streamer.Shutdown();
+            pack.Close();
+            remove(kStreamPackPath);
+        }
+
+        TEST_METHOD(CanceledRequestsAreDropped) {
+            WriteTestPack(16, 256 * 1024, false);
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kStreamPackPath) == dx::Error::OK);
+
+            dx::AssetStreamer streamer;
+            Assert::IsTrue(streamer.Initialize(pack, nullptr, 64 * 1024 * 1024) == dx::Error::OK);
+            std::vector<UINT> assets = FindTestAssets(streamer, 16);
+            for (UINT a = 0; a < 15; ++a) streamer.Request(assets[a], 1);
+            // Whether still queued or already being read, it never
+            // becomes resident.
+            streamer.Cancel(assets[7]);
+            streamer.Request(assets[15], 0);
+
+            // Loads one at a time without jobs, all the others are done.
+            Assert::IsTrue(WaitFor(streamer, assets[15]) == dx::AssetState::RESIDENT);
+            streamer.Update();
+            Assert::IsTrue(streamer.GetState(assets[7]) == dx::AssetState::UNLOADED);
+            Assert::IsTrue(streamer.GetData(assets[7]) == nullptr);
+            Assert::IsTrue(streamer.GetStats().cancels == 1);
+            Assert::IsTrue(streamer.GetStats().loads == 15);
+
+            streamer.Shutdown();
+            pack.Close();
+            remove(kStreamPackPath);
+        }
+
+        TEST_METHOD(EvictsLeastRecentlyUsed) {
+            const size_t kSize = 64 * 1024;
+            WriteTestPack(6, kSize, false);
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kStreamPackPath) == dx::Error::OK);
+
+            // Three assets and their read padding fit, four don't.
+            dx::AssetStreamer streamer;
+            Assert::IsTrue(streamer.Initialize(pack, nullptr, 3 * (kSize + 2 * dx::AssetStreamer::kReadAlignment)) == dx::Error::OK);
+            std::vector<UINT> assets = FindTestAssets(streamer, 6);
+            for (UINT a = 0; a < 3; ++a) {
+                streamer.Request(assets[a], 0);
+                Assert::IsTrue(WaitFor(streamer, assets[a]) == dx::AssetState::RESIDENT);
+            }
+
+            streamer.SetPinned(assets[1], true);
+            Assert::IsTrue(streamer.GetData(assets[0]) != nullptr);
+            // 1 is now the least recently used, but pinned.
+            streamer.Request(assets[3], 0);
+            Assert::IsTrue(WaitFor(streamer, assets[3]) == dx::AssetState::RESIDENT);
+            Assert::IsTrue(streamer.GetState(assets[1]) == dx::AssetState::RESIDENT);
+            Assert::IsTrue(streamer.GetState(assets[2]) == dx::AssetState::UNLOADED);
+
+            streamer.Request(assets[4], 0);
+            Assert::IsTrue(WaitFor(streamer, assets[4]) == dx::AssetState::RESIDENT);
+            Assert::IsTrue(streamer.GetState(assets[0]) == dx::AssetState::UNLOADED);
+            Assert::IsTrue(streamer.GetState(assets[1]) == dx::AssetState::RESIDENT);
+            Assert::IsTrue(streamer.GetStats().evictions == 2);
+            Assert::IsTrue(streamer.GetStats().residentBytes <= streamer.GetBudget());
+
+            // Evicted assets load again on request.
+            streamer.Request(assets[0], 0);
+            Assert::IsTrue(WaitFor(streamer, assets[0]) == dx::AssetState::RESIDENT);
+            Assert::IsTrue(HasTestData(streamer.GetData(assets[0]), 0, kSize));
+
+            streamer.Shutdown();
+            pack.Close();
+            remove(kStreamPackPath);
+        }
+
+        TEST_METHOD(CompressedAssetsDecodeOnJobs) {
+            const size_t kSize = 600 * 1024;
+            WriteTestPack(8, kSize, true);
+            dx::AssetPack pack;
+            Assert::IsTrue(pack.Open(kStreamPackPath) == dx::Error::OK);
+            Assert::IsTrue(pack.GetEntry(0).compression == dx::AssetCompression::LZ_BLOCKS);
+
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+            dx::AssetStreamer streamer;
+            Assert::IsTrue(streamer.Initialize(pack, &jobs, 64 * 1024 * 1024) == dx::Error::OK);
+            std::vector<UINT> assets = FindTestAssets(streamer, 8);
+            for (UINT a = 0; a < 8; ++a) streamer.Request(assets[a], a);
+
+            for (UINT a = 0; a < 8; ++a) {
+                Assert::IsTrue(WaitFor(streamer, assets[a]) == dx::AssetState::RESIDENT);
+                size_t size = 0;
+                const void *data = streamer.GetData(assets[a], &size);
+                Assert::IsTrue(size == kSize && HasTestData(data, a, size));
+            }
+            // Read compressed, held decompressed.
+            Assert::IsTrue(streamer.GetStats().bytesRead < 8 * kSize);
+            Assert::IsTrue(streamer.GetStats().residentBytes == 8 * kSize);
+
+            streamer.Shutdown();
+            jobs.Shutdown();
+            pack.Close();
+            remove(kStreamPackPath);
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <CommandList.h>
+#include <JobSystem.h>
+#include <NullRenderSystem.h>
+#include <SoftwareRenderSystem.h>
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static const UINT kLists = 8;
+static const UINT kDrawsPerList = 100;
+
+// A small triangle per draw, placed by its index so every draw differs.
+static void MakeDraw(UINT n, dx::Vertex *vertices, dx::DrawCommand &command) {
+    float x = -1.0f + 2.0f * (n % 40) / 40.0f;
+    float y = -1.0f + 2.0f * (n / 40) / 20.0f;
+
+    vertices[0].position = Vector3f(x, y, 0.5f);
+    vertices[1].position = Vector3f(x + 0.1f, y, 0.5f);
+    vertices[2].position = Vector3f(x, y + 0.1f, 0.5f);
+    vertices[0].color = vertices[1].color = vertices[2].color = 0xFF000000 | n * 2654435761u;
+
+    command.vertices = vertices;
+    // Tags the draw for the null backend's recording.
+    command.vertexCount = 3;
+    command.indexCount = n;
+}
+
+static void RecordDraws(dx::CommandList &list, UINT listIndex) {
+    list.Begin();
+    for (UINT i = 0; i < kDrawsPerList; ++i) {
+        dx::Vertex vertices[3];
+        dx::DrawCommand command;
+        MakeDraw(listIndex * kDrawsPerList + i, vertices, command);
+        list.DrawTransient(command);
+    }
+    list.End();
+}
+
+// The draws of RecordDraws() straight on the render system.
+static void IssueDraws(dx::RenderSystem &r, UINT listIndex) {
+    for (UINT i = 0; i < kDrawsPerList; ++i) {
+        dx::Vertex vertices[3];
+        dx::DrawCommand command;
+        MakeDraw(listIndex * kDrawsPerList + i, vertices, command);
+        r.Draw(command);
+    }
+}
+
+static void RecordInParallel(dx::RenderSystem &r, std::vector<dx::CommandList*> &lists) {
+    for (UINT i = 0; i < kLists; ++i) {
+        lists.push_back(r.CreateCommandList());
+    }
+
+    dx::JobSystem jobs;
+    jobs.Initialize(3);
+    jobs.ParallelFor(0, kLists, 1, [&](UINT first, UINT last) {
+        for (UINT i = first; i < last; ++i) {
+            RecordDraws(*lists[i], i);
+        }
+    });
+    jobs.Shutdown();
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(CommandListTest)
+	{
+	public:
+
+        TEST_METHOD(ExecutesInSubmissionOrder) {
+            dx::NullRenderSystem r;
+            r.Initialize(nullptr, 64, 64, nullptr);
+
+            std::vector<dx::CommandList*> lists;
+            RecordInParallel(r, lists);
+
+            r.SetRecording(true);
+            r.Execute(&lists[0], kLists);
+            r.Present();
+
+            const std::vector<dx::NullRenderRecord> &calls = r.GetRecording();
+            Assert::IsTrue(calls.size() == kLists * kDrawsPerList + 1);
+            for (UINT i = 0; i < kLists * kDrawsPerList; ++i) {
+                Assert::IsTrue(calls[i].call == dx::NullRenderCall::DRAW);
+                Assert::IsTrue(calls[i].indexCount == i);
+            }
+            Assert::IsTrue(r.GetDrawCallCount() == kLists * kDrawsPerList);
+
+            for (UINT i = 0; i < kLists; ++i) delete lists[i];
+        }
+
+        TEST_METHOD(RecordedFrameMatchesDirectDraws) {
+            dx::SoftwareRenderSystem recorded;
+            recorded.Initialize(nullptr, 160, 120, nullptr);
+
+            std::vector<dx::CommandList*> lists;
+            RecordInParallel(recorded, lists);
+            recorded.Clear(Vector4f(0.2f, 0.2f, 0.2f, 1.0f));
+            recorded.Execute(&lists[0], kLists);
+            recorded.Present();
+
+            // The same draws issued one by one.
+            dx::SoftwareRenderSystem direct;
+            direct.Initialize(nullptr, 160, 120, nullptr);
+            direct.Clear(Vector4f(0.2f, 0.2f, 0.2f, 1.0f));
+            for (UINT i = 0; i < kLists; ++i) {
+                IssueDraws(direct, i);
+            }
+            direct.Present();
+
+            Assert::IsTrue(recorded.GetSoftwareRenderer().HashColorBuffer() ==
+                           direct.GetSoftwareRenderer().HashColorBuffer());
+            Assert::IsTrue(recorded.GetDrawCallCount() == kLists * kDrawsPerList);
+
+            for (UINT i = 0; i < kLists; ++i) delete lists[i];
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <ECS.h>
+#include <Transform.h>
+
+#include <atomic>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+struct Health {
+    int value;
+};
+
+struct Tag {
+    char name[8];
+};
+
+// Writes Health, so it must run after anything reading it.
+class DamageSystem : public dx::System {
+public:
+    DamageSystem() : dx::System("DamageSystem") { Writes<Health>(); }
+
+    void Update(dx::World &world, dx::CommandBuffer &commands,
+                dx::JobSystem &jobs, const dx::Timer &timer) override {
+        world.ForEach<Health>([&commands](dx::Entity entity, Health &health) {
+            if (--health.value <= 0) {
+                commands.DestroyEntity(entity);
+            }
+        });
+    }
+};
+
+class CountSystem : public dx::System {
+public:
+    CountSystem() : dx::System("CountSystem"), count(0) { Reads<Health>(); }
+
+    void Update(dx::World &world, dx::CommandBuffer &commands,
+                dx::JobSystem &jobs, const dx::Timer &timer) override {
+        world.ForEach<Health>([this](dx::Entity entity, Health &health) { ++count; });
+    }
+
+    int count;
+};
+
+namespace DXLibTests
+{
+	TEST_CLASS(ECSTest)
+	{
+	public:
+
+        TEST_METHOD(AddRemoveComponents) {
+            dx::World world;
+            dx::Entity e = world.CreateEntity();
+            Health health = { 10 };
+            world.AddComponent(e, health);
+            world.AddComponent<dx::Transform>(e)->position = Vector3f(1.0f, 2.0f, 3.0f);
+
+            Assert::AreEqual(10, world.GetComponent<Health>(e)->value);
+            Assert::AreEqual(2.0f, world.GetComponent<dx::Transform>(e)->position.y);
+
+            // Values survive the move to another archetype.
+            world.RemoveComponent<Health>(e);
+            Assert::IsFalse(world.HasComponent<Health>(e));
+            Assert::AreEqual(3.0f, world.GetComponent<dx::Transform>(e)->position.z);
+
+            world.DestroyEntity(e);
+            Assert::IsFalse(world.IsAlive(e));
+            Assert::IsTrue(world.GetComponent<dx::Transform>(e) == nullptr);
+        }
+
+        TEST_METHOD(ChunksStayPacked) {
+            dx::World world;
+            std::vector<dx::Entity> entities;
+            for (int i = 0; i < 5000; ++i) {
+                dx::Entity e = world.CreateEntity(dx::MaskOf<Health, Tag>());
+                world.GetComponent<Health>(e)->value = i;
+                entities.push_back(e);
+            }
+
+            // Destroying every other entity moves the tail into the holes.
+            for (int i = 0; i < 5000; i += 2) {
+                world.DestroyEntity(entities[i]);
+            }
+            for (int i = 1; i < 5000; i += 2) {
+                Assert::AreEqual(i, world.GetComponent<Health>(entities[i])->value);
+            }
+
+            int visited = 0;
+            long long sum = 0;
+            world.ForEachChunk(dx::Query::With<Health>(), [&](dx::ChunkView &view) {
+                Health *health = view.Get<Health>();
+                for (unsigned int i = 0; i < view.GetCount(); ++i) {
+                    sum += health[i].value;
+                    ++visited;
+                }
+            });
+            Assert::AreEqual(2500, visited);
+            Assert::AreEqual(2500LL * 2500LL, sum);
+
+            int tagless = 0;
+            world.ForEachChunk(dx::Query::With<Health>().Without<Tag>(), [&](dx::ChunkView &view) {
+                tagless += view.GetCount();
+            });
+            Assert::AreEqual(0, tagless);
+        }
+
+        TEST_METHOD(CommandBufferPlayback) {
+            dx::World world;
+            dx::CommandBuffer commands;
+
+            dx::Entity pending = commands.CreateEntity();
+            Health health = { 5 };
+            commands.AddComponent(pending, health);
+            Assert::IsTrue(world.GetEntityCount() == 0);
+
+            std::vector<dx::Entity> created;
+            commands.Playback(world, &created);
+            Assert::IsTrue(created.size() == 1);
+            Assert::AreEqual(5, world.GetComponent<Health>(created[0])->value);
+            Assert::IsTrue(commands.IsEmpty());
+        }
+
+        TEST_METHOD(SchedulerOrdersConflicts) {
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+
+            dx::World world;
+            for (int i = 0; i < 100; ++i) {
+                dx::Entity e = world.CreateEntity(dx::MaskOf<Health, dx::Transform, dx::Velocity, dx::LocalToWorld>());
+                world.GetComponent<Health>(e)->value = (i % 2) + 1;
+                world.GetComponent<dx::Velocity>(e)->linear = Vector3f(1.0f, 0.0f, 0.0f);
+            }
+
+            CountSystem count;
+            DamageSystem damage;
+            dx::MovementSystem movement;
+            dx::TransformSystem transform;
+
+            dx::SystemScheduler scheduler;
+            scheduler.Add(&count);
+            scheduler.Add(&damage);
+            scheduler.Add(&movement);
+            scheduler.Add(&transform);
+
+            dx::Timer timer;
+            timer.Start();
+            timer.Advance(0.5);
+            scheduler.Run(world, jobs, timer);
+
+            // Count and movement run first, damage and transform after them.
+            Assert::IsTrue(scheduler.GetWaveCount() == 2);
+            Assert::AreEqual(100, count.count);
+            Assert::IsTrue(world.GetEntityCount() == 50);
+
+            world.ForEach<dx::Transform, dx::LocalToWorld>(
+                [](dx::Entity e, dx::Transform &t, dx::LocalToWorld &l) {
+                    Assert::AreEqual(0.5f, t.position.x);
+                    Assert::AreEqual(0.5f, l.matrix.GetPosition().x, 1e-6f);
+                });
+
+            jobs.Shutdown();
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <Event.h>
+
+#include <cstring>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DXLibTests
+{
+	TEST_CLASS(EventQueueTest)
+	{
+	public:
+
+        TEST_METHOD(DropsWhenFull) {
+            dx::EventQueue queue;
+            dx::Event event;
+            memset(&event, 0, sizeof(event));
+            event.type = dx::EventType::KEY_DOWN;
+
+            for (unsigned int i = 0; i < dx::EventQueue::kCapacity; ++i) {
+                Assert::IsTrue(queue.Push(event));
+            }
+            Assert::IsFalse(queue.Push(event));
+            Assert::IsTrue(queue.GetDroppedCount() == 1);
+
+            dx::Event out[100];
+            Assert::IsTrue(queue.Drain(out, 100) == 100);
+            Assert::IsTrue(queue.Push(event));
+        }
+
+        TEST_METHOD(OrderAcrossThreads) {
+            dx::EventQueue queue;
+            const unsigned int count = 100000;
+
+            std::thread producer([&queue, count]() {
+                dx::Event event;
+                memset(&event, 0, sizeof(event));
+                event.type = dx::EventType::MOUSE_MOVE;
+                for (unsigned int i = 0; i < count; ++i) {
+                    event.mouse.x = static_cast<int>(i);
+                    while (!queue.Push(event)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+
+            // Batches must come out complete and in order.
+            unsigned int next = 0;
+            dx::Event batch[64];
+            while (next < count) {
+                unsigned int n = queue.Drain(batch, 64);
+                for (unsigned int i = 0; i < n; ++i) {
+                    Assert::AreEqual(static_cast<int>(next), batch[i].mouse.x);
+                    ++next;
+                }
+            }
+            producer.join();
+        }
+	};
+}
\ No newline at end of file
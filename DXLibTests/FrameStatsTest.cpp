@@ -0,0 +1,76 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <FrameStats.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DXLibTests
+{
+	TEST_CLASS(FrameStatsTest)
+	{
+	public:
+
+        TEST_METHOD(HistogramPercentiles) {
+            dx::TimeHistogram h;
+            Assert::AreEqual(0.0, h.GetPercentile(99.0));
+
+            // 1ms to 100ms in 1ms steps.
+            for (int i = 1; i <= 100; ++i) {
+                h.Record(i / 1000.0);
+            }
+
+            Assert::IsTrue(h.GetCount() == 100);
+            Assert::AreEqual(0.001, h.GetMin(), 1e-9);
+            Assert::AreEqual(0.1, h.GetMax(), 1e-9);
+            Assert::AreEqual(0.0505, h.GetMean(), 1e-9);
+
+            // Buckets are within ~6% of the actual value.
+            Assert::AreEqual(0.050, h.GetPercentile(50.0), 0.050 * 0.07);
+            Assert::AreEqual(0.095, h.GetPercentile(95.0), 0.095 * 0.07);
+            Assert::AreEqual(0.099, h.GetPercentile(99.0), 0.099 * 0.07);
+            Assert::AreEqual(0.1, h.GetPercentile(100.0), 1e-9);
+        }
+
+        TEST_METHOD(HistogramMerge) {
+            dx::TimeHistogram a, b;
+            a.Record(0.001);
+            b.Record(0.5);
+            a.Merge(b);
+
+            Assert::IsTrue(a.GetCount() == 2);
+            Assert::AreEqual(0.001, a.GetMin(), 1e-9);
+            Assert::AreEqual(0.5, a.GetMax(), 1e-9);
+
+            a.Reset();
+            Assert::IsTrue(a.GetCount() == 0);
+            Assert::AreEqual(0.0, a.GetMax());
+        }
+
+        TEST_METHOD(RollingWindow) {
+            dx::FrameStats stats(10);
+
+            // A stutter stays visible until a second window has filled up.
+            stats.Record(dx::FrameZone::FRAME, 0.1);
+            stats.EndFrame();
+            for (int i = 0; i < 18; ++i) {
+                stats.Record(dx::FrameZone::FRAME, 0.016);
+                stats.EndFrame();
+            }
+
+            dx::FrameStatsSnapshot snapshot;
+            stats.GetSnapshot(snapshot);
+            Assert::AreEqual(0.1, snapshot.zones[dx::FrameZone::FRAME].max, 1e-9);
+
+            stats.Record(dx::FrameZone::FRAME, 0.016);
+            stats.EndFrame();
+            stats.GetSnapshot(snapshot);
+
+            // The stutter rolled out of the window but not out of the lifetime stats.
+            Assert::AreEqual(0.016, snapshot.zones[dx::FrameZone::FRAME].max, 1e-9);
+            Assert::AreEqual(0.016, snapshot.zones[dx::FrameZone::FRAME].p99, 0.016 * 0.07);
+            Assert::AreEqual(0.1, stats.GetLifetime(dx::FrameZone::FRAME).GetMax(), 1e-9);
+            Assert::IsTrue(snapshot.frames == 20);
+        }
+	};
+}
\ No newline at end of file
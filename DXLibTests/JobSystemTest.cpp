@@ -0,0 +1,82 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <JobSystem.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static void Increment(void *data) {
+    static_cast<std::atomic<int>*>(data)->fetch_add(1);
+}
+
+struct Stage {
+    std::atomic<int> *order;
+    int seen;
+    int delayMillis;
+};
+
+static void RecordOrder(void *data) {
+    Stage *stage = static_cast<Stage*>(data);
+    std::this_thread::sleep_for(std::chrono::milliseconds(stage->delayMillis));
+    stage->seen = stage->order->fetch_add(1);
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(JobSystemTest)
+	{
+	public:
+
+        TEST_METHOD(RunAndWait) {
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+
+            std::atomic<int> value(0);
+            dx::JobCounter counter;
+            for (int i = 0; i < 10000; ++i) {
+                jobs.Run(dx::MakeJob(&Increment, &value, &counter));
+            }
+            jobs.Wait(counter);
+
+            Assert::IsTrue(counter.IsDone());
+            Assert::AreEqual(10000, value.load());
+        }
+
+        TEST_METHOD(ParallelForCoversRange) {
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+
+            std::vector<int> hits(100003, 0);
+            jobs.ParallelFor(0, (unsigned int)hits.size(), 1000, [&](unsigned int first, unsigned int last) {
+                for (unsigned int i = first; i < last; ++i) hits[i]++;
+            });
+
+            for (size_t i = 0; i < hits.size(); ++i) {
+                Assert::AreEqual(1, hits[i]);
+            }
+        }
+
+        TEST_METHOD(Dependencies) {
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+
+            std::atomic<int> order(0);
+            Stage first = { &order, -1, 20 };
+            Stage second = { &order, -1, 0 };
+
+            // The slow first job would finish last if it weren't for the dependency.
+            dx::JobCounter firstDone, allDone;
+            jobs.Run(dx::MakeJob(&RecordOrder, &first, &firstDone));
+            jobs.Run(dx::MakeJob(&RecordOrder, &second, &allDone, &firstDone));
+            jobs.Wait(allDone);
+
+            Assert::AreEqual(0, first.seen);
+            Assert::AreEqual(1, second.seen);
+        }
+	};
+}
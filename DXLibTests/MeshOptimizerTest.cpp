@@ -0,0 +1,146 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <MeshOptimizer.h>
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// A size x size grid of quads, triangles in random order. Colors
+// identify the vertices.
+static void MakeShuffledGrid(UINT size, std::vector<dx::Vertex> &vertices, std::vector<UINT> &indices) {
+    UINT side = size + 1;
+    vertices.resize(side * side);
+    for (UINT y = 0; y < side; ++y) {
+        for (UINT x = 0; x < side; ++x) {
+            dx::Vertex &vertex = vertices[y * side + x];
+            vertex.position = Vector3f(static_cast<float>(x), static_cast<float>(y), 0.0f);
+            vertex.color = y * side + x;
+        }
+    }
+
+    std::vector<UINT> triangles;
+    for (UINT y = 0; y < size; ++y) {
+        for (UINT x = 0; x < size; ++x) {
+            UINT corner = y * side + x;
+            UINT quad[6] = { corner, corner + 1, corner + side, corner + side, corner + 1, corner + side + 1 };
+            triangles.insert(triangles.end(), quad, quad + 6);
+        }
+    }
+
+    UINT triangleCount = static_cast<UINT>(triangles.size() / 3);
+    unsigned int seed = 7;
+    for (UINT t = triangleCount - 1; t > 0; --t) {
+        seed = seed * 1103515245 + 12345;
+        UINT other = (seed >> 8) % (t + 1);
+        std::swap_ranges(triangles.begin() + t * 3, triangles.begin() + t * 3 + 3, triangles.begin() + other * 3);
+    }
+    indices = triangles;
+}
+
+// The triangles' vertex colors, each triangle's corners in order.
+static std::vector<UINT> SortedTriangles(const std::vector<dx::Vertex> &vertices, const UINT *indices, UINT indexCount) {
+    std::vector<unsigned long long> keys;
+    for (UINT i = 0; i < indexCount; i += 3) {
+        unsigned long long key = vertices[indices[i]].color;
+        key = key * 100000 + vertices[indices[i + 1]].color;
+        key = key * 100000 + vertices[indices[i + 2]].color;
+        keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    return std::vector<UINT>(keys.begin(), keys.end());
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(MeshOptimizerTest)
+	{
+	public:
+
+        TEST_METHOD(AnalyzesFifoCache) {
+            UINT indices[] = { 0, 1, 2, 2, 1, 3, 4, 5, 6, 0, 1, 2 };
+            dx::VertexCacheStats stats = dx::AnalyzeVertexCache(indices, 12, 7, 4);
+            // 0-3, then 4-6 push out 0-2 and they miss again.
+            Assert::IsTrue(stats.triangles == 4 && stats.vertices == 7);
+            Assert::IsTrue(stats.transforms == 10);
+            Assert::AreEqual(2.5f, stats.acmr);
+        }
+
+        TEST_METHOD(OptimizedMeshKeepsItsTriangles) {
+            std::vector<dx::Vertex> vertices;
+            std::vector<UINT> indices;
+            MakeShuffledGrid(64, vertices, indices);
+            // An unused vertex, dropped by the fetch remap.
+            dx::Vertex unused = vertices[0];
+            unused.color = 99999;
+            vertices.insert(vertices.begin(), unused);
+            for (size_t i = 0; i < indices.size(); ++i) ++indices[i];
+            std::vector<UINT> original = SortedTriangles(vertices, &indices[0], static_cast<UINT>(indices.size()));
+
+            dx::IndexedMesh mesh = { &vertices[0], static_cast<UINT>(vertices.size()), &indices[0], static_cast<UINT>(indices.size()) };
+            dx::OptimizeMesh(mesh);
+
+            Assert::IsTrue(mesh.vertexCount == 65 * 65);
+            Assert::IsTrue(mesh.before.acmr > 2.0f);
+            Assert::IsTrue(mesh.after.acmr < 0.8f);
+            Assert::IsTrue(mesh.after.atvr < mesh.before.atvr);
+            Assert::IsTrue(SortedTriangles(vertices, mesh.indices, mesh.indexCount) == original);
+
+            // Vertices are in the order the indices first use them.
+            UINT next = 0;
+            for (UINT i = 0; i < mesh.indexCount; ++i) {
+                Assert::IsTrue(mesh.indices[i] <= next);
+                if (mesh.indices[i] == next) ++next;
+            }
+            Assert::IsTrue(next == mesh.vertexCount);
+        }
+
+        TEST_METHOD(OutwardClustersDrawFirst) {
+            // Two quads facing +z, one behind the mesh center facing it
+            // and one in front facing away. Sharing no vertices they are
+            // separate clusters.
+            dx::Vertex vertices[8];
+            for (UINT i = 0; i < 8; ++i) {
+                vertices[i].position = Vector3f(static_cast<float>(i & 1), static_cast<float>((i >> 1) & 1), i < 4 ? -1.0f : 1.0f);
+                vertices[i].color = i;
+            }
+            UINT indices[] = { 0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7 };
+
+            UINT optimized[12];
+            dx::OptimizeOverdraw(optimized, indices, 12, vertices, 8);
+            UINT expected[] = { 4, 5, 6, 6, 5, 7, 0, 1, 2, 2, 1, 3 };
+            Assert::IsTrue(std::equal(optimized, optimized + 12, expected));
+        }
+
+        TEST_METHOD(ParallelMatchesSerial) {
+            const UINT kMeshes = 12;
+            std::vector<dx::Vertex> vertices[kMeshes], serialVertices[kMeshes];
+            std::vector<UINT> indices[kMeshes], serialIndices[kMeshes];
+            dx::IndexedMesh meshes[kMeshes], serial[kMeshes];
+            for (UINT i = 0; i < kMeshes; ++i) {
+                MakeShuffledGrid(8 + i * 3, vertices[i], indices[i]);
+                serialVertices[i] = vertices[i];
+                serialIndices[i] = indices[i];
+                dx::IndexedMesh mesh = { &vertices[i][0], static_cast<UINT>(vertices[i].size()), &indices[i][0], static_cast<UINT>(indices[i].size()) };
+                meshes[i] = mesh;
+                dx::IndexedMesh copy = { &serialVertices[i][0], mesh.vertexCount, &serialIndices[i][0], mesh.indexCount };
+                serial[i] = copy;
+            }
+
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+            dx::OptimizeMeshes(meshes, kMeshes, &jobs);
+            jobs.Shutdown();
+            dx::OptimizeMeshes(serial, kMeshes, nullptr);
+
+            for (UINT i = 0; i < kMeshes; ++i) {
+                Assert::IsTrue(indices[i] == serialIndices[i]);
+                Assert::IsTrue(meshes[i].after.transforms == serial[i].after.transforms);
+                Assert::IsTrue(meshes[i].after.acmr < meshes[i].before.acmr);
+            }
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <NullRenderSystem.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static void DrawTriangles(dx::RenderSystem &r, UINT count) {
+    dx::Vertex vertices[3];
+    UINT indices[3] = { 0, 1, 2 };
+
+    dx::DrawCommand command;
+    command.vertices = vertices;
+    command.vertexCount = 3;
+    command.indices = indices;
+    command.indexCount = 3;
+    for (UINT i = 0; i < count; ++i) {
+        r.Draw(command);
+    }
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(NullRenderSystemTest)
+	{
+	public:
+
+        TEST_METHOD(FactoryCreatesNullBackend) {
+            dx::RenderSystem *r = dx::RenderSystem::Create(dx::RenderBackend::NULL_DEVICE);
+            Assert::IsTrue(r->GetBackend() == dx::RenderBackend::NULL_DEVICE);
+            Assert::IsTrue(r->Initialize(nullptr, 320, 240, nullptr) == dx::Error::OK);
+            Assert::IsTrue(r->IsHeadless());
+            delete r;
+        }
+
+        TEST_METHOD(CountsPerFrame) {
+            dx::NullRenderSystem r;
+            r.Initialize(nullptr, 64, 64, nullptr);
+
+            r.Clear(Vector4f::kZero);
+            DrawTriangles(r, 5);
+            Assert::IsTrue(r.GetDrawCallCount() == 0);
+            r.Present();
+
+            Assert::IsTrue(r.GetDrawCallCount() == 5);
+            Assert::IsTrue(r.GetLastFrame().clears == 1);
+            Assert::IsTrue(r.GetLastFrame().draws == 5);
+            Assert::IsTrue(r.GetLastFrame().vertices == 15);
+            Assert::IsTrue(r.GetLastFrame().indices == 15);
+            Assert::IsTrue(r.GetLastFrame().submitSeconds >= 0.0);
+
+            DrawTriangles(r, 2);
+            r.Present();
+            Assert::IsTrue(r.GetLastFrame().draws == 2);
+            Assert::IsTrue(r.GetLastFrame().clears == 0);
+            Assert::IsTrue(r.GetTotals().draws == 7);
+            Assert::IsTrue(r.GetTotals().presents == 2);
+        }
+
+        TEST_METHOD(RecordsCallsInOrder) {
+            dx::NullRenderSystem r;
+            r.Initialize(nullptr, 64, 64, nullptr);
+
+            DrawTriangles(r, 1);
+            Assert::IsTrue(r.GetRecording().empty());
+
+            r.SetRecording(true);
+            r.Clear(Vector4f::kZero);
+            DrawTriangles(r, 1);
+            r.Present();
+
+            const std::vector<dx::NullRenderRecord> &calls = r.GetRecording();
+            Assert::IsTrue(calls.size() == 3);
+            Assert::IsTrue(calls[0].call == dx::NullRenderCall::CLEAR);
+            Assert::IsTrue(calls[1].call == dx::NullRenderCall::DRAW);
+            Assert::IsTrue(calls[1].vertexCount == 3);
+            Assert::IsTrue(calls[2].call == dx::NullRenderCall::PRESENT);
+        }
+	};
+}
\ No newline at end of file
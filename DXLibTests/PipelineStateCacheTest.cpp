@@ -0,0 +1,172 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <PipelineStateCache.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static ID3D11Device* CreateWarpDevice() {
+    ID3D11Device *device = nullptr;
+    D3D11CreateDevice(NULL, D3D_DRIVER_TYPE_WARP, NULL, 0, NULL, 0, D3D11_SDK_VERSION, &device, NULL, NULL);
+    return device;
+}
+
+static D3D11_RASTERIZER_DESC MakeRasterizerDesc(int depthBias) {
+    D3D11_RASTERIZER_DESC rd;
+    memset(&rd, 0, sizeof(rd));
+    rd.FillMode = D3D11_FILL_SOLID;
+    rd.CullMode = D3D11_CULL_BACK;
+    rd.DepthBias = depthBias;
+    rd.DepthClipEnable = TRUE;
+    return rd;
+}
+
+// Fills everything, padding included, with *garbage* first.
+static D3D11_DEPTH_STENCIL_DESC MakeDepthStencilDesc(unsigned char garbage) {
+    D3D11_DEPTH_STENCIL_DESC dd;
+    memset(&dd, garbage, sizeof(dd));
+    dd.DepthEnable = TRUE;
+    dd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    dd.DepthFunc = D3D11_COMPARISON_LESS;
+    dd.StencilEnable = FALSE;
+    dd.StencilReadMask = 0xFF;
+    dd.StencilWriteMask = 0xFF;
+    D3D11_DEPTH_STENCILOP_DESC op = { D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, D3D11_COMPARISON_ALWAYS };
+    dd.FrontFace = op;
+    dd.BackFace = op;
+    return dd;
+}
+
+static D3D11_BLEND_DESC MakeBlendDesc(unsigned char garbage) {
+    D3D11_BLEND_DESC bd;
+    memset(&bd, garbage, sizeof(bd));
+    bd.AlphaToCoverageEnable = FALSE;
+    bd.IndependentBlendEnable = FALSE;
+    D3D11_RENDER_TARGET_BLEND_DESC &rt = bd.RenderTarget[0];
+    rt.BlendEnable = TRUE;
+    rt.SrcBlend = D3D11_BLEND_SRC_ALPHA;
+    rt.DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    rt.BlendOp = D3D11_BLEND_OP_ADD;
+    rt.SrcBlendAlpha = D3D11_BLEND_ONE;
+    rt.DestBlendAlpha = D3D11_BLEND_ZERO;
+    rt.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    rt.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+    return bd;
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(PipelineStateCacheTest)
+	{
+	public:
+
+        TEST_METHOD(EqualDescsShareState) {
+            ID3D11Device *device = CreateWarpDevice();
+            Assert::IsTrue(device != nullptr);
+            {
+                dx::PipelineStateCache cache;
+                cache.Initialize(device);
+
+                ID3D11RasterizerState *a = cache.GetRasterizerState(MakeRasterizerDesc(0));
+                ID3D11RasterizerState *b = cache.GetRasterizerState(MakeRasterizerDesc(0));
+                ID3D11RasterizerState *c = cache.GetRasterizerState(MakeRasterizerDesc(4));
+                Assert::IsTrue(a != nullptr);
+                Assert::IsTrue(a == b);
+                Assert::IsTrue(a != c);
+                Assert::IsTrue(cache.GetStateCount(dx::PipelineStateKind::RASTERIZER) == 2);
+
+                dx::PipelineStateCacheStats stats = cache.GetStats();
+                Assert::IsTrue(stats.lookups == 3);
+                Assert::IsTrue(stats.hits == 1);
+                Assert::IsTrue(stats.misses == 2);
+            }
+            device->Release();
+        }
+
+        // Padding and render targets blending ignores must not split states.
+        TEST_METHOD(IgnoredBytesDontSplitStates) {
+            ID3D11Device *device = CreateWarpDevice();
+            Assert::IsTrue(device != nullptr);
+            {
+                dx::PipelineStateCache cache;
+                cache.Initialize(device);
+
+                Assert::IsTrue(cache.GetBlendState(MakeBlendDesc(0x00)) == cache.GetBlendState(MakeBlendDesc(0xCD)));
+                Assert::IsTrue(cache.GetDepthStencilState(MakeDepthStencilDesc(0x00)) ==
+                               cache.GetDepthStencilState(MakeDepthStencilDesc(0xCD)));
+                Assert::IsTrue(cache.GetStateCount(dx::PipelineStateKind::BLEND) == 1);
+                Assert::IsTrue(cache.GetStateCount(dx::PipelineStateKind::DEPTH_STENCIL) == 1);
+            }
+            device->Release();
+        }
+
+        TEST_METHOD(WarmedStatesOnlyHit) {
+            ID3D11Device *device = CreateWarpDevice();
+            Assert::IsTrue(device != nullptr);
+            {
+                dx::PipelineStateCache cache;
+                cache.Initialize(device);
+
+                dx::PipelineStateSet set;
+                for (int i = 0; i < 8; ++i) {
+                    set.rasterizer.push_back(MakeRasterizerDesc(i));
+                }
+                set.blend.push_back(MakeBlendDesc(0));
+                Assert::IsTrue(cache.Warm(set) == dx::Error::OK);
+
+                for (int frame = 0; frame < 10; ++frame) {
+                    for (int i = 0; i < 8; ++i) {
+                        Assert::IsTrue(cache.GetRasterizerState(MakeRasterizerDesc(i)) != nullptr);
+                    }
+                    cache.GetBlendState(MakeBlendDesc(0));
+                }
+
+                dx::PipelineStateCacheStats stats = cache.GetStats();
+                Assert::IsTrue(stats.prebuilt == 9);
+                Assert::IsTrue(stats.misses == 0);
+                Assert::IsTrue(stats.HitRate() == 1.0);
+            }
+            device->Release();
+        }
+
+        TEST_METHOD(ThreadsAgreeOnStates) {
+            ID3D11Device *device = CreateWarpDevice();
+            Assert::IsTrue(device != nullptr);
+            {
+                dx::PipelineStateCache cache;
+                cache.Initialize(device);
+
+                const int kThreads = 4;
+                const int kDescs = 64;
+                std::vector<ID3D11RasterizerState*> seen(kThreads * kDescs);
+                std::vector<std::thread> threads;
+                for (int t = 0; t < kThreads; ++t) {
+                    threads.push_back(std::thread([&cache, &seen, t]() {
+                        for (int i = 0; i < kDescs; ++i) {
+                            // Each thread walks the descriptions in a different order.
+                            int d = (i * 7 + t * 13) % kDescs;
+                            seen[t * kDescs + d] = cache.GetRasterizerState(MakeRasterizerDesc(d));
+                        }
+                    }));
+                }
+                for (size_t t = 0; t < threads.size(); ++t) {
+                    threads[t].join();
+                }
+
+                for (int i = 0; i < kDescs; ++i) {
+                    Assert::IsTrue(seen[i] != nullptr);
+                    for (int t = 1; t < kThreads; ++t) {
+                        Assert::IsTrue(seen[t * kDescs + i] == seen[i]);
+                    }
+                }
+                Assert::IsTrue(cache.GetStateCount(dx::PipelineStateKind::RASTERIZER) == kDescs);
+                Assert::IsTrue(cache.GetStats().misses == kDescs);
+            }
+            device->Release();
+        }
+	};
+}
\ No newline at end of file
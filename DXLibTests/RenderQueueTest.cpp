@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <JobSystem.h>
+#include <NullRenderSystem.h>
+#include <RenderQueue.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static unsigned long long RandomKey() {
+    // Leave some bytes constant so passes get skipped.
+    return dx::RenderKey::Make(rand() % 3, rand() % 2, rand() % 1000, rand() % 50, rand() % 20);
+}
+
+// Stable by construction, the push order is part of the comparison.
+static std::vector<std::pair<unsigned long long, UINT> > ReferenceOrder(const std::vector<unsigned long long> &keys) {
+    std::vector<std::pair<unsigned long long, UINT> > order;
+    for (UINT i = 0; i < keys.size(); ++i) {
+        order.push_back(std::make_pair(keys[i], i));
+    }
+    std::sort(order.begin(), order.end());
+    return order;
+}
+
+// Tags every draw with its push index in the vertex count.
+static void Fill(dx::RenderQueue &queue, const std::vector<unsigned long long> &keys) {
+    queue.Clear();
+    for (UINT i = 0; i < keys.size(); ++i) {
+        dx::DrawCommand command;
+        command.vertexCount = i;
+        queue.Push(keys[i], command);
+    }
+}
+
+static void CheckOrder(dx::RenderQueue &queue, const std::vector<unsigned long long> &keys) {
+    std::vector<std::pair<unsigned long long, UINT> > expected = ReferenceOrder(keys);
+
+    dx::NullRenderSystem r;
+    r.Initialize(nullptr, 1, 1, nullptr);
+    r.SetRecording(true);
+    queue.Submit(r);
+
+    const std::vector<dx::NullRenderRecord> &calls = r.GetRecording();
+    Assert::IsTrue(calls.size() == keys.size());
+    for (UINT i = 0; i < keys.size(); ++i) {
+        Assert::IsTrue(queue.GetSortedKey(i) == expected[i].first);
+        Assert::IsTrue(calls[i].vertexCount == expected[i].second);
+    }
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(RenderQueueTest)
+	{
+	public:
+
+        TEST_METHOD(KeyFieldsRoundTrip) {
+            unsigned long long key = dx::RenderKey::Make(15, 3, 65535, 0xABCDEF, 1234);
+            Assert::IsTrue(dx::RenderKey::GetLayer(key) == 15);
+            Assert::IsTrue(dx::RenderKey::GetPass(key) == 3);
+            Assert::IsTrue(dx::RenderKey::GetDepth(key) == 65535);
+            Assert::IsTrue(dx::RenderKey::GetMaterial(key) == 0xABCDEF);
+            Assert::IsTrue(dx::RenderKey::GetMesh(key) == 1234);
+
+            // Layers outrank everything below them.
+            Assert::IsTrue(dx::RenderKey::Make(1, 0, 0, 0, 0) > dx::RenderKey::Make(0, 15, 65535, 0xFFFFFF, 65535));
+            Assert::IsTrue(dx::RenderKey::QuantizeDepth(0.25f) < dx::RenderKey::QuantizeDepth(0.75f));
+            Assert::IsTrue(dx::RenderKey::QuantizeDepth(0.25f, true) > dx::RenderKey::QuantizeDepth(0.75f, true));
+        }
+
+        TEST_METHOD(SortIsStable) {
+            srand(42);
+            std::vector<unsigned long long> keys(3000);
+            for (size_t i = 0; i < keys.size(); ++i) keys[i] = RandomKey();
+
+            dx::RenderQueue queue;
+            Fill(queue, keys);
+            queue.Sort();
+            CheckOrder(queue, keys);
+        }
+
+        TEST_METHOD(ParallelSortMatchesSerial) {
+            srand(7);
+            std::vector<unsigned long long> keys(50000);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                keys[i] = RandomKey() ^ (static_cast<unsigned long long>(rand()) << 40);
+            }
+
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+            dx::RenderQueue queue;
+            Fill(queue, keys);
+            queue.Sort(&jobs);
+            jobs.Shutdown();
+
+            CheckOrder(queue, keys);
+        }
+
+        TEST_METHOD(RedundantStateIsFiltered) {
+            std::vector<unsigned long long> keys;
+            for (UINT i = 0; i < 100; ++i) {
+                keys.push_back(dx::RenderKey::Make(0, i % 2, 0, i % 5, i % 10));
+            }
+
+            dx::RenderQueue queue;
+            Fill(queue, keys);
+            queue.Sort();
+
+            dx::NullRenderSystem r;
+            queue.Submit(r);
+            // Both passes see all 5 materials, with one mesh each.
+            Assert::IsTrue(queue.GetStats().items == 100);
+            Assert::IsTrue(queue.GetStats().passChanges == 2);
+            Assert::IsTrue(queue.GetStats().materialChanges == 10);
+            Assert::IsTrue(queue.GetStats().meshChanges == 10);
+        }
+	};
+}
\ No newline at end of file
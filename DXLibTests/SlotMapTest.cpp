@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <SlotMap.h>
+#include <FixedPool.h>
+#include <JobSystem.h>
+
+#include <atomic>
+#include <set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DXLibTests
+{
+	TEST_CLASS(SlotMapTest)
+	{
+	public:
+
+        TEST_METHOD(InsertGetErase) {
+            dx::SlotMap<int> map;
+            dx::SlotHandle a = map.Insert(1);
+            dx::SlotHandle b = map.Insert(2);
+            dx::SlotHandle c = map.Insert(3);
+
+            Assert::IsTrue(map.GetSize() == 3);
+            Assert::AreEqual(2, *map.Get(b));
+
+            // Erasing from the middle keeps the others reachable and packed.
+            Assert::IsTrue(map.Erase(a));
+            Assert::IsFalse(map.Erase(a));
+            Assert::IsTrue(map.Get(a) == nullptr);
+            Assert::AreEqual(2, *map.Get(b));
+            Assert::AreEqual(3, *map.Get(c));
+            Assert::IsTrue(map.GetSize() == 2);
+
+            int sum = 0;
+            for (dx::SlotMap<int>::iterator it = map.begin(); it != map.end(); ++it) {
+                sum += *it;
+            }
+            Assert::AreEqual(5, sum);
+        }
+
+        TEST_METHOD(StaleHandles) {
+            dx::SlotMap<int> map;
+            dx::SlotHandle a = map.Insert(1);
+            map.Erase(a);
+
+            // The slot gets reused with a new generation.
+            dx::SlotHandle b = map.Insert(2);
+            Assert::IsTrue(a.GetIndex() == b.GetIndex());
+            Assert::IsTrue(a != b);
+            Assert::IsFalse(map.Contains(a));
+            Assert::AreEqual(2, *map.Get(b));
+
+            Assert::IsFalse(map.Contains(dx::SlotHandle::Null()));
+
+            map.Clear();
+            Assert::IsFalse(map.Contains(b));
+            Assert::IsTrue(map.IsEmpty());
+        }
+
+        TEST_METHOD(HandlesDuringIteration) {
+            dx::SlotMap<int> map;
+            for (int i = 0; i < 100; ++i) {
+                map.Insert(i);
+            }
+            for (unsigned int i = 0; i < map.GetSize(); ++i) {
+                if (map.GetData()[i] % 2 == 0) {
+                    map.Erase(map.GetHandle(i));
+                    --i;
+                }
+            }
+
+            Assert::IsTrue(map.GetSize() == 50);
+            for (unsigned int i = 0; i < map.GetSize(); ++i) {
+                Assert::IsTrue(*map.Get(map.GetHandle(i)) % 2 == 1);
+            }
+        }
+
+        TEST_METHOD(PoolReusesBlocks) {
+            dx::FixedPool pool;
+            pool.Initialize(24, 8);
+            Assert::IsTrue(pool.GetBlockSize() == 32);
+
+            void *a = pool.Allocate();
+            pool.Free(a);
+            Assert::IsTrue(pool.Allocate() == a);
+
+            std::set<void*> blocks;
+            for (int i = 0; i < 20; ++i) {
+                blocks.insert(pool.Allocate());
+            }
+            Assert::IsTrue(blocks.size() == 20);
+            Assert::IsTrue(pool.GetPageCount() == 3);
+        }
+
+        TEST_METHOD(PoolFromWorkers) {
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+
+            dx::FixedPool pool;
+            pool.Initialize(sizeof(int));
+
+            // Blocks allocated on one thread and freed on another must
+            // neither leak nor be handed out twice.
+            std::vector<int*> blocks(2000);
+            jobs.ParallelFor(0, 2000, 16, [&](unsigned int first, unsigned int last) {
+                for (unsigned int i = first; i < last; ++i) {
+                    blocks[i] = static_cast<int*>(pool.Allocate());
+                    *blocks[i] = static_cast<int>(i);
+                }
+            });
+
+            std::atomic<int> mismatches(0);
+            jobs.ParallelFor(0, 2000, 16, [&](unsigned int first, unsigned int last) {
+                for (unsigned int i = first; i < last; ++i) {
+                    unsigned int j = 1999 - i;
+                    if (*blocks[j] != static_cast<int>(j)) mismatches.fetch_add(1);
+                }
+            });
+            Assert::AreEqual(0, mismatches.load());
+
+            jobs.ParallelFor(0, 2000, 16, [&](unsigned int first, unsigned int last) {
+                for (unsigned int i = first; i < last; ++i) {
+                    pool.Free(blocks[1999 - i]);
+                }
+            });
+
+            size_t pages = pool.GetPageCount();
+            std::set<void*> unique;
+            for (int i = 0; i < 1000; ++i) {
+                unique.insert(pool.Allocate());
+            }
+            Assert::IsTrue(unique.size() == 1000);
+            Assert::IsTrue(pool.GetPageCount() == pages);
+
+            jobs.Shutdown();
+        }
+	};
+}
\ No newline at end of file
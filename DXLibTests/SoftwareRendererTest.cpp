@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <JobSystem.h>
+#include <SoftwareRenderer.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static const UINT kRed = 0xFF0000FF;
+static const UINT kBlue = 0xFFFF0000;
+
+static dx::Vertex MakeVertex(float x, float y, float z, UINT color) {
+    dx::Vertex v;
+    v.position = Vector3f(x, y, z);
+    v.color = color;
+    return v;
+}
+
+static UINT CountPixels(const dx::SoftwareRenderer &r, UINT color) {
+    UINT count = 0;
+    for (UINT y = 0; y < r.GetHeight(); ++y) {
+        for (UINT x = 0; x < r.GetWidth(); ++x) {
+            if (r.GetColorBuffer()[y * r.GetPitch() + x] == color) ++count;
+        }
+    }
+    return count;
+}
+
+// Two triangles covering the viewport, split along the diagonal.
+static void DrawQuad(dx::SoftwareRenderer &r, float z, UINT color) {
+    dx::Vertex vertices[4] = {
+        MakeVertex(-1.0f, 1.0f, z, color),
+        MakeVertex(1.0f, 1.0f, z, color),
+        MakeVertex(1.0f, -1.0f, z, color),
+        MakeVertex(-1.0f, -1.0f, z, color),
+    };
+    UINT indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    dx::DrawCommand command;
+    command.vertices = vertices;
+    command.vertexCount = 4;
+    command.indices = indices;
+    command.indexCount = 6;
+    r.Draw(command);
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(SoftwareRendererTest)
+	{
+	public:
+
+        // The shared diagonal must be neither skipped nor drawn twice.
+        TEST_METHOD(QuadCoversEveryPixel) {
+            dx::SoftwareRenderer r;
+            Assert::IsTrue(r.Initialize(203, 97) == dx::Error::OK);
+
+            r.Clear(Vector4f::kZero);
+            DrawQuad(r, 0.5f, kRed);
+            r.Flush();
+
+            // Stored as B8G8R8A8.
+            Assert::IsTrue(CountPixels(r, 0xFFFF0000) == 203 * 97);
+        }
+
+        TEST_METHOD(DepthTestIgnoresOrder) {
+            dx::SoftwareRenderer r;
+            r.Initialize(128, 128);
+
+            r.Clear(Vector4f::kZero);
+            DrawQuad(r, 0.25f, kBlue);
+            DrawQuad(r, 0.75f, kRed);
+            r.Flush();
+            unsigned long long nearFirst = r.HashColorBuffer();
+            Assert::IsTrue(CountPixels(r, 0xFF0000FF) == 128 * 128);
+
+            r.Clear(Vector4f::kZero);
+            DrawQuad(r, 0.75f, kRed);
+            DrawQuad(r, 0.25f, kBlue);
+            r.Flush();
+            Assert::IsTrue(r.HashColorBuffer() == nearFirst);
+        }
+
+        TEST_METHOD(TilesMatchAcrossThreads) {
+            dx::Vertex vertices[] = {
+                MakeVertex(-0.9f, -0.8f, 0.5f, kRed),
+                MakeVertex(0.7f, 0.95f, 0.1f, kBlue),
+                MakeVertex(0.85f, -0.6f, 0.9f, 0xFF00FF00),
+                MakeVertex(-0.5f, 0.9f, 0.3f, 0x8000FFFF),
+                MakeVertex(0.3f, -0.95f, 0.6f, kRed),
+                MakeVertex(2.5f, 3.0f, 0.2f, kBlue),
+            };
+            dx::DrawCommand command;
+            command.vertices = vertices;
+            command.vertexCount = 6;
+
+            dx::SoftwareRenderer single;
+            single.Initialize(300, 200);
+            single.Clear(Vector4f(0.1f, 0.2f, 0.3f, 1.0f));
+            single.Draw(command);
+            single.Flush();
+
+            dx::JobSystem jobs;
+            jobs.Initialize(3);
+            dx::SoftwareRenderer parallel;
+            parallel.Initialize(300, 200, &jobs);
+            parallel.Clear(Vector4f(0.1f, 0.2f, 0.3f, 1.0f));
+            parallel.Draw(command);
+            parallel.Flush();
+            jobs.Shutdown();
+
+            Assert::IsTrue(single.HashColorBuffer() == parallel.HashColorBuffer());
+            Assert::IsTrue(CountPixels(single, 0xFF1A334D) < 300 * 200);
+        }
+	};
+}
\ No newline at end of file
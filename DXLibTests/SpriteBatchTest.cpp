@@ -0,0 +1,83 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <NullRenderSystem.h>
+#include <SoftwareRenderSystem.h>
+#include <SpriteBatch.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static UINT CountPixels(const dx::SoftwareRenderer &r, UINT color) {
+    UINT count = 0;
+    for (UINT y = 0; y < r.GetHeight(); ++y) {
+        for (UINT x = 0; x < r.GetWidth(); ++x) {
+            if (r.GetColorBuffer()[y * r.GetPitch() + x] == color) ++count;
+        }
+    }
+    return count;
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(SpriteBatchTest)
+	{
+	public:
+
+        TEST_METHOD(DrawsOncePerTextureAndLayer) {
+            dx::NullRenderSystem r;
+            r.Initialize(nullptr, 640, 480, nullptr);
+
+            dx::SpriteBatch batch;
+            batch.Begin(640, 480);
+            for (UINT i = 0; i < 1000; ++i) {
+                batch.Draw(RectangleF(static_cast<float>(i % 640), static_cast<float>(i % 480), 8.0f, 8.0f),
+                           0xFFFFFFFF, i % 3, i % 2);
+            }
+            batch.End(r);
+            r.Present();
+
+            Assert::IsTrue(batch.GetStats().sprites == 1000);
+            Assert::IsTrue(batch.GetStats().draws == 6);
+            Assert::IsTrue(r.GetLastFrame().vertices == 4000);
+            Assert::IsTrue(r.GetLastFrame().indices == 6000);
+        }
+
+        TEST_METHOD(SplitsLongRuns) {
+            dx::NullRenderSystem r;
+            r.Initialize(nullptr, 640, 480, nullptr);
+
+            dx::SpriteBatch batch;
+            batch.Begin(640, 480);
+            for (UINT i = 0; i < dx::SpriteBatch::kMaxSpritesPerDraw + 10; ++i) {
+                batch.Draw(RectangleF(0.0f, 0.0f, 1.0f, 1.0f), 0xFFFFFFFF);
+            }
+            batch.End(r);
+
+            Assert::IsTrue(batch.GetStats().draws == 2);
+            Assert::IsTrue(batch.GetStats().textureChanges == 1);
+        }
+
+        TEST_METHOD(CoversDestinationPixels) {
+            dx::SoftwareRenderSystem r;
+            r.Initialize(nullptr, 64, 48, nullptr);
+            r.Clear(Vector4f::kZero);
+
+            dx::SpriteBatch batch;
+            batch.Begin(64, 48);
+            batch.Draw(RectangleF(10.0f, 8.0f, 20.0f, 12.0f), 0xFF0000FF);
+
+            // Nearer, so it wins where the two overlap.
+            dx::Sprite top;
+            top.dest = RectangleF(20.0f, 8.0f, 4.0f, 4.0f);
+            top.color = 0xFFFF0000;
+            top.depth = 0.25f;
+            batch.Draw(top);
+            batch.End(r);
+            r.Present();
+
+            // Stored as B8G8R8A8.
+            Assert::IsTrue(CountPixels(r.GetSoftwareRenderer(), 0xFFFF0000) == 20 * 12 - 16);
+            Assert::IsTrue(CountPixels(r.GetSoftwareRenderer(), 0xFF0000FF) == 16);
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <UploadRing.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DXLibTests
+{
+	TEST_CLASS(UploadRingTest)
+	{
+	public:
+
+        TEST_METHOD(AllocatesAligned) {
+            dx::UploadRing ring;
+            ring.Initialize(1024);
+
+            Assert::IsTrue(ring.Allocate(10, 16) == 0);
+            Assert::IsTrue(ring.Allocate(10, 16) == 16);
+            Assert::IsTrue(ring.Allocate(4, 256) == 256);
+            // Padding counts as used.
+            Assert::IsTrue(ring.GetUsedBytes() == 260);
+        }
+
+        TEST_METHOD(WaitsForFramesInFlight) {
+            dx::UploadRing ring;
+            ring.Initialize(1000);
+
+            Assert::IsTrue(ring.Allocate(400, 4) == 0);
+            ring.EndFrame();
+            Assert::IsTrue(ring.Allocate(400, 4) == 400);
+            ring.EndFrame();
+
+            // The end is too small, the start still in use.
+            Assert::IsTrue(!ring.Fits(300, 4));
+            Assert::IsTrue(ring.Allocate(300, 4) == dx::UploadRing::kNoSpace);
+
+            ring.RetireFrame();
+            Assert::IsTrue(ring.Fits(300, 4));
+            Assert::IsTrue(ring.Allocate(300, 4) == 0);
+            Assert::IsTrue(ring.GetStats().wraps == 1);
+            // 200 skipped at the end plus the new 300.
+            Assert::IsTrue(ring.GetUsedBytes() == 400 + 200 + 300);
+
+            ring.EndFrame();
+            Assert::IsTrue(ring.GetStats().frameBytes == 500);
+            Assert::IsTrue(ring.GetStats().frameAllocations == 1);
+            Assert::IsTrue(ring.GetStats().peakBytes == 900);
+        }
+
+        TEST_METHOD(NeverOverlapsLiveData) {
+            const unsigned int kCapacity = 4096;
+            dx::UploadRing ring;
+            ring.Initialize(kCapacity);
+
+            // Byte owners, 0 when free.
+            static int owner[kCapacity];
+            unsigned int liveFrames[dx::UploadRing::kMaxFramesInFlight];
+            unsigned int first = 0, count = 0;
+
+            unsigned int seed = 1;
+            for (int frame = 1; frame <= 2000; ++frame) {
+                for (int i = 0; i < 5; ++i) {
+                    seed = seed * 1103515245 + 12345;
+                    unsigned int size = 1 + (seed >> 16) % 300;
+                    bool fits = ring.Fits(size, 16);
+                    unsigned int offset = ring.Allocate(size, 16);
+                    Assert::IsTrue(fits == (offset != dx::UploadRing::kNoSpace));
+                    while (offset == dx::UploadRing::kNoSpace) {
+                        Assert::IsTrue(count > 0);
+                        for (unsigned int b = 0; b < kCapacity; ++b) {
+                            if (owner[b] == static_cast<int>(liveFrames[first])) owner[b] = 0;
+                        }
+                        ring.RetireFrame();
+                        first = (first + 1) % dx::UploadRing::kMaxFramesInFlight;
+                        --count;
+                        offset = ring.Allocate(size, 16);
+                    }
+
+                    Assert::IsTrue(offset % 16 == 0 && offset + size <= kCapacity);
+                    for (unsigned int b = offset; b < offset + size; ++b) {
+                        Assert::IsTrue(owner[b] == 0);
+                        owner[b] = frame;
+                    }
+                }
+
+                if (count == 3) {
+                    for (unsigned int b = 0; b < kCapacity; ++b) {
+                        if (owner[b] == static_cast<int>(liveFrames[first])) owner[b] = 0;
+                    }
+                    ring.RetireFrame();
+                    first = (first + 1) % dx::UploadRing::kMaxFramesInFlight;
+                    --count;
+                }
+                ring.EndFrame();
+                liveFrames[(first + count) % dx::UploadRing::kMaxFramesInFlight] = frame;
+                ++count;
+            }
+        }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <VertexFormat.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+static float Random(unsigned int &seed) {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<float>((seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+namespace DXLibTests
+{
+	TEST_CLASS(VertexFormatTest)
+	{
+	public:
+
+        TEST_METHOD(LayoutsWorkOutStrideAndInputLayout) {
+            Assert::IsTrue(dx::FullVertexLayout::kStride == 36);
+            Assert::IsTrue(dx::PackedVertexLayout::kStride == 20);
+            Assert::IsTrue(dx::PackedVertexLayout::kElementCount == 4);
+
+            D3D11_INPUT_ELEMENT_DESC layout[dx::PackedVertexLayout::kElementCount];
+            dx::PackedVertexLayout::GetInputLayout(layout);
+            Assert::IsTrue(strcmp(layout[0].SemanticName, "POSITION") == 0);
+            Assert::IsTrue(layout[0].Format == DXGI_FORMAT_R16G16B16A16_FLOAT && layout[0].AlignedByteOffset == 0);
+            Assert::IsTrue(strcmp(layout[1].SemanticName, "NORMAL") == 0);
+            Assert::IsTrue(layout[1].Format == DXGI_FORMAT_R16G16_SNORM && layout[1].AlignedByteOffset == 8);
+            Assert::IsTrue(strcmp(layout[2].SemanticName, "TEXCOORD") == 0);
+            Assert::IsTrue(layout[2].Format == DXGI_FORMAT_R16G16_UNORM && layout[2].AlignedByteOffset == 12);
+            Assert::IsTrue(strcmp(layout[3].SemanticName, "COLOR") == 0);
+            Assert::IsTrue(layout[3].Format == DXGI_FORMAT_R8G8B8A8_UNORM && layout[3].AlignedByteOffset == 16);
+        }
+
+        TEST_METHOD(HalfConversionRounds) {
+            Assert::IsTrue(dx::FloatToHalf(1.0f) == 0x3C00);
+            Assert::IsTrue(dx::FloatToHalf(-2.0f) == 0xC000);
+            Assert::IsTrue(dx::FloatToHalf(65504.0f) == 0x7BFF);
+            Assert::IsTrue(dx::FloatToHalf(1e6f) == 0x7C00);
+            Assert::IsTrue(dx::FloatToHalf(-1e6f) == 0xFC00);
+            // Smallest subnormal.
+            Assert::IsTrue(dx::FloatToHalf(5.9604645e-8f) == 0x0001);
+            // Halfway between 1 and the next half rounds to even.
+            Assert::IsTrue(dx::FloatToHalf(1.0f + 1.0f / 2048.0f) == 0x3C00);
+            Assert::IsTrue(dx::FloatToHalf(1.0f + 3.0f / 2048.0f) == 0x3C02);
+
+            for (unsigned int h = 0; h < 0x7C00; ++h) {
+                unsigned short half = static_cast<unsigned short>(h);
+                Assert::IsTrue(dx::FloatToHalf(dx::HalfToFloat(half)) == half);
+                Assert::IsTrue(dx::HalfToFloat(half | 0x8000) == -dx::HalfToFloat(half));
+            }
+            float nan = dx::HalfToFloat(0x7E00);
+            Assert::IsTrue(nan != nan);
+        }
+
+        TEST_METHOD(PackedVerticesRoundTrip) {
+            // Not a multiple of the batch size.
+            const UINT kCount = 1003;
+            std::vector<dx::MeshVertex> vertices(kCount);
+            unsigned int seed = 3;
+            for (UINT i = 0; i < kCount; ++i) {
+                dx::MeshVertex &vertex = vertices[i];
+                vertex.position = Vector3f(Random(seed) * 200.0f - 100.0f, Random(seed) * 2.0f - 1.0f, Random(seed) * 10.0f);
+                vertex.normal = Vector3f(Random(seed) - 0.5f, Random(seed) - 0.5f, Random(seed) - 0.5f).GetUnit();
+                vertex.texcoord = Vector2f(Random(seed), Random(seed));
+                vertex.color = i * 2654435761u;
+            }
+            // Along the axes and on the octahedron's edges.
+            vertices[0].normal = Vector3f(0.0f, 0.0f, -1.0f);
+            vertices[1].normal = Vector3f(1.0f, 0.0f, 0.0f);
+            vertices[2].normal = Vector3f(0.0f, -1.0f, 0.0f);
+            vertices[3].normal = Vector3f(-1.0f, 1.0f, 0.0f).GetUnit();
+
+            std::vector<char> packed(kCount * dx::PackedVertexLayout::kStride + 1, 0x55);
+            dx::PackedVertexLayout::Encode(&vertices[0], kCount, &packed[0]);
+            // Nothing written past the end.
+            Assert::IsTrue(packed.back() == 0x55);
+
+            std::vector<dx::MeshVertex> decoded(kCount);
+            dx::PackedVertexLayout::Decode(&packed[0], kCount, &decoded[0]);
+            for (UINT i = 0; i < kCount; ++i) {
+                const dx::MeshVertex &a = vertices[i];
+                const dx::MeshVertex &b = decoded[i];
+                // Half keeps 11 significant bits.
+                Assert::IsTrue(std::fabs(a.position.x - b.position.x) <= std::fabs(a.position.x) / 2048.0f);
+                Assert::IsTrue(std::fabs(a.position.y - b.position.y) <= std::fabs(a.position.y) / 2048.0f);
+                Assert::IsTrue(std::fabs(a.position.z - b.position.z) <= std::fabs(a.position.z) / 2048.0f);
+                Assert::IsTrue(a.normal.Dot(b.normal) > 0.99999f);
+                Assert::IsTrue(std::fabs(b.normal.Length() - 1.0f) < 1e-5f);
+                Assert::IsTrue(std::fabs(a.texcoord.x - b.texcoord.x) <= 0.5f / 65535.0f + 1e-7f);
+                Assert::IsTrue(std::fabs(a.texcoord.y - b.texcoord.y) <= 0.5f / 65535.0f + 1e-7f);
+                Assert::IsTrue(a.color == b.color);
+            }
+
+            // The w of every position is 1.
+            const unsigned short *w = reinterpret_cast<const unsigned short*>(&packed[6]);
+            Assert::IsTrue(*w == 0x3C00);
+        }
+
+        TEST_METHOD(FullLayoutIsExact) {
+            dx::MeshVertex vertex;
+            vertex.position = Vector3f(1.5f, -2.25f, 1e-3f);
+            vertex.normal = Vector3f(0.0f, 1.0f, 0.0f);
+            vertex.texcoord = Vector2f(3.5f, -0.25f);
+            vertex.color = 0x80FF0040;
+
+            char packed[dx::FullVertexLayout::kStride];
+            dx::FullVertexLayout::Encode(&vertex, 1, packed);
+            dx::MeshVertex decoded;
+            dx::FullVertexLayout::Decode(packed, 1, &decoded);
+            Assert::IsTrue(memcmp(&vertex, &decoded, sizeof(vertex)) == 0);
+        }
+	};
+}
\ No newline at end of file
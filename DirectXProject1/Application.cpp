@@ -1,6 +1,9 @@
 #include "Application.h"
 
+#include <cstdio>
+
 Application::Application() : dx::DXApp(800, 600, "DirectXProject1") {
+    _shownFPS = -1;
 
 }
 
@@ -13,13 +16,26 @@ void Application::OnInitialize(dx::RenderSystem &r) {
 }
 
 void Application::OnUpdate(const dx::Timer &timer) {
-    SetTitle(std::string("DirectXProject1  FPS:") + std::to_string(GetCurrentFPS()));
+    // Only touch the title when the number actually changes.
+    int fps = GetCurrentFPS();
+    if (fps != _shownFPS) {
+        char title[64];
+        sprintf_s(title, "DirectXProject1  FPS:%d", fps);
+        SetTitle(title);
+        _shownFPS = fps;
+    }
 }
 
 void Application::OnRender(dx::RenderSystem &r, const dx::Timer &timer) {
 
 }
 
+void Application::OnEvent(const dx::Event &event) {
+    if (event.type == dx::EventType::KEY_DOWN && event.key.code == VK_ESCAPE) {
+        DXApp::Quit();
+    }
+}
+
 void Application::OnClose() {
     DXApp::Quit();
 }
\ No newline at end of file
@@ -13,9 +13,10 @@ protected:
     void OnUpdate(const dx::Timer &timer) override;
     void OnRender(dx::RenderSystem &r, const dx::Timer &timer) override;
 
+    void OnEvent(const dx::Event &event) override;
     void OnClose() override;
 private:
-
+    int _shownFPS;
 };
 
 #endif // !APPLICATION_H
\ No newline at end of file
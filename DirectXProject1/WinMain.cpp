@@ -1,4 +1,5 @@
 #include <iostream>
+#include <string>
 #include <Windows.h>
 
 #include "Application.h"
@@ -26,15 +27,51 @@ void SIMDTest() {
               << numbers[3] << std::endl;
 }
 
-int main() {
+// Usage: DirectXProject1 [--headless FRAMES] [--record FILE] [--replay FILE]
+//                        [--telemetry FILE] [--message-thread] [--software]
+//                        [--null-renderer]
+int main(int argc, char **argv) {
     Application app;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--message-thread") {
+            app.SetThreadedMessagePump(true);
+            continue;
+        } else if (option == "--software") {
+            app.SetRenderBackend(dx::RenderBackend::SOFTWARE);
+            continue;
+        } else if (option == "--null-renderer") {
+            app.SetRenderBackend(dx::RenderBackend::NULL_DEVICE);
+            continue;
+        }
+
+        if (i + 1 >= argc) break;
+        if (option == "--headless") {
+            app.SetHeadless(static_cast<UINT>(atoi(argv[++i])));
+        } else if (option == "--record") {
+            app.RecordInput(argv[++i]);
+        } else if (option == "--telemetry") {
+            app.SetTelemetryFile(argv[++i]);
+        } else if (option == "--replay") {
+            ++i;
+            if (app.ReplayInput(argv[i]) != dx::Error::OK) {
+                std::cout << "Failed to load input recording " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+    }
+
     if (app.Initialize() != dx::Error::OK) {
         std::cout << "Initialization failure!" << std::endl;
+        return 1;
     }
     app.Run();
     
 #if defined(_DEBUG) | defined(DEBUG)
-    system("PAUSE");
+    if (!app.IsHeadless()) {
+        system("PAUSE");
+    }
 #endif
     return 0;
 }
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <Windows.h>
+
+#include <Telemetry.h>
+
+using dx::TelemetryFileHeader;
+using dx::TelemetryFileEntry;
+
+struct Snapshot {
+    unsigned long long publishCount;
+    double uptime;
+    std::vector<TelemetryFileEntry> entries;
+};
+
+// Copies a consistent snapshot out of the mapping, retrying while the
+// publisher is in the middle of writing one.
+static bool ReadSnapshot(const TelemetryFileHeader *header, Snapshot &out) {
+    const TelemetryFileEntry *entries = reinterpret_cast<const TelemetryFileEntry*>(header + 1);
+
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        long before = header->sequence;
+        MemoryBarrier();
+        if (before & 1) {
+            YieldProcessor();
+            continue;
+        }
+
+        unsigned int count = header->count;
+        if (count > header->capacity) count = header->capacity;
+        out.entries.assign(entries, entries + count);
+        out.publishCount = header->publishCount;
+        out.uptime = header->uptime;
+
+        MemoryBarrier();
+        if (header->sequence == before) return true;
+    }
+    return false;
+}
+
+static const TelemetryFileEntry* FindEntry(const Snapshot &snapshot, const char *name) {
+    for (size_t i = 0; i < snapshot.entries.size(); ++i) {
+        if (strncmp(snapshot.entries[i].name, name, TelemetryFileEntry::kNameLength) == 0) {
+            return &snapshot.entries[i];
+        }
+    }
+    return nullptr;
+}
+
+static void Print(const Snapshot &current, const Snapshot &previous) {
+    // Redraw in place rather than scrolling.
+    COORD home = { 0, 0 };
+    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), home);
+
+    printf("uptime %10.1fs   snapshots %llu            \n\n", current.uptime, current.publishCount);
+    printf("%-40s %16s %14s\n", "name", "value", "per second");
+
+    double elapsed = current.uptime - previous.uptime;
+    for (size_t i = 0; i < current.entries.size(); ++i) {
+        const TelemetryFileEntry &entry = current.entries[i];
+        char name[TelemetryFileEntry::kNameLength];
+        strncpy_s(name, entry.name, _TRUNCATE);
+
+        if (entry.kind == dx::TelemetryKind::COUNTER) {
+            const TelemetryFileEntry *last = FindEntry(previous, name);
+            double rate = (last && elapsed > 0.0) ? (entry.value - last->value) / elapsed : 0.0;
+            printf("%-40s %16.0f %14.1f\n", name, entry.value, rate);
+        } else {
+            printf("%-40s %16.3f %14s\n", name, entry.value, "");
+        }
+    }
+}
+
+// Usage: TelemetryViewer FILE [INTERVAL_MS]
+// Watches a file written by dx::Telemetry::StartPublishing().
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: TelemetryViewer FILE [INTERVAL_MS]" << std::endl;
+        return 1;
+    }
+    DWORD interval = (argc > 2) ? static_cast<DWORD>(atoi(argv[2])) : 500;
+
+    // Don't lock out the publisher, it reopens the file when restarted.
+    HANDLE file = CreateFileA(argv[1], GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const TelemetryFileHeader *header = nullptr;
+    if (mapping) {
+        header = static_cast<const TelemetryFileHeader*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!header || header->magic != TelemetryFileHeader::kMagic ||
+        header->version != TelemetryFileHeader::kVersion) {
+        std::cout << argv[1] << " is not a telemetry file of version "
+                  << TelemetryFileHeader::kVersion << std::endl;
+        return 1;
+    }
+
+    system("cls");
+
+    Snapshot previous = { 0, 0.0 };
+    Snapshot current;
+    for (;;) {
+        // Only redraw for new data, rates are taken between snapshots.
+        if (ReadSnapshot(header, current) && current.publishCount != previous.publishCount) {
+            Print(current, previous);
+            previous = current;
+        }
+        Sleep(interval);
+    }
+}
\ No newline at end of file